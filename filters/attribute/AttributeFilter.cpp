@@ -219,17 +219,24 @@ void AttributeFilter::UpdateGEOSBuffer(PointView& view)
 
         // Compute a total bounds for the geometry. Query the QuadTree to
         // find out the points that are inside the bbox. Then test each
-        // point in the bbox against the prepared geometry.
+        // point in the bbox against the polygon.
         BOX3D box = p.bounds();
         std::vector<PointId> ids = idx.getPoints(box);
 
 
-        for (const auto& i : ids)
+        std::vector<double> x(ids.size());
+        std::vector<double> y(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i)
         {
-            PointRef ref(view, i);
-            if (p.covers(ref))
-                view.setField(m_dim, i, fieldVal);
+            x[i] = view.getFieldAs<double>(Dimension::Id::X, ids[i]);
+            y[i] = view.getFieldAs<double>(Dimension::Id::Y, ids[i]);
         }
+
+        std::vector<char> inside;
+        p.covers(x, y, inside);
+        for (size_t i = 0; i < ids.size(); ++i)
+            if (inside[i])
+                view.setField(m_dim, ids[i], fieldVal);
         feature = OGRFeaturePtr(OGR_L_GetNextFeature(m_lyr),
             OGRFeatureDeleter());
     }
@@ -67,6 +67,9 @@ Options ColorizationFilter::getDefaultOptions()
     Options options;
 
     options.add("dimensions", "Red:1:1.0, Green:2:1.0, Blue:3");
+    options.add("cache_size", 64, "Size of the raster block cache in MB");
+    options.add("interpolation", "nearest",
+        "Raster sampling method: 'nearest' or 'bilinear'");
 
     return options;
 }
@@ -170,6 +173,26 @@ void ColorizationFilter::processOptions(const Options& options)
         defaultBand = bi.m_band + 1;
         m_bands.push_back(bi);
     }
+
+    m_cacheSize = options.getValueOrDefault<size_t>("cache_size", 64);
+    if (m_cacheSize == 0)
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Option 'cache_size' must be greater than 0.";
+        throw pdal_error(oss.str());
+    }
+
+    std::string interp = Utils::tolower(
+        options.getValueOrDefault<std::string>("interpolation", "nearest"));
+    if (interp == "bilinear")
+        m_bilinear = true;
+    else if (interp != "nearest")
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Invalid 'interpolation' value '" << interp <<
+            "'.  Must be 'nearest' or 'bilinear'.";
+        throw pdal_error(oss.str());
+    }
 }
 
 
@@ -201,37 +224,65 @@ void ColorizationFilter::ready(PointTableRef table)
             throw pdal_error(getName() + ": " + m_raster->errorMsg());
         }
     }
+
+    std::vector<int> bands;
+    for (auto& b : m_bands)
+    {
+        if (b.m_band == 0 || (int)b.m_band > m_raster->m_band_count)
+        {
+            std::ostringstream oss;
+            oss << getName() << ": Band " << b.m_band << " for dimension '" <<
+                b.m_name << "' doesn't exist in raster '" <<
+                m_rasterFilename << "'.";
+            throw pdal_error(oss.str());
+        }
+        bands.push_back((int)b.m_band);
+    }
+    m_cache.reset(new gdal::BlockCache(*m_raster, bands,
+        m_cacheSize * 1024 * 1024));
+    m_values.resize(m_bands.size());
 }
 
 
 bool ColorizationFilter::processOne(PointRef& point)
 {
-    static std::vector<double> data;
-
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
 
-    if (m_raster->read(x, y, data) == gdal::GDALError::None)
-    {
-        int i(0);
-        for (auto bi = m_bands.begin(); bi != m_bands.end(); ++bi)
-        {
-            BandInfo& b = *bi;
-            point.setField(b.m_dim, data[i] * b.m_scale);
-            ++i;
-        }
-        return true;
-    }
-    return false;
+    if (!m_cache->sample(x, y, m_bilinear, m_values.data()))
+        return false;
+
+    for (size_t i = 0; i < m_bands.size(); ++i)
+        point.setField(m_bands[i].m_dim, m_values[i] * m_bands[i].m_scale);
+    return true;
 }
 
+
+// Sample the raster for all the points in the view at once, so that the
+// raster is visited block by block.  Safe to run on several views
+// concurrently: the block cache does its own locking.
 void ColorizationFilter::filter(PointView& view)
 {
-    PointRef point = view.point(0);
+    std::vector<double> x(view.size());
+    std::vector<double> y(view.size());
+    for (PointId idx = 0; idx < view.size(); ++idx)
+    {
+        x[idx] = view.getFieldAs<double>(Dimension::Id::X, idx);
+        y[idx] = view.getFieldAs<double>(Dimension::Id::Y, idx);
+    }
+
+    std::vector<double> values;
+    std::vector<char> valid;
+    m_cache->sample(x, y, m_bilinear, values, valid);
+
+    const size_t numBands = m_bands.size();
     for (PointId idx = 0; idx < view.size(); ++idx)
     {
-        point.setPointId(idx);
-        processOne(point);
+        if (!valid[idx])
+            continue;
+        const double *v = values.data() + idx * numBands;
+        for (size_t i = 0; i < numBands; ++i)
+            view.setField(m_bands[i].m_dim, idx, v[i] * m_bands[i].m_scale);
     }
 }
 
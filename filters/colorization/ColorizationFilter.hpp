@@ -72,7 +72,7 @@ public:
     };
 
 
-    ColorizationFilter()
+    ColorizationFilter() : m_cacheSize(0), m_bilinear(false)
     {}
 
     static void * create();
@@ -86,13 +86,21 @@ private:
     virtual void processOptions(const Options&);
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
     virtual void filter(PointView& view);
+    virtual bool threadSafe() const
+        { return true; }
 
     std::string m_rasterFilename;
     std::vector<BandInfo> m_bands;
+    size_t m_cacheSize;
+    bool m_bilinear;
+    std::vector<double> m_values;
 
     std::unique_ptr<gdal::Raster> m_raster;
+    std::unique_ptr<gdal::BlockCache> m_cache;
 
     ColorizationFilter& operator=(const ColorizationFilter&); // not implemented
     ColorizationFilter(const ColorizationFilter&); // not implemented
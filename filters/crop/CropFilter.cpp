@@ -156,6 +156,34 @@ bool CropFilter::processOne(PointRef& point)
 }
 
 
+void CropFilter::processBatch(PointSpan& span)
+{
+    if (m_geoms.empty() && m_bounds.empty())
+        return;
+
+    std::vector<double> x, y;
+    span.getFieldAs(Dimension::Id::X, x);
+    span.getFieldAs(Dimension::Id::Y, y);
+
+    std::vector<char> inside;
+    for (auto& geom : m_geoms)
+    {
+        geom.m_geom.covers(x, y, inside);
+        for (PointId idx = span.begin(); idx < span.end(); ++idx)
+            if (m_cropOutside == (bool)inside[idx - span.begin()])
+                span.skip(idx);
+    }
+
+    for (auto& box : m_bounds)
+        for (PointId idx = span.begin(); idx < span.end(); ++idx)
+        {
+            size_t i = idx - span.begin();
+            if (m_cropOutside == box.contains(x[i], y[i]))
+                span.skip(idx);
+        }
+}
+
+
 PointViewSet CropFilter::run(PointViewPtr view)
 {
     PointViewSet viewSet;
@@ -223,15 +251,19 @@ bool CropFilter::crop(PointRef& point, const GeomPkg& g)
 
 void CropFilter::crop(const GeomPkg& g, PointView& input, PointView& output)
 {
-    PointRef point = input.point(0);
+    std::vector<double> x(input.size());
+    std::vector<double> y(input.size());
     for (PointId idx = 0; idx < input.size(); ++idx)
     {
-        point.setPointId(idx);
-        bool covers = g.m_geom.covers(point);
-        bool keep = (m_cropOutside != covers);
-        if (keep)
-            output.appendPoint(input, idx);
+        x[idx] = input.getFieldAs<double>(Dimension::Id::X, idx);
+        y[idx] = input.getFieldAs<double>(Dimension::Id::Y, idx);
     }
+
+    std::vector<char> inside;
+    g.m_geom.covers(x, y, inside);
+    for (PointId idx = 0; idx < input.size(); ++idx)
+        if (m_cropOutside != (bool)inside[idx])
+            output.appendPoint(input, idx);
 }
 
 
@@ -77,7 +77,10 @@ private:
 
     virtual void processOptions(const Options& options);
     virtual void ready(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(PointSpan& span);
     virtual PointViewSet run(PointViewPtr view);
     bool crop(PointRef& point, const BOX2D& box);
     void crop(const BOX2D& box, PointView& input, PointView& output);
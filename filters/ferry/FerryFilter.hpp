@@ -63,6 +63,8 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void prepared(PointTableRef table);
     virtual void ready(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
     virtual void filter(PointView& view);
 
@@ -57,6 +57,8 @@ private:
     PointViewPtr m_view;
 
     virtual void ready(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point)
         { return true; }
     virtual PointViewSet run(PointViewPtr in);
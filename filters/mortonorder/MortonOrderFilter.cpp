@@ -34,11 +34,11 @@
 
 #include "MortonOrderFilter.hpp"
 #include <pdal/pdal_macros.hpp>
+#include <pdal/util/RadixSort.hpp>
+#include <pdal/util/ThreadPool.hpp>
+#include <pdal/util/Utils.hpp>
 
-#include <climits>
-#include <iostream>
-#include <limits>
-#include <map>
+#include <sstream>
 
 namespace pdal
 {
@@ -59,72 +59,128 @@ Options MortonOrderFilter::getDefaultOptions()
 }
 
 
-//This used to be a lambda, but the VS compiler exploded, I guess.
-typedef std::pair<double, double> Coord;
-namespace
+void MortonOrderFilter::processOptions(const Options& options)
+{
+    std::string order = Utils::tolower(
+        options.getValueOrDefault<std::string>("order", "morton"));
+    if (order == "morton")
+        m_hilbert = false;
+    else if (order == "hilbert")
+        m_hilbert = true;
+    else
+    {
+        std::ostringstream oss;
+        oss << getName() << ": invalid 'order' option '" << order <<
+            "'.  Valid values are 'morton' and 'hilbert'.";
+        throw pdal_error(oss.str());
+    }
+    m_codeDimName = options.getValueOrDefault<std::string>("code_dimension");
+}
+
+
+void MortonOrderFilter::addDimensions(PointLayoutPtr layout)
 {
-bool less_msb(const int& x, const int& y)
+    if (m_codeDimName.size())
+        m_codeDim = layout->registerOrAssignDim(m_codeDimName,
+            Dimension::Type::Unsigned64);
+}
+
+
+namespace
 {
-    return x < y && x < (x ^ y);
-};
 
-class CmpZOrder
+// Spread the bits of a value so that there's a zero bit between each.
+uint64_t spreadBits(uint32_t v)
 {
-public:
-    bool operator()(const Coord& c1, const Coord& c2) const
-    {
-        int a[2] = {(int)(c1.first * INT_MAX), (int)(c1.second * INT_MAX)};
-        int b[2] = {(int)(c2.first * INT_MAX), (int)(c2.second * INT_MAX)};
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    return x;
+}
 
-        int j = 0;
-        int x = 0;
+// Interleave the bits of the coordinates.  X is the more significant
+// coordinate at each level.
+uint64_t mortonCode(uint32_t x, uint32_t y)
+{
+    return (spreadBits(x) << 1) | spreadBits(y);
+}
 
-        for (int k = 0; k < 2; k++)
+// Distance along a Hilbert curve filling a square of side 2^bits.
+uint64_t hilbertCode(uint32_t x, uint32_t y, int bits)
+{
+    const uint32_t n = 1u << bits;
+    uint64_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2)
+    {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+        // Rotate the quadrant so that the curve is continuous.
+        if (ry == 0)
         {
-            int y = a[k] ^ b[k];
-            if (less_msb(x, y))
+            if (rx == 1)
             {
-                j = k;
-                x = y;
+                x = n - 1 - x;
+                y = n - 1 - y;
             }
+            std::swap(x, y);
         }
-        return (a[j] - b[j]) < 0;
-    };
-};
+    }
+    return d;
 }
 
-PointViewSet MortonOrderFilter::run(PointViewPtr inView)
+} // unnamed namespace
+
+
+void MortonOrderFilter::filter(PointView& view)
 {
-    PointViewSet viewSet;
-    if (!inView->size())
-        return viewSet;
-    CmpZOrder compare;
-    std::multimap<Coord, PointId, CmpZOrder> sorted(compare);
-
-    BOX2D buffer_bounds;
-    inView->calculateBounds(buffer_bounds);
-    double xrange = buffer_bounds.maxx - buffer_bounds.minx;
-    double yrange = buffer_bounds.maxy - buffer_bounds.miny;
-
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    const point_count_t n = view.size();
+    if (n == 0)
+        return;
+
+    BOX2D bounds;
+    view.calculateBounds(bounds);
+    const double xrange = bounds.maxx - bounds.minx;
+    const double yrange = bounds.maxy - bounds.miny;
+
+    // Coordinates are scaled to 31-bit integers over the bounds of the
+    // points, so codes fit in 62 bits.
+    const int bits = 31;
+    const double scale = (double)((1u << bits) - 1);
+
+    std::vector<uint64_t> codes(n);
+    std::vector<PointId> order(n);
+    auto encode = [&](PointId begin, PointId end)
     {
-        double xpos = (inView->getFieldAs<double>(Dimension::Id::X, idx) -
-            buffer_bounds.minx) / xrange;
-        double ypos = (inView->getFieldAs<double>(Dimension::Id::Y, idx) -
-            buffer_bounds.miny) / yrange;
-        Coord loc(xpos, ypos);
-        sorted.insert(std::make_pair(loc, idx));
-    }
+        for (PointId idx = begin; idx < end; ++idx)
+        {
+            double x = view.getFieldAs<double>(Dimension::Id::X, idx);
+            double y = view.getFieldAs<double>(Dimension::Id::Y, idx);
+            uint32_t ix = xrange > 0 ?
+                (uint32_t)((x - bounds.minx) / xrange * scale) : 0;
+            uint32_t iy = yrange > 0 ?
+                (uint32_t)((y - bounds.miny) / yrange * scale) : 0;
+            codes[idx] = m_hilbert ? hilbertCode(ix, iy, bits) :
+                mortonCode(ix, iy);
+            order[idx] = idx;
+        }
+    };
 
-    PointViewPtr outView = inView->makeNew();
-    std::multimap<Coord, PointId, CmpZOrder>::iterator pos;
-    for (pos = sorted.begin(); pos != sorted.end(); ++pos)
-    {
-        outView->appendPoint(*inView, pos->second);
-    }
-    viewSet.insert(outView);
+    const point_count_t minPerThread = 100000;
+    ThreadPool::parallelFor(n,
+        ThreadPool::threadsFor(n, m_threads, minPerThread),
+        [&encode](size_t, size_t begin, size_t end)
+            { encode(begin, end); });
+
+    if (m_codeDim != Dimension::Id::Unknown)
+        for (PointId idx = 0; idx < n; ++idx)
+            view.setField(m_codeDim, idx, codes[idx]);
 
-    return viewSet;
+    Utils::radixSort(codes, order, m_threads);
+    view.reorder(order);
 }
 
 } // pdal
@@ -46,7 +46,8 @@ namespace pdal
 class PDAL_DLL MortonOrderFilter : public pdal::Filter
 {
 public:
-    MortonOrderFilter()
+    MortonOrderFilter() : m_hilbert(false),
+        m_codeDim(Dimension::Id::Unknown)
     {}
 
     static void * create();
@@ -56,8 +57,15 @@ public:
     Options getDefaultOptions();
 
 private:
-    virtual void processOptions(const Options& ) {};
-    virtual PointViewSet run(PointViewPtr view);
+    // Whether to order along a Hilbert curve rather than a Z-order curve.
+    bool m_hilbert;
+    // Name of the dimension to hold the curve code, if any.
+    std::string m_codeDimName;
+    Dimension::Id::Enum m_codeDim;
+
+    virtual void processOptions(const Options& options);
+    virtual void addDimensions(PointLayoutPtr layout);
+    virtual void filter(PointView& view);
 
     MortonOrderFilter& operator=(const MortonOrderFilter&); // not implemented
     MortonOrderFilter(const MortonOrderFilter&); // not implemented
@@ -57,100 +57,6 @@ std::string RangeFilter::getName() const
     return s_info.name;
 }
 
-namespace
-{
-
-RangeFilter::Range parseRange(const std::string& r)
-{
-    std::string::size_type pos, count;
-    bool ilb = true;
-    bool iub = true;
-    bool negate = false;
-    const char *start;
-    char *end;
-    std::string name;
-    double ub, lb;
-
-    try
-    {
-        pos = 0;
-        // Skip leading whitespace.
-        count = Utils::extract(r, pos, (int(*)(int))std::isspace);
-        pos += count;
-
-        count = Utils::extract(r, pos, (int(*)(int))std::isalpha);
-        if (count == 0)
-           throw std::string("No dimension name.");
-        name = r.substr(pos, count);
-        pos += count;
-
-        if (r[pos] == '!')
-        {
-            negate = true;
-            pos++;
-        }
-
-        if (r[pos] == '(')
-            ilb = false;
-        else if (r[pos] != '[')
-            throw std::string("Missing '(' or '['.");
-        pos++;
-
-        // Extract lower bound.
-        start = r.data() + pos;
-        lb = std::strtod(start, &end);
-        if (start == end)
-            lb = std::numeric_limits<double>::min();
-        pos += (end - start);
-
-        count = Utils::extract(r, pos, (int(*)(int))std::isspace);
-        pos += count;
-
-        if (r[pos] != ':')
-            throw std::string("Missing ':' limit separator.");
-        pos++;
-
-        start = r.data() + pos;
-        ub = std::strtod(start, &end);
-        if (start == end)
-            ub = std::numeric_limits<double>::max();
-        pos += (end - start);
-
-        count = Utils::extract(r, pos, (int(*)(int))std::isspace);
-        pos += count;
-
-        if (r[pos] == ')')
-            iub = false;
-        else if (r[pos] != ']')
-            throw std::string("Missing ')' or ']'.");
-        pos++;
-
-        count = Utils::extract(r, pos, (int(*)(int))std::isspace);
-        pos += count;
-
-        if (pos != r.size())
-            throw std::string("Invalid characters following valid range.");
-    }
-    catch (std::string s)
-    {
-        std::ostringstream oss;
-        oss << "filters.range: invalid 'limits' option: '" << r << "': " << s;
-        throw pdal_error(oss.str());
-    }
-    return RangeFilter::Range(name, lb, ub, ilb, iub, negate);
-}
-
-} // unnamed namespace
-
-
-bool operator < (const RangeFilter::Range& r1, const RangeFilter::Range& r2)
-{
-    return (r1.m_name < r2.m_name ? true :
-        r1.m_name > r2.m_name ? false :
-        &r1 < &r2);
-}
-
-
 void RangeFilter::processOptions(const Options& options)
 {
     StringList rangeString = options.getValueOrDefault<StringList>("limits");
@@ -159,7 +65,18 @@ void RangeFilter::processOptions(const Options& options)
         throw pdal_error("filters.range missing required 'limits' option.");
 
     for (auto const& r : rangeString)
-        m_range_list.push_back(parseRange(r));
+    {
+        try
+        {
+            m_range_list.push_back(DimRange::parse(r));
+        }
+        catch (pdal_error& err)
+        {
+            std::ostringstream oss;
+            oss << "filters.range: invalid 'limits' option: " << err.what();
+            throw pdal_error(oss.str());
+        }
+    }
 }
 
 
@@ -182,45 +99,47 @@ void RangeFilter::prepared(PointTableRef table)
 }
 
 
-// Determine if a point passes a single range.
-bool RangeFilter::dimensionPasses(double v, const Range& r) const
-{
-    bool fail = ((r.m_inclusive_lower_bound && v < r.m_lower_bound) ||
-        (!r.m_inclusive_lower_bound && v <= r.m_lower_bound) ||
-        (r.m_inclusive_upper_bound && v > r.m_upper_bound) ||
-        (!r.m_inclusive_upper_bound && v >= r.m_upper_bound));
-    if (r.m_negate)
-        fail = !fail;
-    return !fail;
-}
-
 // The range list is sorted by dimension, so the logic here should work
 // as ORs between ranges of the same dimension and ANDs between ranges
 // of different dimensions.  This is simple logic, but is probably the most
 // common case.
 bool RangeFilter::processOne(PointRef& point)
 {
-    Dimension::Id::Enum lastId = m_range_list.front().m_id;
-    bool passes = false;
-    for (auto const& r : m_range_list)
+    return DimRange::pointPasses(m_range_list,
+        [&point](Dimension::Id::Enum id)
+        { return point.getFieldAs<double>(id); });
+}
+
+
+// Same logic as processOne(), but each dimension is fetched once for the
+// whole span.  Points are skipped as soon as they fail a dimension.
+void RangeFilter::processBatch(PointSpan& span)
+{
+    std::vector<double> vals;
+    std::vector<char> passes(span.size());
+
+    auto ri = m_range_list.begin();
+    while (ri != m_range_list.end())
     {
-        // If we're at a new dimension, return false if we haven't passed
-        // the dimension, otherwise reset passes to false for the next
-        // dimension and keep checking.
-        if (r.m_id != lastId)
-        {
-            if (!passes)
-                return false;
-            lastId = r.m_id;
-            passes = false;
-        }
-        // If we've already passed this dimension, continue until we find
-        // a new dimension.
-        else if (passes)
-            continue;
-        passes = dimensionPasses(point.getFieldAs<double>(r.m_id), r);
+        Dimension::Id::Enum id = ri->m_id;
+        auto rend = ri;
+        while (rend != m_range_list.end() && rend->m_id == id)
+            rend++;
+
+        span.getFieldAs(id, vals);
+        std::fill(passes.begin(), passes.end(), 0);
+        for (auto r = ri; r != rend; ++r)
+            for (PointId idx = span.begin(); idx < span.end(); ++idx)
+            {
+                size_t i = idx - span.begin();
+                if (!passes[i] && r->valuePasses(vals[i]))
+                    passes[i] = 1;
+            }
+        for (PointId idx = span.begin(); idx < span.end(); ++idx)
+            if (!passes[idx - span.begin()])
+                span.skip(idx);
+        ri = rend;
     }
-    return passes;
 }
 
 
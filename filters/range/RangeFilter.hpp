@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <pdal/DimRange.hpp>
 #include <pdal/Filter.hpp>
 #include <pdal/plugin.hpp>
 
@@ -53,34 +54,6 @@ class PDAL_DLL RangeFilter : public pdal::Filter
 {
 public:
 
-    struct Range
-    {
-        Range(const std::string name,
-              double lower_bound,
-              double upper_bound,
-              bool inclusive_lower_bound,
-              bool inclusive_upper_bound,
-              bool negate) :
-            m_name(name), m_id(Dimension::Id::Unknown),
-            m_lower_bound(lower_bound), m_upper_bound(upper_bound),
-            m_inclusive_lower_bound(inclusive_lower_bound),
-            m_inclusive_upper_bound(inclusive_upper_bound),
-            m_negate(negate)
-        {}
-
-        Range()
-            {}
-
-        std::string m_name;
-        Dimension::Id::Enum m_id;
-        double m_lower_bound;
-        double m_upper_bound;
-        bool m_inclusive_lower_bound;
-        bool m_inclusive_upper_bound;
-        bool m_negate;
-    };
-
-
     RangeFilter() : Filter()
     {}
 
@@ -89,13 +62,17 @@ public:
     std::string getName() const;
 
 private:
-    std::vector<Range> m_range_list;
+    std::vector<DimRange> m_range_list;
 
     virtual void processOptions(const Options&options);
     virtual void prepared(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(PointSpan& span);
+    virtual bool threadSafe() const
+        { return true; }
     virtual PointViewSet run(PointViewPtr view);
-    bool dimensionPasses(double v, const Range& r) const;
 
     RangeFilter& operator=(const RangeFilter&); // not implemented
     RangeFilter(const RangeFilter&); // not implemented
@@ -37,10 +37,12 @@
 #include <pdal/PointView.hpp>
 #include <pdal/GlobalEnvironment.hpp>
 #include <pdal/pdal_macros.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <gdal.h>
 #include <ogr_spatialref.h>
 
+#include <algorithm>
 #include <memory>
 
 namespace pdal
@@ -56,15 +58,13 @@ CREATE_STATIC_PLUGIN(1, 0, ReprojectionFilter, Filter, s_info)
 std::string ReprojectionFilter::getName() const { return s_info.name; }
 
 ReprojectionFilter::ReprojectionFilter() : m_inferInputSRS(true),
-    m_in_ref_ptr(NULL), m_out_ref_ptr(NULL), m_transform_ptr(NULL)
+    m_out_ref_ptr(NULL), m_transform_ptr(NULL)
 {}
 
 ReprojectionFilter::~ReprojectionFilter()
 {
     if (m_transform_ptr)
         OCTDestroyCoordinateTransformation(m_transform_ptr);
-    if (m_in_ref_ptr)
-        OSRDestroySpatialReference(m_in_ref_ptr);
     if (m_out_ref_ptr)
         OSRDestroySpatialReference(m_out_ref_ptr);
 }
@@ -138,44 +138,56 @@ void ReprojectionFilter::ready(PointTableRef table)
 
 void ReprojectionFilter::createTransform(const SpatialReference& srsSRS)
 {
+    TransformPtr transform = newTransform(srsSRS);
     if (m_inferInputSRS)
-    {
         m_inSRS = srsSRS;
-        if (m_inSRS.empty())
-        {
-            std::ostringstream oss;
-            oss << getName() << ": source data has no spatial reference and "
-                "none is specified with the 'in_srs' option.";
-            throw pdal_error(oss.str());
-        }
-    }
+    if (m_transform_ptr)
+        OCTDestroyCoordinateTransformation(m_transform_ptr);
+    m_transform_ptr = transform;
+}
+
 
-    if (m_in_ref_ptr)
-        OSRDestroySpatialReference(m_in_ref_ptr);
-    m_in_ref_ptr = OSRNewSpatialReference(0);
+// Create a transformation from the input SRS to the output SRS.  The filter
+// isn't modified, so this can be called for several views at once.  The
+// caller owns the transformation.
+ReprojectionFilter::TransformPtr
+ReprojectionFilter::newTransform(const SpatialReference& srsSRS) const
+{
+    const SpatialReference& inSRS = m_inferInputSRS ? srsSRS : m_inSRS;
+    if (inSRS.empty())
+    {
+        std::ostringstream oss;
+        oss << getName() << ": source data has no spatial reference and "
+            "none is specified with the 'in_srs' option.";
+        throw pdal_error(oss.str());
+    }
 
+    ReferencePtr inRef = OSRNewSpatialReference(0);
     int result =
-        OSRSetFromUserInput(m_in_ref_ptr,
-            m_inSRS.getWKT(pdal::SpatialReference::eCompoundOK).c_str());
+        OSRSetFromUserInput(inRef,
+            inSRS.getWKT(pdal::SpatialReference::eCompoundOK).c_str());
     if (result != OGRERR_NONE)
     {
+        OSRDestroySpatialReference(inRef);
         std::ostringstream oss;
         oss << getName() << ": Invalid input spatial reference '" <<
-            m_inSRS.getWKT() << "'.  This is usually caused by a bad " <<
+            inSRS.getWKT() << "'.  This is usually caused by a bad " <<
             "value for the 'in_srs' option or an invalid spatial reference " <<
             "in the source file.";
         throw pdal_error(oss.str());
     }
-    if (m_transform_ptr)
-        OCTDestroyCoordinateTransformation(m_transform_ptr);
-    m_transform_ptr = OCTNewCoordinateTransformation(m_in_ref_ptr,
+
+    // The transformation keeps its own copies of the references.
+    TransformPtr transform = OCTNewCoordinateTransformation(inRef,
         m_out_ref_ptr);
-    if (!m_transform_ptr)
+    OSRDestroySpatialReference(inRef);
+    if (!transform)
     {
         std::ostringstream oss;
         oss << getName() << ": Could not construct transformation.";
         throw pdal_error(oss.str());
     }
+    return transform;
 }
 
 
@@ -202,26 +214,101 @@ bool ReprojectionFilter::transform(double& x, double& y, double& z)
 PointViewSet ReprojectionFilter::run(PointViewPtr view)
 {
     PointViewSet viewSet;
-    PointViewPtr outView = view->makeNew();
 
-    createTransform(view->spatialReference());
+    // Points are transformed in blocks, a single GDAL call per block.
+    // When the stage has more than one thread, the view is split into
+    // ranges of blocks and each thread gets its own transformation, since
+    // a transformation can't be shared between threads.  For the same
+    // reason, views that are run concurrently (see threadSafe()) don't
+    // share the filter's transformation.
+    const point_count_t blockSize = 65536;
+    const point_count_t n = view->size();
+    size_t numThreads = ThreadPool::threadsFor(n + blockSize - 1, m_threads,
+        blockSize);
+
+    std::vector<TransformPtr> transforms;
+    std::vector<char> failed(n, 0);
+    auto xform = [this, &view, &failed](TransformPtr t, PointId begin,
+        PointId end)
+    {
+        for (; begin < end; begin += blockSize)
+            transformBlock(t, *view, begin,
+                std::min<PointId>(end, begin + blockSize), failed);
+    };
 
-    PointRef point(*view, 0);
-    for (PointId id = 0; id < view->size(); ++id)
+    try
     {
-        point.setPointId(id);
-        if (processOne(point))
-            outView->appendPoint(*view, id);
+        for (size_t i = 0; i < numThreads; ++i)
+            transforms.push_back(newTransform(view->spatialReference()));
+        ThreadPool::parallelFor(n, numThreads,
+            [&xform, &transforms](size_t i, PointId begin, PointId end)
+                { xform(transforms[i], begin, end); });
     }
+    catch (...)
+    {
+        for (TransformPtr t : transforms)
+            OCTDestroyCoordinateTransformation(t);
+        throw;
+    }
+    for (TransformPtr t : transforms)
+        OCTDestroyCoordinateTransformation(t);
 
-    viewSet.insert(outView);
+    // If every point was transformed the view is passed on as-is.
+    // Otherwise the points that failed are dropped.
+    if (std::find(failed.begin(), failed.end(), 1) == failed.end())
+        viewSet.insert(view);
+    else
+    {
+        PointViewPtr outView = view->makeNew();
+        for (PointId id = 0; id < n; ++id)
+            if (!failed[id])
+                outView->appendPoint(*view, id);
+        outView->setSpatialReference(m_outSRS);
+        viewSet.insert(outView);
+    }
     view->setSpatialReference(m_outSRS);
-    outView->setSpatialReference(m_outSRS);
 
     return viewSet;
 }
 
 
+// Transform the points in [begin, end) with one call to GDAL.  Points
+// that can't be transformed are left alone and flagged in 'failed'.
+void ReprojectionFilter::transformBlock(TransformPtr transform,
+    PointView& view, PointId begin, PointId end, std::vector<char>& failed)
+{
+    size_t count = end - begin;
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    std::vector<double> z(count);
+    std::vector<int> success(count);
+
+    for (PointId id = begin; id < end; ++id)
+    {
+        size_t i = id - begin;
+        x[i] = view.getFieldAs<double>(Dimension::Id::X, id);
+        y[i] = view.getFieldAs<double>(Dimension::Id::Y, id);
+        z[i] = view.getFieldAs<double>(Dimension::Id::Z, id);
+    }
+
+    OCTTransformEx(transform, (int)count, x.data(), y.data(), z.data(),
+        success.data());
+
+    for (PointId id = begin; id < end; ++id)
+    {
+        size_t i = id - begin;
+        if (!success[i])
+        {
+            failed[id] = 1;
+            continue;
+        }
+        view.setField(Dimension::Id::X, id, x[i]);
+        view.setField(Dimension::Id::Y, id, y[i]);
+        view.setField(Dimension::Id::Z, id, z[i]);
+    }
+}
+
+
 bool ReprojectionFilter::processOne(PointRef& point)
 {
     double x(point.getFieldAs<double>(Dimension::Id::X));
@@ -242,4 +329,53 @@ bool ReprojectionFilter::processOne(PointRef& point)
     }
 }
 
+
+// Transform all the points in the span that haven't been skipped with a
+// single call to GDAL.  Points that can't be transformed are skipped.
+void ReprojectionFilter::processBatch(PointSpan& span)
+{
+    std::vector<double> x, y, z;
+
+    span.getFieldAs(Dimension::Id::X, x);
+    span.getFieldAs(Dimension::Id::Y, y);
+    span.getFieldAs(Dimension::Id::Z, z);
+
+    // Compact the points that haven't been skipped so that GDAL sees
+    // contiguous arrays.
+    std::vector<PointId> ids;
+    for (PointId idx = span.begin(); idx < span.end(); ++idx)
+    {
+        if (span.skipped(idx))
+            continue;
+        size_t i = idx - span.begin();
+        size_t j = ids.size();
+        x[j] = x[i];
+        y[j] = y[i];
+        z[j] = z[i];
+        ids.push_back(idx);
+    }
+    if (ids.empty())
+        return;
+
+    std::vector<int> success(ids.size());
+    OCTTransformEx(m_transform_ptr, (int)ids.size(), x.data(), y.data(),
+        z.data(), success.data());
+
+    // Expand back to span positions.  Work from the end so that values
+    // aren't overwritten before they're moved.
+    for (size_t j = ids.size(); j-- > 0;)
+    {
+        size_t i = ids[j] - span.begin();
+        if (!success[j])
+            span.skip(ids[j]);
+        x[i] = x[j];
+        y[i] = y[j];
+        z[i] = z[j];
+    }
+
+    span.setField(Dimension::Id::X, x);
+    span.setField(Dimension::Id::Y, y);
+    span.setField(Dimension::Id::Z, z);
+}
+
 } // namespace pdal
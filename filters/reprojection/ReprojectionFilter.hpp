@@ -65,19 +65,28 @@ private:
     virtual void initialize();
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(PointSpan& span);
+    virtual bool threadSafe() const
+        { return true; }
 
     void updateBounds();
     void createTransform(const SpatialReference& srs);
     bool transform(double& x, double& y, double& z);
 
+    typedef void* ReferencePtr;
+    typedef void* TransformPtr;
+
+    TransformPtr newTransform(const SpatialReference& srs) const;
+    void transformBlock(TransformPtr transform, PointView& view,
+        PointId begin, PointId end, std::vector<char>& failed);
+
     SpatialReference m_inSRS;
     SpatialReference m_outSRS;
     bool m_inferInputSRS;
 
-    typedef void* ReferencePtr;
-    typedef void* TransformPtr;
-    ReferencePtr m_in_ref_ptr;
     ReferencePtr m_out_ref_ptr;
     TransformPtr m_transform_ptr;
 
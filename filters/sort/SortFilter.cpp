@@ -34,6 +34,10 @@
 
 #include "SortFilter.hpp"
 #include <pdal/pdal_macros.hpp>
+#include <pdal/util/RadixSort.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <cstring>
 
 namespace pdal
 {
@@ -47,5 +51,135 @@ CREATE_STATIC_PLUGIN(1, 0, SortFilter, Filter, s_info)
 
 std::string SortFilter::getName() const { return s_info.name; }
 
+
+void SortFilter::ready(PointTableRef table)
+{
+    m_dims.clear();
+    for (auto& name : m_dimNames)
+    {
+        Dimension::Id::Enum id = table.layout()->findDim(name);
+        if (id == Dimension::Id::Unknown)
+            log()->get(LogLevel::Warning) << getName() << ": dimension '" <<
+                name << "' not found.  Ignoring." << std::endl;
+        else
+            m_dims.push_back(id);
+    }
+}
+
+
+namespace
+{
+
+// Map values to unsigned integers with the same ordering.
+inline uint64_t sortKey(uint64_t v)
+    { return v; }
+
+inline uint64_t sortKey(int64_t v)
+    { return (uint64_t)v ^ (1ULL << 63); }
+
+inline uint64_t sortKey(double v)
+{
+    uint64_t u;
+    memcpy(&u, &v, sizeof(u));
+    // Negative values sort in reverse order of their magnitude bits.
+    return (u & (1ULL << 63)) ? ~u : (u | (1ULL << 63));
+}
+
+template<typename T, typename K>
+void extract(const PointView& view, Dimension::Id::Enum dim,
+    const PointId *order, uint64_t *keys, point_count_t count)
+{
+    T t;
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        view.getRawField(dim, order[i], &t);
+        keys[i] = sortKey((K)t);
+    }
+}
+
+} // unnamed namespace
+
+
+// Fill 'keys' with the sort keys of a dimension, for points in the order
+// given by 'order'.
+void SortFilter::extractKeys(const PointView& view, Dimension::Id::Enum dim,
+    const std::vector<PointId>& order, std::vector<uint64_t>& keys)
+{
+    using namespace Dimension;
+
+    auto extractRange = [&](point_count_t begin, point_count_t end)
+    {
+        const PointId *o = order.data() + begin;
+        uint64_t *k = keys.data() + begin;
+        point_count_t cnt = end - begin;
+
+        switch (view.layout()->dimType(dim))
+        {
+        case Type::Unsigned8:
+            extract<uint8_t, uint64_t>(view, dim, o, k, cnt);
+            break;
+        case Type::Unsigned16:
+            extract<uint16_t, uint64_t>(view, dim, o, k, cnt);
+            break;
+        case Type::Unsigned32:
+            extract<uint32_t, uint64_t>(view, dim, o, k, cnt);
+            break;
+        case Type::Unsigned64:
+            extract<uint64_t, uint64_t>(view, dim, o, k, cnt);
+            break;
+        case Type::Signed8:
+            extract<int8_t, int64_t>(view, dim, o, k, cnt);
+            break;
+        case Type::Signed16:
+            extract<int16_t, int64_t>(view, dim, o, k, cnt);
+            break;
+        case Type::Signed32:
+            extract<int32_t, int64_t>(view, dim, o, k, cnt);
+            break;
+        case Type::Signed64:
+            extract<int64_t, int64_t>(view, dim, o, k, cnt);
+            break;
+        case Type::Float:
+            extract<float, double>(view, dim, o, k, cnt);
+            break;
+        case Type::Double:
+            extract<double, double>(view, dim, o, k, cnt);
+            break;
+        case Type::None:
+            std::fill(k, k + cnt, 0);
+            break;
+        }
+    };
+
+    const point_count_t n = view.size();
+    const point_count_t minPerThread = 100000;
+    ThreadPool::parallelFor(n,
+        ThreadPool::threadsFor(n, m_threads, minPerThread),
+        [&extractRange](size_t, size_t begin, size_t end)
+            { extractRange(begin, end); });
+}
+
+
+// Sort by extracting each key into a contiguous buffer and radix sorting
+// it with the point indices.  The sort is stable, so sorting on the keys
+// from least to most significant gives a multi-key sort.
+void SortFilter::filter(PointView& view)
+{
+    if (m_dims.empty() || view.size() < 2)
+        return;
+
+    std::vector<PointId> order(view.size());
+    std::vector<uint64_t> keys(view.size());
+    for (PointId i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    for (auto di = m_dims.rbegin(); di != m_dims.rend(); ++di)
+    {
+        extractKeys(view, *di, order, keys);
+        Utils::radixSort(keys, order, m_threads);
+    }
+    view.reorder(order);
+}
+
 } // namespace pdal
 
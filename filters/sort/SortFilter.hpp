@@ -35,7 +35,6 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
-#include <pdal/PointViewIter.hpp>
 #include <pdal/plugin.hpp>
 
 extern "C" int32_t SortFilter_ExitFunc();
@@ -55,27 +54,19 @@ public:
     std::string getName() const;
 
 private:
-    // Dimension on which to sort.
-    Dimension::Id::Enum m_dim;
-    // Dimension name.
-    std::string m_dimName;
+    // Dimensions on which to sort, most significant first.
+    Dimension::IdList m_dims;
+    // Dimension names.
+    StringList m_dimNames;
 
     virtual void processOptions(const Options& options)
-        { m_dimName = options.getValueOrThrow<std::string>("dimension"); }
+        { m_dimNames = options.getValueOrThrow<StringList>("dimension"); }
 
-    virtual void ready(PointTableRef table)
-        { m_dim = table.layout()->findDim(m_dimName); }
+    virtual void ready(PointTableRef table);
+    virtual void filter(PointView& view);
 
-    virtual void filter(PointView& view)
-    {
-        if (m_dim == Dimension::Id::Unknown)
-            return;
-
-        auto cmp = [this](const PointIdxRef& p1, const PointIdxRef& p2)
-            { return p1.compare(m_dim, p2); };
-
-        std::sort(view.begin(), view.end(), cmp);
-    }
+    void extractKeys(const PointView& view, Dimension::Id::Enum dim,
+        const std::vector<PointId>& order, std::vector<uint64_t>& keys);
 
     SortFilter& operator=(const SortFilter&); // not implemented
     SortFilter(const SortFilter&); // not implemented
@@ -61,6 +61,8 @@ public:
         { m_callback = cb; }
 
 private:
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point)
     {
         if (m_callback)
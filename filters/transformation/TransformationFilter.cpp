@@ -109,6 +109,31 @@ bool TransformationFilter::processOne(PointRef& point)
 }
 
 
+void TransformationFilter::processBatch(PointSpan& span)
+{
+    std::vector<double> x, y, z;
+
+    span.getFieldAs(Dimension::Id::X, x);
+    span.getFieldAs(Dimension::Id::Y, y);
+    span.getFieldAs(Dimension::Id::Z, z);
+
+    std::vector<double> xt(span.size()), yt(span.size()), zt(span.size());
+    for (size_t i = 0; i < span.size(); ++i)
+    {
+        xt[i] = x[i] * m_matrix[0] + y[i] * m_matrix[1] +
+            z[i] * m_matrix[2] + m_matrix[3];
+        yt[i] = x[i] * m_matrix[4] + y[i] * m_matrix[5] +
+            z[i] * m_matrix[6] + m_matrix[7];
+        zt[i] = x[i] * m_matrix[8] + y[i] * m_matrix[9] +
+            z[i] * m_matrix[10] + m_matrix[11];
+    }
+
+    span.setField(Dimension::Id::X, xt);
+    span.setField(Dimension::Id::Y, yt);
+    span.setField(Dimension::Id::Z, zt);
+}
+
+
 void TransformationFilter::filter(PointView& view)
 {
     PointRef point(view, 0);
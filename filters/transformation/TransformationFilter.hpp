@@ -69,7 +69,12 @@ private:
     TransformationFilter& operator=(const TransformationFilter&); // not implemented
     TransformationFilter(const TransformationFilter&); // not implemented
     virtual void processOptions(const Options& options);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(PointSpan& span);
+    virtual bool threadSafe() const
+        { return true; }
     virtual void filter(PointView& view);
 
     TransformationMatrix m_matrix;
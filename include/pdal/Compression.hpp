@@ -48,6 +48,7 @@
 #endif
 
 #include <pdal/Dimension.hpp>
+#include <pdal/util/IStream.hpp>
 #include <pdal/util/OStream.hpp>
 
 #include <map>
@@ -217,8 +218,8 @@ public:
     LazPerfVlrCompressor(std::ostream& stream, const Schema& schema,
         uint32_t chunksize) :
         m_stream(stream), m_outputStream(stream), m_schema(schema),
-        m_chunksize(chunksize), m_chunkPointsWritten(0), m_chunkInfoPos(0),
-        m_chunkOffset(0)
+        m_chunksize(chunksize), m_chunkPointsWritten(0), m_started(false),
+        m_chunkInfoPos(0), m_chunkOffset(0)
     {}
 
     ~LazPerfVlrCompressor()
@@ -228,17 +229,18 @@ public:
                "to done()";
     }
 
+    uint32_t chunkSize() const
+        { return m_chunksize; }
+
+    const Schema& schema() const
+        { return m_schema; }
 
     void compress(const char *inbuf)
     {
         // First time through.
         if (!m_encoder || !m_compressor)
         {
-            // Get the position 
-            m_chunkInfoPos = m_stream.tellp();
-            // Seek over the chunk info offset value
-            m_stream.seekp(sizeof(uint64_t), std::ios::cur);
-            m_chunkOffset = m_stream.tellp();
+            start();
             resetCompressor();
         }
         else if (m_chunkPointsWritten == m_chunksize)
@@ -250,13 +252,49 @@ public:
         m_chunkPointsWritten++;
     }
 
-    void done()
+    // Compress 'count' points, 'pointLen' bytes apart, into a standalone
+    // chunk.  Doesn't touch any compressor state, so chunks can be
+    // compressed on separate threads and then written in order with
+    // writeChunk().
+    static void compressChunk(const Schema& schema, const char *inbuf,
+        size_t pointLen, uint32_t count, std::vector<unsigned char>& chunk)
     {
-        // Close and clear the point encoder.
-        m_encoder->done();
-        m_encoder.reset();
+        chunk.clear();
+        LazPerfBuf buf(chunk);
+        laszip::encoders::arithmetic<LazPerfBuf> encoder(buf);
+        Compressor::ptr compressor =
+            laszip::factory::build_compressor(encoder, schema);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            compressor->compress(inbuf);
+            inbuf += pointLen;
+        }
+        encoder.done();
+    }
 
+    // Write a chunk created with compressChunk().  Every chunk but the
+    // last must contain chunkSize() points.  Can't be mixed with compress().
+    void writeChunk(const std::vector<unsigned char>& chunk)
+    {
+        if (!m_started)
+            start();
+        m_stream.write((const char *)chunk.data(), chunk.size());
         newChunk();
+    }
+
+    void done()
+    {
+        if (!m_started)
+            start();
+
+        // Close and clear the point encoder.
+        if (m_encoder)
+        {
+            m_encoder->done();
+            m_encoder.reset();
+            newChunk();
+        }
 
         // Save our current position.  Go to the location where we need
         // to write the chunk table offset at the beginning of the point data.
@@ -289,6 +327,16 @@ public:
     }
 
 private:
+    void start()
+    {
+        // Get the position 
+        m_chunkInfoPos = m_stream.tellp();
+        // Seek over the chunk info offset value
+        m_stream.seekp(sizeof(uint64_t), std::ios::cur);
+        m_chunkOffset = m_stream.tellp();
+        m_started = true;
+    }
+
     void resetCompressor()
     {
         if (m_encoder)
@@ -312,6 +360,7 @@ private:
     Schema m_schema;
     uint32_t m_chunksize;
     uint32_t m_chunkPointsWritten;
+    bool m_started;
     std::streampos m_chunkInfoPos;
     std::streampos m_chunkOffset;
     std::vector<uint32_t> m_chunkTable;
@@ -355,20 +404,65 @@ private:
 class LazPerfVlrDecompressor
 {
 public:
+    // Decompression starts with the first chunk unless the offset of
+    // another chunk is provided (see chunkOffsets()).
     LazPerfVlrDecompressor(std::istream& stream, const char *vlrData,
-        std::streamoff pointOffset) :
+        std::streamoff pointOffset, std::streamoff chunkOffset = 0) :
         m_stream(stream), m_inputStream(stream), m_chunksize(0),
         m_chunkPointsRead(0)
     {
         laszip::io::laz_vlr zipvlr(vlrData);
         m_chunksize = zipvlr.chunk_size;
         m_schema = laszip::io::laz_vlr::to_schema(zipvlr);
-        m_stream.seekg(pointOffset + sizeof(int64_t));
+        if (chunkOffset == 0)
+            chunkOffset = pointOffset + sizeof(int64_t);
+        m_stream.seekg(chunkOffset);
     }
 
     size_t pointSize() const
         { return (size_t)m_schema.size_in_bytes(); }
 
+    // Read the chunk table that follows the point data and return the
+    // file offset of the start of each chunk.  An empty list is returned
+    // if the table can't be read.
+    static std::vector<std::streamoff> chunkOffsets(std::istream& stream,
+        std::streamoff pointOffset)
+    {
+        std::vector<std::streamoff> offsets;
+
+        ILeStream in(&stream);
+        in.seek(pointOffset);
+        int64_t tablePos;
+        in >> tablePos;
+        if (!stream.good() || tablePos <= pointOffset)
+            return offsets;
+
+        in.seek(tablePos);
+        uint32_t version;
+        uint32_t numChunks;
+        in >> version >> numChunks;
+        if (!stream.good())
+            return offsets;
+
+        InputStream inputStream(stream);
+        Decoder decoder(inputStream);
+        laszip::decompressors::integer decompressor(32, 2);
+        decoder.readInitBytes();
+        decompressor.init();
+
+        std::streamoff offset = pointOffset + sizeof(int64_t);
+        uint32_t predictor = 0;
+        for (uint32_t i = 0; i < numChunks; ++i)
+        {
+            offsets.push_back(offset);
+            uint32_t size = (uint32_t)decompressor.decompress(decoder,
+                predictor, 1);
+            offset += size;
+            predictor = size;
+        }
+        return offsets;
+    }
+
     void decompress(char *outbuf)
     {
         if (m_chunkPointsRead == m_chunksize || !m_decoder || !m_decompressor)
@@ -0,0 +1,272 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstring>
+#include <sstream>
+
+#include <pdal/PDALUtils.hpp>
+#include <pdal/PointLayout.hpp>
+#include <pdal/PointRef.hpp>
+#include <pdal/util/Utils.hpp>
+
+namespace pdal
+{
+
+/**
+  Typed access to a single dimension of points.  The stored type of the
+  dimension is looked up once, when the accessor is created, and the
+  conversion between the stored type and T is selected at that time, so
+  that get and set don't need to look up the dimension or switch on its
+  type for each point.  Create accessors once the layout is finalized
+  (in ready(), for example) and use them in per-point loops.
+
+  The checked get() and set() behave like PointRef::getFieldAs() and
+  PointRef::setField().  The unchecked variants skip rounding and range
+  checks and should only be used when T is known to fit in the stored type
+  (typically because the stage registered the dimension itself).
+*/
+template<typename T>
+class DimAccessor
+{
+public:
+    DimAccessor() : m_id(Dimension::Id::Unknown),
+        m_type(Dimension::Type::None), m_get(nullptr),
+        m_getUnchecked(nullptr), m_set(nullptr), m_setUnchecked(nullptr)
+    {}
+
+    /**
+      Create an accessor for a dimension.
+
+      \param layout  Layout of the points to be accessed.
+      \param id  ID of the dimension to access.
+    */
+    DimAccessor(const PointLayout& layout, Dimension::Id::Enum id) :
+        m_id(id), m_type(layout.dimType(id)), m_get(nullptr),
+        m_getUnchecked(nullptr), m_set(nullptr), m_setUnchecked(nullptr)
+    {
+        switch (m_type)
+        {
+        case Dimension::Type::Unsigned8:
+            init<uint8_t>();
+            break;
+        case Dimension::Type::Unsigned16:
+            init<uint16_t>();
+            break;
+        case Dimension::Type::Unsigned32:
+            init<uint32_t>();
+            break;
+        case Dimension::Type::Unsigned64:
+            init<uint64_t>();
+            break;
+        case Dimension::Type::Signed8:
+            init<int8_t>();
+            break;
+        case Dimension::Type::Signed16:
+            init<int16_t>();
+            break;
+        case Dimension::Type::Signed32:
+            init<int32_t>();
+            break;
+        case Dimension::Type::Signed64:
+            init<int64_t>();
+            break;
+        case Dimension::Type::Float:
+            init<float>();
+            break;
+        case Dimension::Type::Double:
+            init<double>();
+            break;
+        case Dimension::Type::None:
+            break;
+        }
+    }
+
+    /**
+      Determine if the accessed dimension exists in the layout.
+
+      \return  Whether the dimension exists.
+    */
+    bool valid() const
+        { return m_type != Dimension::Type::None; }
+
+    /**
+      Get the dimension ID of the accessor.
+
+      \return  Dimension ID.
+    */
+    Dimension::Id::Enum id() const
+        { return m_id; }
+
+    /**
+      Get the value of the dimension for a point, converted to T.  Returns
+      0 if the dimension doesn't exist.  Throws pdal_error if the
+      value can't be represented as T.
+
+      \param point  Point whose value should be fetched.
+      \return  Dimension value.
+    */
+    T get(const PointRef& point) const
+    {
+        T val(0);
+        if (!m_get)
+            return val;
+
+        Everything e;
+        point.getRawField(m_id, &e);
+        if (!m_get(e, val))
+        {
+            std::ostringstream oss;
+            oss << "Unable to fetch data and convert as requested: ";
+            oss << Dimension::name(m_id) << ":" <<
+                Dimension::interpretationName(m_type) <<
+                "(" << Utils::toDouble(e, m_type) << ") -> " <<
+                Utils::typeidName<T>();
+            throw pdal_error(oss.str());
+        }
+        return val;
+    }
+
+    /**
+      Get the value of the dimension for a point with a plain cast to T.
+      Returns 0 if the dimension doesn't exist.
+
+      \param point  Point whose value should be fetched.
+      \return  Dimension value.
+    */
+    T getUnchecked(const PointRef& point) const
+    {
+        T val(0);
+        if (m_getUnchecked)
+        {
+            Everything e;
+            point.getRawField(m_id, &e);
+            m_getUnchecked(e, val);
+        }
+        return val;
+    }
+
+    /**
+      Set the value of the dimension for a point.  Does nothing if the
+      dimension doesn't exist or the value can't be represented in the
+      stored type.
+
+      \param point  Point whose value should be set.
+      \param val  Value to set.
+      \return  Whether the value was set.
+    */
+    bool set(PointRef& point, T val) const
+    {
+        Everything e;
+        if (!m_set || !m_set(val, e))
+            return false;
+        point.setRawField(m_id, &e);
+        return true;
+    }
+
+    /**
+      Set the value of the dimension for a point with a plain cast to the
+      stored type.  Does nothing if the dimension doesn't exist.
+
+      \param point  Point whose value should be set.
+      \param val  Value to set.
+    */
+    void setUnchecked(PointRef& point, T val) const
+    {
+        if (m_setUnchecked)
+        {
+            Everything e;
+            m_setUnchecked(val, e);
+            point.setRawField(m_id, &e);
+        }
+    }
+
+private:
+    typedef bool (*GetFunc)(const Everything&, T&);
+    typedef void (*GetUncheckedFunc)(const Everything&, T&);
+    typedef bool (*SetFunc)(T, Everything&);
+    typedef void (*SetUncheckedFunc)(T, Everything&);
+
+    Dimension::Id::Enum m_id;
+    Dimension::Type::Enum m_type;
+    GetFunc m_get;
+    GetUncheckedFunc m_getUnchecked;
+    SetFunc m_set;
+    SetUncheckedFunc m_setUnchecked;
+
+    template<typename S>
+    void init()
+    {
+        m_get = &getConv<S>;
+        m_getUnchecked = &getUncheckedConv<S>;
+        m_set = &setConv<S>;
+        m_setUnchecked = &setUncheckedConv<S>;
+    }
+
+    template<typename S>
+    static bool getConv(const Everything& e, T& val)
+    {
+        S s;
+        memcpy(&s, &e, sizeof(S));
+        return Utils::numericCast(s, val);
+    }
+
+    template<typename S>
+    static void getUncheckedConv(const Everything& e, T& val)
+    {
+        S s;
+        memcpy(&s, &e, sizeof(S));
+        val = static_cast<T>(s);
+    }
+
+    template<typename S>
+    static bool setConv(T val, Everything& e)
+    {
+        S s;
+        if (!Utils::numericCast(val, s))
+            return false;
+        memcpy(&e, &s, sizeof(S));
+        return true;
+    }
+
+    template<typename S>
+    static void setUncheckedConv(T val, Everything& e)
+    {
+        S s = static_cast<S>(val);
+        memcpy(&e, &s, sizeof(S));
+    }
+};
+
+} // namespace pdal
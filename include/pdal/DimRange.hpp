@@ -0,0 +1,141 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <pdal/Dimension.hpp>
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  A range of values of a dimension, as specified with the syntax
+  'Name[lower:upper]'.  Parentheses in place of brackets make a bound
+  exclusive, an omitted bound is unlimited and a '!' after the name
+  negates the range.
+*/
+struct PDAL_DLL DimRange
+{
+    DimRange(const std::string name, double lower_bound,
+            double upper_bound, bool inclusive_lower_bound,
+            bool inclusive_upper_bound, bool negate) :
+        m_name(name), m_id(Dimension::Id::Unknown),
+        m_lower_bound(lower_bound), m_upper_bound(upper_bound),
+        m_inclusive_lower_bound(inclusive_lower_bound),
+        m_inclusive_upper_bound(inclusive_upper_bound),
+        m_negate(negate)
+    {}
+
+    DimRange()
+        {}
+
+    /**
+      Parse a range specification.  Throws pdal_error if the
+      specification is invalid.
+
+      \param r  Range specification.
+      \return  Parsed range.  The dimension ID is not set.
+    */
+    static DimRange parse(const std::string& r);
+
+    /**
+      Determine if a value falls in the range.
+
+      \param v  Value to test.
+      \return  Whether the value passes the range.
+    */
+    bool valuePasses(double v) const
+    {
+        bool fail = ((m_inclusive_lower_bound && v < m_lower_bound) ||
+            (!m_inclusive_lower_bound && v <= m_lower_bound) ||
+            (m_inclusive_upper_bound && v > m_upper_bound) ||
+            (!m_inclusive_upper_bound && v >= m_upper_bound));
+        if (m_negate)
+            fail = !fail;
+        return !fail;
+    }
+
+    /**
+      Determine if a point passes a list of ranges that has been sorted.
+      Ranges of the same dimension are ORed together and ranges of
+      different dimensions are ANDed.
+
+      \param ranges  Sorted list of ranges.
+      \param getValue  Function that returns the point's value for a
+        dimension.
+      \return  Whether the point passes.
+    */
+    template<typename GetValue>
+    static bool pointPasses(const std::vector<DimRange>& ranges,
+        GetValue getValue)
+    {
+        Dimension::Id::Enum lastId = ranges.front().m_id;
+        bool passes = false;
+        for (auto const& r : ranges)
+        {
+            // If we're at a new dimension, return false if we haven't
+            // passed the dimension, otherwise reset passes to false for the
+            // next dimension and keep checking.
+            if (r.m_id != lastId)
+            {
+                if (!passes)
+                    return false;
+                lastId = r.m_id;
+                passes = false;
+            }
+            // If we've already passed this dimension, continue until we
+            // find a new dimension.
+            else if (passes)
+                continue;
+            passes = r.valuePasses(getValue(r.m_id));
+        }
+        return passes;
+    }
+
+    std::string m_name;
+    Dimension::Id::Enum m_id;
+    double m_lower_bound;
+    double m_upper_bound;
+    bool m_inclusive_lower_bound;
+    bool m_inclusive_upper_bound;
+    bool m_negate;
+};
+
+PDAL_DLL bool operator < (const DimRange& r1, const DimRange& r2);
+
+} // namespace pdal
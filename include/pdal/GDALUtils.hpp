@@ -41,7 +41,11 @@
 
 #include <array>
 #include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 #include <cpl_port.h>
@@ -234,6 +238,43 @@ public:
     GDALError::Enum readBand(std::vector<uint8_t>& band, int nBand);
 
     void pixelToCoord(int column, int row, std::array<double, 2>& output) const;
+
+    /**
+      Compute the fractional pixel position of a location.  Pixel (c, r)
+      covers the positions [c, c + 1) x [r, r + 1).
+
+      \param x  X coordinate of the location.
+      \param y  Y coordinate of the location.
+      \param[out] column  Column position.
+      \param[out] row  Row position.
+      \return  Whether the location is inside the raster.
+    */
+    bool getPixelPosition(double x, double y, double& column,
+        double& row) const;
+
+    /**
+      Get the natural block size of the raster (the block size of its
+      first band).
+
+      \param[out] width  Block width in pixels.
+      \param[out] height  Block height in pixels.
+    */
+    void getBlockSize(int& width, int& height) const;
+
+    /**
+      Read a window of the raster as doubles.
+
+      \param column  First column of the window.
+      \param row  First row of the window.
+      \param width  Width of the window in pixels.
+      \param height  Height of the window in pixels.
+      \param bands  Bands to read.  Band numbers start at 1.
+      \param data  Vector to fill, band by band, each band in row-major
+        order.  Resized to hold the data.
+    */
+    GDALError::Enum readWindow(int column, int row, int width, int height,
+        const std::vector<int>& bands, std::vector<double>& data);
+
     SpatialReference getSpatialRef() const;
     std::string errorMsg() const
         { return m_errorMsg; }
@@ -259,6 +300,83 @@ private:
     GDALError::Enum computePDALDimensionTypes();
 };
 
+
+/**
+  Samples a raster at arbitrary locations through a least-recently-used
+  cache of the raster's blocks.  Blocks are read from GDAL once, converted
+  to doubles and kept in memory until they're evicted.  Safe to use from
+  multiple threads.
+*/
+class PDAL_DLL BlockCache
+{
+public:
+    /**
+      Create a cache.
+
+      \param raster  Open raster to sample.  Must outlive the cache and
+        must not be read by other code while the cache is in use.
+      \param bands  Bands to sample.  Band numbers start at 1.
+      \param maxBytes  Approximate maximum size of the cached data.  At
+        least one block is always cached.
+    */
+    BlockCache(Raster& raster, const std::vector<int>& bands,
+        size_t maxBytes);
+
+    /**
+      Sample the bands at a location.
+
+      \param x  X coordinate of the location.
+      \param y  Y coordinate of the location.
+      \param bilinear  Interpolate between the four nearest pixel centers
+        rather than taking the value of the pixel holding the location.
+      \param values  Buffer of one entry per band to fill.
+      \return  Whether the location is inside the raster.
+    */
+    bool sample(double x, double y, bool bilinear, double *values);
+
+    /**
+      Sample the bands at many locations.  Locations are grouped by block
+      so that each block is looked up once.
+
+      \param x  X coordinates of the locations.
+      \param y  Y coordinates of the locations.
+      \param bilinear  Interpolate between the four nearest pixel centers.
+      \param values  Filled with one entry per band for each location.
+      \param valid  Set to 1 for each location inside the raster, 0 for
+        others.
+    */
+    void sample(const std::vector<double>& x, const std::vector<double>& y,
+        bool bilinear, std::vector<double>& values, std::vector<char>& valid);
+
+private:
+    struct Block
+    {
+        int m_column;
+        int m_row;
+        int m_width;
+        int m_height;
+        std::vector<double> m_data;
+    };
+    typedef std::shared_ptr<const Block> BlockPtr;
+    typedef std::list<uint64_t> LruList;
+    typedef std::pair<BlockPtr, LruList::iterator> CacheEntry;
+
+    Raster& m_raster;
+    std::vector<int> m_bands;
+    int m_blockWidth;
+    int m_blockHeight;
+    size_t m_maxBlocks;
+    LruList m_lru;
+    std::unordered_map<uint64_t, CacheEntry> m_blocks;
+    std::mutex m_mutex;
+
+    BlockPtr fetch(int blockColumn, int blockRow);
+    uint64_t blockKey(double column, double row) const;
+    void sample(double column, double row, bool bilinear, BlockPtr& block,
+        double *values);
+    double value(int column, int row, size_t band, BlockPtr& block);
+};
+
 } // namespace gdal
 
 
@@ -36,8 +36,11 @@
 
 #include "nanoflann.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <pdal/PointView.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace nanoflann
 {
@@ -51,31 +54,206 @@ namespace nanoflann
 namespace pdal
 {
 
+/**
+  Base for 2D and 3D KD-trees over the points of a view.
+
+  When the index is built, the coordinates of the points are copied into a
+  contiguous array so that the tree can be built and searched without
+  going back to the point view.  Points added to or changed in the view
+  after the index is built aren't seen by the index.
+
+  The search functions are const and may be called concurrently once the
+  index has been built.
+*/
 template<int DIM>
 class PDAL_DLL KDIndex
 {
 protected:
     KDIndex(const PointView& buf) : m_buf(buf)
     {}
-   
+
     ~KDIndex()
     {}
 
 public:
     std::size_t kdtree_get_point_count() const
-        { return m_buf.size(); }
+        { return m_coords.size() / DIM; }
+
+    double kdtree_get_pt(const PointId idx, int dim) const
+    {
+        if (idx >= kdtree_get_point_count())
+            return 0.0;
+        return m_coords[idx * DIM + dim];
+    }
+
+    // nanoflann hands us a vector that represents the position of p1.  We
+    // fetch the position of p2 and and compute the square distance.
+    double kdtree_distance(const double *p1, const PointId idx,
+        size_t /*numDims*/) const
+    {
+        const double *p2 = m_coords.data() + idx * DIM;
+
+        double dist = 0;
+        for (int i = 0; i < DIM; ++i)
+        {
+            double d = p1[i] - p2[i];
+            dist += d * d;
+        }
+        return dist;
+    }
 
-    double kdtree_get_pt(const PointId idx, int dim) const;
-    double kdtree_distance(const double *p1, const PointId p2_idx,
-        size_t /*numDims*/) const;
-    template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const;
-    void build()
+    template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const
     {
+        for (int i = 0; i < DIM; ++i)
+        {
+            bb[i].low = m_min[i];
+            bb[i].high = m_max[i];
+        }
+        return true;
+    }
+
+    /**
+      Build the index.
+
+      \param threads  Maximum number of threads used to copy the point
+        coordinates and to build the tree.
+    */
+    void build(std::size_t threads = 1)
+    {
+        snapshot(threads);
         m_index.reset(new my_kd_tree_t(DIM, *this,
-            nanoflann::KDTreeSingleIndexAdaptorParams(10, DIM)));
+            nanoflann::KDTreeSingleIndexAdaptorParams(10, DIM, threads)));
         m_index->buildIndex();
     }
 
+    /**
+      Find the nearest neighbors of a position.
+
+      \param pos  Position to search from (DIM values).
+      \param k  Number of neighbors to find.  Limited to the number of
+        points in the index.
+      \param ids  Filled with the IDs of the neighbors, nearest first.
+      \param sqrDists  Filled with the square distances to the neighbors.
+    */
+    void knnSearch(const double *pos, point_count_t k,
+        std::vector<PointId>& ids, std::vector<double>& sqrDists) const
+    {
+        k = (std::min)((point_count_t)kdtree_get_point_count(), k);
+        ids.resize(k);
+        sqrDists.resize(k);
+        if (k)
+            findNeighbors(pos, k, ids.data(), sqrDists.data());
+    }
+
+    /**
+      Find the points within a distance of a position.
+
+      \param pos  Position to search from (DIM values).
+      \param r  Search radius.
+      \param ids  Filled with the IDs of the points found, nearest first.
+      \param matches  Working buffer.  Pass the same buffer to successive
+        calls to avoid reallocation.
+    */
+    void radiusSearch(const double *pos, double r, std::vector<PointId>& ids,
+        std::vector<std::pair<std::size_t, double>>& matches) const
+    {
+        ids.clear();
+        if (!kdtree_get_point_count())
+            return;
+
+        nanoflann::SearchParams params;
+        params.sorted = true;
+
+        // Our distance metric is square distance, so we use the square of
+        // the radius.
+        const std::size_t count =
+            m_index->radiusSearch(pos, r * r, matches, params);
+        ids.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            ids.push_back(matches[i].first);
+    }
+
+    /**
+      Find the nearest neighbors of each of a list of positions.
+
+      \param positions  Positions to search from, DIM values per position.
+      \param k  Number of neighbors to find.  Limited to the number of
+        points in the index.
+      \param ids  Filled with the IDs of the neighbors, nearest first.
+        The neighbors of position i are at [i * k, (i + 1) * k).
+      \param sqrDists  Filled with the square distances to the neighbors,
+        in the same order as \a ids.
+      \param threads  Maximum number of threads used to run the queries.
+      \return  The number of neighbors found for each position.
+    */
+    point_count_t knnSearch(const std::vector<double>& positions,
+        point_count_t k, std::vector<PointId>& ids,
+        std::vector<double>& sqrDists, std::size_t threads = 1) const
+    {
+        const std::size_t count = positions.size() / DIM;
+
+        k = (std::min)((point_count_t)kdtree_get_point_count(), k);
+        ids.resize(count * k);
+        sqrDists.resize(count * k);
+        if (!k)
+            return 0;
+
+        auto search = [&](std::size_t begin, std::size_t end, std::size_t)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+                findNeighbors(positions.data() + i * DIM, k,
+                    ids.data() + i * k, sqrDists.data() + i * k);
+        };
+        forChunks(count, threads, search);
+        return k;
+    }
+
+    /**
+      Find the points within a distance of each of a list of positions.
+
+      \param positions  Positions to search from, DIM values per position.
+      \param r  Search radius.
+      \param offsets  Filled with the offsets into \a ids of the points
+        found for each position.  The points found for position i are at
+        [offsets[i], offsets[i + 1]).
+      \param ids  Filled with the IDs of the points found, nearest first
+        for each position.
+      \param threads  Maximum number of threads used to run the queries.
+    */
+    void radiusSearch(const std::vector<double>& positions, double r,
+        std::vector<std::size_t>& offsets, std::vector<PointId>& ids,
+        std::size_t threads = 1) const
+    {
+        const std::size_t count = positions.size() / DIM;
+        const std::size_t numChunks = chunkCount(count, threads);
+
+        // Each chunk of queries collects its results separately.  They're
+        // joined once all the queries are done.
+        std::vector<std::vector<PointId>> chunkIds(numChunks);
+        offsets.assign(count + 1, 0);
+        auto search = [&](std::size_t begin, std::size_t end,
+            std::size_t chunk)
+        {
+            std::vector<PointId>& out = chunkIds[chunk];
+            std::vector<PointId> found;
+            std::vector<std::pair<std::size_t, double>> matches;
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                radiusSearch(positions.data() + i * DIM, r, found, matches);
+                out.insert(out.end(), found.begin(), found.end());
+                offsets[i + 1] = found.size();
+            }
+        };
+        forChunks(count, threads, search);
+
+        for (std::size_t i = 0; i < count; ++i)
+            offsets[i + 1] += offsets[i];
+        ids.clear();
+        ids.reserve(offsets[count]);
+        for (auto& c : chunkIds)
+            ids.insert(ids.end(), c.begin(), c.end());
+    }
+
 protected:
     const PointView& m_buf;
 
@@ -85,6 +263,84 @@ protected:
     std::unique_ptr<my_kd_tree_t> m_index;
 
 private:
+    std::vector<double> m_coords;
+    double m_min[DIM];
+    double m_max[DIM];
+
+    // Number of queries or points handled as a unit by a thread.
+    static const std::size_t ChunkSize = 4096;
+
+    static std::size_t chunkCount(std::size_t count, std::size_t threads)
+    {
+        if (threads < 2)
+            return 1;
+        return (std::max)((std::size_t)1, (count + ChunkSize - 1) / ChunkSize);
+    }
+
+    // Call f(begin, end, chunk) for chunks of [0, count), on a thread pool
+    // if more than one thread is allowed.
+    template<typename FUNC>
+    static void forChunks(std::size_t count, std::size_t threads, FUNC f)
+    {
+        const std::size_t numChunks = chunkCount(count, threads);
+        if (numChunks == 1)
+        {
+            f(0, count, 0);
+            return;
+        }
+
+        ThreadPool pool((std::min)(threads, numChunks));
+        for (std::size_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            std::size_t begin = chunk * ChunkSize;
+            std::size_t end = (std::min)(begin + ChunkSize, count);
+            pool.add([&f, begin, end, chunk](){ f(begin, end, chunk); });
+        }
+        pool.join();
+    }
+
+    void findNeighbors(const double *pos, point_count_t k, PointId *ids,
+        double *sqrDists) const
+    {
+        nanoflann::KNNResultSet<double, PointId, point_count_t> resultSet(k);
+
+        resultSet.init(ids, sqrDists);
+        m_index->findNeighbors(resultSet, pos, nanoflann::SearchParams(10));
+    }
+
+    // Copy the point coordinates into a contiguous array and compute
+    // their bounds.
+    void snapshot(std::size_t threads)
+    {
+        static const Dimension::Id::Enum dims[] =
+            { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+
+        const std::size_t count = m_buf.size();
+        m_coords.resize(count * DIM);
+        auto copy = [this](std::size_t begin, std::size_t end, std::size_t)
+        {
+            double *out = m_coords.data() + begin * DIM;
+            for (PointId idx = begin; idx < end; ++idx)
+                for (int i = 0; i < DIM; ++i)
+                    *out++ = m_buf.getFieldAs<double>(dims[i], idx);
+        };
+        forChunks(count, threads, copy);
+
+        for (int i = 0; i < DIM; ++i)
+        {
+            m_min[i] = count ? (std::numeric_limits<double>::max)() : 0.0;
+            m_max[i] = count ? std::numeric_limits<double>::lowest() : 0.0;
+        }
+        const double *pos = m_coords.data();
+        for (std::size_t idx = 0; idx < count; ++idx)
+            for (int i = 0; i < DIM; ++i)
+            {
+                double v = *pos++;
+                m_min[i] = (std::min)(m_min[i], v);
+                m_max[i] = (std::max)(m_max[i], v);
+            }
+    }
+
     KDIndex(const KDIndex&);
     KDIndex& operator=(KDIndex&);
 };
@@ -100,47 +356,30 @@ public:
             throw pdal_error("KD2Index: point view missing 'Y' dimension.");
     }
 
-    PointId neighbor(double x, double y)
+    PointId neighbor(double x, double y) const
     {
         std::vector<PointId> ids = neighbors(x, y, 1);
         return (ids.size() ? ids[0] : 0);
     }
 
-    std::vector<PointId> neighbors(double x, double y, point_count_t k)
+    std::vector<PointId> neighbors(double x, double y, point_count_t k) const
     {
-        k = std::min(m_buf.size(), k);
-        std::vector<PointId> output(k);
-        std::vector<double> out_dist_sqr(k);
-        nanoflann::KNNResultSet<double, PointId, point_count_t> resultSet(k);
-
-        resultSet.init(&output[0], &out_dist_sqr[0]);
+        const double pos[] = { x, y };
+        std::vector<PointId> output;
+        std::vector<double> out_dist_sqr;
 
-        std::vector<double> pt;
-        pt.push_back(x);
-        pt.push_back(y);
-        m_index->findNeighbors(resultSet, &pt[0], nanoflann::SearchParams(10));
+        knnSearch(pos, k, output, out_dist_sqr);
         return output;
     }
 
     std::vector<PointId> radius(double const& x, double const& y,
         double const& r) const
     {
+        const double pos[] = { x, y };
         std::vector<PointId> output;
         std::vector<std::pair<std::size_t, double>> ret_matches;
-        nanoflann::SearchParams params;
-        params.sorted = true;
-
-        std::vector<double> pt;
-        pt.push_back(x);
-        pt.push_back(y);
 
-        // Our distance metric is square distance, so we use the square of
-        // the radius.
-        const std::size_t count =
-            m_index->radiusSearch(&pt[0], r * r, ret_matches, params);
-
-        for (std::size_t i = 0; i < count; ++i)
-            output.push_back(ret_matches[i].first);
+        radiusSearch(pos, r, output, ret_matches);
         return output;
     }
 };
@@ -158,177 +397,32 @@ public:
             throw pdal_error("KD3Index: point view missing 'Z' dimension.");
     }
 
-    PointId neighbor(double x, double y, double z)
+    PointId neighbor(double x, double y, double z) const
     {
         std::vector<PointId> ids = neighbors(x, y, z, 1);
         return (ids.size() ? ids[0] : 0);
     }
 
     std::vector<PointId> neighbors(double x, double y, double z,
-        point_count_t k)
+        point_count_t k) const
     {
-        k = std::min(m_buf.size(), k);
-        std::vector<PointId> output(k);
-        std::vector<double> out_dist_sqr(k);
-        nanoflann::KNNResultSet<double, PointId, point_count_t> resultSet(k);
-
-        resultSet.init(&output[0], &out_dist_sqr[0]);
+        const double pos[] = { x, y, z };
+        std::vector<PointId> output;
+        std::vector<double> out_dist_sqr;
 
-        std::vector<double> pt;
-        pt.push_back(x);
-        pt.push_back(y);
-        pt.push_back(z);
-        m_index->findNeighbors(resultSet, &pt[0], nanoflann::SearchParams(10));
+        knnSearch(pos, k, output, out_dist_sqr);
         return output;
     }
 
     std::vector<PointId> radius(double x, double y, double z, double r) const
     {
+        const double pos[] = { x, y, z };
         std::vector<PointId> output;
         std::vector<std::pair<std::size_t, double>> ret_matches;
-        nanoflann::SearchParams params;
-        params.sorted = true;
-
-        std::vector<double> pt;
-        pt.push_back(x);
-        pt.push_back(y);
-        pt.push_back(z);
-
-        // Our distance metric is square distance, so we use the square of
-        // the radius.
-        const std::size_t count =
-            m_index->radiusSearch(&pt[0], r * r, ret_matches, params);
 
-        for (std::size_t i = 0; i < count; ++i)
-            output.push_back(ret_matches[i].first);
+        radiusSearch(pos, r, output, ret_matches);
         return output;
     }
 };
 
-template<>
-inline
-double KDIndex<2>::kdtree_get_pt(const PointId idx, int dim) const
-{
-    if (idx >= m_buf.size())
-        return 0.0;
-
-    Dimension::Id::Enum id = Dimension::Id::Unknown;
-    switch (dim)
-    {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    default:
-        throw pdal_error("kdtree_get_pt: Request for invalid dimension "
-            "from nanoflann");
-    }
-    return m_buf.getFieldAs<double>(id, idx);
-}
-
-template<>
-inline
-double KDIndex<3>::kdtree_get_pt(const PointId idx, int dim) const
-{
-    if (idx >= m_buf.size())
-        return 0.0;
-
-    Dimension::Id::Enum id = Dimension::Id::Unknown;
-    switch (dim)
-    {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    case 2:
-        id = Dimension::Id::Z;
-        break;
-    default:
-        throw pdal_error("kdtree_get_pt: Request for invalid dimension "
-            "from nanoflann");
-    }
-    return m_buf.getFieldAs<double>(id, idx);
-}
-
-// nanoflann hands us a vector that represents the position of p1.  We fetch
-// the position of p2 and and compute the square distance.
-template<>
-inline double KDIndex<2>::kdtree_distance(const double *p1, const PointId idx,
-    size_t /*numDims*/) const
-{
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-
-    return (d0 * d0 + d1 * d1);
-}
-
-template<>
-inline double KDIndex<3>::kdtree_distance(const double *p1, const PointId idx,
-    size_t /*numDims*/) const
-{
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-    double d2 = p1[2] - m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
-
-    return (d0 * d0 + d1 * d1 + d2 * d2);
-}
-
-
-template<>
-template <class BBOX>
-bool KDIndex<2>::kdtree_get_bbox(BBOX& bb) const
-{
-    if (m_buf.empty())
-    {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
-    }
-    else
-    {
-        BOX2D bounds;
-        m_buf.calculateBounds(bounds);
-
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
-    }
-    return true;
-}
-
-template<>
-template <class BBOX>
-bool KDIndex<3>::kdtree_get_bbox(BBOX& bb) const
-{
-    if (m_buf.empty())
-    {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
-        bb[2].low = 0.0;
-        bb[2].high = 0.0;
-    }
-    else
-    {
-        BOX3D bounds;
-        m_buf.calculateBounds(bounds);
-
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
-        bb[2].low = bounds.minz;
-        bb[2].high = bounds.maxz;
-    }
-    return true;
-}
-
 } // namespace pdal
-
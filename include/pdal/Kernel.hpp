@@ -81,6 +81,7 @@ protected:
     Stage& createStage(const std::string& name);
     Stage& makeReader(const std::string& inputFile);
     Stage& makeWriter(const std::string& outputFile, Stage& parent);
+    void outputTiming(const std::vector<Stage *>& stages);
 
 public:
     virtual void addSwitches(ProgramArgs& args)
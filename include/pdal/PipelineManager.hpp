@@ -49,15 +49,16 @@ class PDAL_DLL PipelineManager
 {
 public:
     PipelineManager() : m_tablePtr(new PointTable()), m_table(*m_tablePtr),
-            m_progressFd(-1)
+            m_progressFd(-1), m_threads(1), m_timing(false)
         {}
     PipelineManager(int progressFd) : m_tablePtr(new PointTable()),
-            m_table(*m_tablePtr), m_progressFd(progressFd)
+            m_table(*m_tablePtr), m_progressFd(progressFd), m_threads(1), m_timing(false)
         {}
-    PipelineManager(PointTableRef table) : m_table(table), m_progressFd(-1)
+    PipelineManager(PointTableRef table) : m_table(table), m_progressFd(-1),
+            m_threads(1), m_timing(false)
         {}
     PipelineManager(PointTableRef table, int progressFd) : m_table(table),
-            m_progressFd(progressFd)
+            m_progressFd(progressFd), m_threads(1), m_timing(false)
         {}
 
     void readPipeline(std::istream& input);
@@ -76,6 +77,22 @@ public:
     Stage* getStage() const
         { return m_stages.empty() ? nullptr : m_stages.back(); }
 
+    // Set the maximum number of threads used to run point views through
+    // each (thread-safe) stage of the pipeline.
+    void setThreads(std::size_t threads);
+    std::size_t threads() const
+        { return m_threads; }
+
+    // Enable the emission of per-stage timing and memory statistics into
+    // the metadata of each stage of the pipeline.
+    void setTiming(bool timing);
+    bool timing() const
+        { return m_timing; }
+
+    // Get the stages of the pipeline in the order they were added.
+    const std::vector<Stage*>& stages() const
+        { return m_stages; }
+
     void prepare() const;
     point_count_t execute();
 
@@ -98,6 +115,8 @@ private:
 
     std::vector<Stage*> m_stages; // stage observer, never owner
     int m_progressFd;
+    std::size_t m_threads;
+    bool m_timing;
 
     PipelineManager& operator=(const PipelineManager&); // not implemented
     PipelineManager(const PipelineManager&); // not implemented
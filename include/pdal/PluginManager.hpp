@@ -65,6 +65,31 @@ class PDAL_DLL PluginManager
     typedef std::vector<PF_ExitFunc> ExitFuncVec;
     typedef std::map<std::string, PF_RegisterParams> RegistrationInfoMap;
 
+    // A stage provided by a plugin library that hasn't been loaded.
+    struct ManifestStage
+    {
+        std::string m_name;
+        PF_PluginType m_type;
+        std::string m_description;
+        std::string m_link;
+        std::string m_library;
+    };
+
+    // What a plugin library registered when it was last loaded, along
+    // with the file's modification time and size, used to check that the
+    // entry is still valid.
+    struct ManifestLibrary
+    {
+        ManifestLibrary() : m_size(0)
+        {}
+
+        std::string m_mtime;
+        uintmax_t m_size;
+        std::vector<ManifestStage> m_stages;
+    };
+    typedef std::map<std::string, ManifestLibrary> Manifest;
+    typedef std::map<std::string, ManifestStage> DeferredStageMap;
+
 public:
     PluginManager();
     ~PluginManager();
@@ -95,6 +120,10 @@ private:
     StringList l_names(int typeMask);
     std::string l_description(const std::string& name);
     std::string l_link(const std::string& name);
+    bool loadDeferred(const std::string& name);
+    void deferOrLoad(const std::string& path, int type);
+    void readManifest();
+    void writeManifest();
 
     DynamicLibrary *loadLibrary(const std::string& path,
         std::string& errorString);
@@ -103,6 +132,11 @@ private:
     DynamicLibraryMap m_dynamicLibraryMap;
     ExitFuncVec m_exitFuncVec;
     RegistrationInfoMap m_plugins;
+    Manifest m_manifest;
+    DeferredStageMap m_deferred;
+    std::string m_manifestFilename;
+    bool m_manifestRead;
+    bool m_manifestDirty;
     std::mutex m_mutex;
 
     // Disable copy/assignment.
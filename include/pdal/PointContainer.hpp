@@ -46,6 +46,7 @@ class PDAL_DLL PointContainer
     friend class PointTable;
     friend class PointView;
     friend class PointRef;
+    friend class PointSpan;
 private:
     virtual void setFieldInternal(Dimension::Id::Enum dim, PointId idx,
         const void *val) = 0;
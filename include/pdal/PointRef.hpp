@@ -154,6 +154,20 @@ public:
             m_container.setFieldInternal(dim, m_idx, &e);
     }
 
+    /// Fetch the value of a dimension in its stored type, without conversion.
+    /// \param[in] dim  Dimension to fetch.
+    /// \param[in] buf  Buffer to fill.  Must be large enough to hold
+    ///    a value of the dimension's stored type.
+    void getRawField(Dimension::Id::Enum dim, void *buf) const
+        { m_container.getFieldInternal(dim, m_idx, buf); }
+
+    /// Set the value of a dimension from a value in its stored type,
+    /// without conversion.
+    /// \param[in] dim  Dimension to set.
+    /// \param[in] buf  Buffer holding a value of the dimension's stored type.
+    void setRawField(Dimension::Id::Enum dim, const void *buf)
+        { m_container.setFieldInternal(dim, m_idx, buf); }
+
     void setPointId(PointId idx)
         { m_idx = idx; }
     inline void getField(char *val, Dimension::Id::Enum d,
@@ -0,0 +1,239 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <pdal/PointContainer.hpp>
+#include <pdal/PointLayout.hpp>
+#include <pdal/PointRef.hpp>
+#include <pdal/util/Utils.hpp>
+
+namespace pdal
+{
+
+/**
+  A contiguous range of points in a point container along with a mask of
+  points that have been filtered out.  Used to hand a block of points to a
+  stage in streaming mode (see Stage::processBatch()).
+*/
+class PDAL_DLL PointSpan
+{
+public:
+    /**
+      Create a span.
+
+      \param container  Container holding the points.
+      \param begin  Index of first point in the span.
+      \param end  Index one past the last point in the span.
+      \param skips  Mask with one entry per point in the span.  Non-zero
+        entries mark points that have been filtered out.
+    */
+    PointSpan(PointContainer& container, PointId begin, PointId end,
+            char *skips) :
+        m_container(container), m_layout(*container.layout()),
+        m_begin(begin), m_end(end), m_skips(skips)
+    {}
+
+    PointId begin() const
+        { return m_begin; }
+    PointId end() const
+        { return m_end; }
+    point_count_t size() const
+        { return m_end - m_begin; }
+    PointContainer& container() const
+        { return m_container; }
+    PointRef point(PointId idx) const
+        { return PointRef(m_container, idx); }
+    bool hasDim(Dimension::Id::Enum dim) const
+        { return m_layout.hasDim(dim); }
+
+    /**
+      Determine if a point has been filtered out.
+
+      \param idx  Index of the point.
+      \return  Whether the point has been filtered out.
+    */
+    bool skipped(PointId idx) const
+        { return m_skips[idx - m_begin]; }
+
+    /**
+      Filter out a point so that it isn't passed to subsequent stages.
+
+      \param idx  Index of the point.
+    */
+    void skip(PointId idx)
+        { m_skips[idx - m_begin] = 1; }
+
+    /**
+      Fetch the values of a dimension for every point in the span, including
+      points that have been filtered out.  The stored type of the dimension
+      is determined once for the span rather than once per point.
+
+      \param dim  Dimension to fetch.
+      \param vals  Vector to fill.  Resized to the size of the span.
+    */
+    template<typename T>
+    void getFieldAs(Dimension::Id::Enum dim, std::vector<T>& vals) const
+    {
+        vals.resize(size());
+        switch (m_layout.dimDetail(dim)->type())
+        {
+        case Dimension::Type::Unsigned8:
+            fetch<uint8_t>(dim, vals);
+            break;
+        case Dimension::Type::Unsigned16:
+            fetch<uint16_t>(dim, vals);
+            break;
+        case Dimension::Type::Unsigned32:
+            fetch<uint32_t>(dim, vals);
+            break;
+        case Dimension::Type::Unsigned64:
+            fetch<uint64_t>(dim, vals);
+            break;
+        case Dimension::Type::Signed8:
+            fetch<int8_t>(dim, vals);
+            break;
+        case Dimension::Type::Signed16:
+            fetch<int16_t>(dim, vals);
+            break;
+        case Dimension::Type::Signed32:
+            fetch<int32_t>(dim, vals);
+            break;
+        case Dimension::Type::Signed64:
+            fetch<int64_t>(dim, vals);
+            break;
+        case Dimension::Type::Float:
+            fetch<float>(dim, vals);
+            break;
+        case Dimension::Type::Double:
+            fetch<double>(dim, vals);
+            break;
+        case Dimension::Type::None:
+            std::fill(vals.begin(), vals.end(), T(0));
+            break;
+        }
+    }
+
+    /**
+      Set the values of a dimension for the points in the span that haven't
+      been filtered out.
+
+      \param dim  Dimension to set.
+      \param vals  Values, one per point in the span.
+    */
+    template<typename T>
+    void setField(Dimension::Id::Enum dim, const std::vector<T>& vals)
+    {
+        switch (m_layout.dimDetail(dim)->type())
+        {
+        case Dimension::Type::Unsigned8:
+            store<uint8_t>(dim, vals);
+            break;
+        case Dimension::Type::Unsigned16:
+            store<uint16_t>(dim, vals);
+            break;
+        case Dimension::Type::Unsigned32:
+            store<uint32_t>(dim, vals);
+            break;
+        case Dimension::Type::Unsigned64:
+            store<uint64_t>(dim, vals);
+            break;
+        case Dimension::Type::Signed8:
+            store<int8_t>(dim, vals);
+            break;
+        case Dimension::Type::Signed16:
+            store<int16_t>(dim, vals);
+            break;
+        case Dimension::Type::Signed32:
+            store<int32_t>(dim, vals);
+            break;
+        case Dimension::Type::Signed64:
+            store<int64_t>(dim, vals);
+            break;
+        case Dimension::Type::Float:
+            store<float>(dim, vals);
+            break;
+        case Dimension::Type::Double:
+            store<double>(dim, vals);
+            break;
+        case Dimension::Type::None:
+            break;
+        }
+    }
+
+private:
+    PointContainer& m_container;
+    PointLayout& m_layout;
+    PointId m_begin;
+    PointId m_end;
+    char *m_skips;
+
+    template<typename T_STORED, typename T>
+    void fetch(Dimension::Id::Enum dim, std::vector<T>& vals) const
+    {
+        T_STORED in;
+        for (PointId idx = m_begin; idx < m_end; ++idx)
+        {
+            m_container.getFieldInternal(dim, idx, &in);
+            T& out = vals[idx - m_begin];
+            if (!Utils::numericCast(in, out))
+            {
+                std::ostringstream oss;
+                oss << "Unable to fetch data and convert as requested: ";
+                oss << Dimension::name(dim) << ":" <<
+                    Utils::typeidName<T_STORED>() <<
+                    "(" << (double)in << ") -> " << Utils::typeidName<T>();
+                throw pdal_error(oss.str());
+            }
+        }
+    }
+
+    template<typename T_STORED, typename T>
+    void store(Dimension::Id::Enum dim, const std::vector<T>& vals)
+    {
+        T_STORED out;
+        for (PointId idx = m_begin; idx < m_end; ++idx)
+        {
+            if (skipped(idx))
+                continue;
+            if (Utils::numericCast(vals[idx - m_begin], out))
+                m_container.setFieldInternal(dim, idx, &out);
+        }
+    }
+};
+
+} // namespace pdal
+
@@ -92,6 +92,11 @@ public:
     virtual bool supportsView() const
         { return false; }
 
+    /// Get the number of bytes allocated to hold point data.
+    /// \return  Bytes of point storage.
+    virtual std::size_t memoryUsage() const
+        { return 0; }
+
     MetadataNode privateMetadata(const std::string& name);
 
 private:
@@ -153,6 +158,8 @@ public:
     virtual ~PointTable();
     virtual bool supportsView() const
         { return true; }
+    virtual std::size_t memoryUsage() const
+        { return m_blocks.size() * pointsToBytes(m_blockPtCnt); }
 
 protected:
     virtual char *getPoint(PointId idx);
@@ -164,6 +171,76 @@ private:
     PointLayout m_layout;
 };
 
+/// A point table that stores each dimension in its own contiguous array
+/// (structure-of-arrays) rather than storing points one after another.
+/// Stages that scan only a few dimensions touch much less memory.  Raw
+/// typed access to a dimension's array is available through column().
+/// Raw access to a whole point (PointView::getPoint()) is supported by
+/// packing the point into a scratch row, which is written back to the
+/// columns on the next access to the table, so it is slow and must not be
+/// used while other threads access the table.
+class PDAL_DLL ColumnPointTable : public BasePointTable
+{
+public:
+    ColumnPointTable() : BasePointTable(m_layout), m_numPts(0),
+        m_capacity(0), m_rowId(0), m_rowValid(false)
+        {}
+    virtual bool supportsView() const
+        { return true; }
+    virtual void finalize();
+    virtual std::size_t memoryUsage() const
+        { return m_capacity * m_layoutRef.pointSize(); }
+
+    /// Get a pointer to the array holding the values of a dimension.
+    /// Values are indexed by the point's ID in the table (see
+    /// PointView::rawId()).  The pointer is invalidated when points are
+    /// added to the table.
+    /// \param id  ID of the dimension.
+    /// \return  Pointer to the first value of the dimension.
+    template<typename T>
+    T *column(Dimension::Id::Enum id)
+    {
+        const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+        if (d->type() != Dimension::type<T>())
+        {
+            std::ostringstream oss;
+            oss << "Can't access dimension '" << m_layoutRef.dimName(id) <<
+                "' of type " << Dimension::interpretationName(d->type()) <<
+                " as " << Utils::typeidName<T>() << ".";
+            throw pdal_error(oss.str());
+        }
+        flushRow();
+        return reinterpret_cast<T *>(m_columns[id].data());
+    }
+
+    /// Get the number of points stored in the table.
+    /// \return  Number of points.
+    point_count_t size() const
+        { return m_numPts; }
+
+protected:
+    virtual char *getPoint(PointId idx);
+
+private:
+    virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id::Enum id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id::Enum id, PointId idx,
+        void *value) const;
+    void flushRow();
+
+    // Column data and value size, indexed by dimension ID.
+    std::vector<std::vector<char>> m_columns;
+    std::vector<size_t> m_sizes;
+    point_count_t m_numPts;
+    point_count_t m_capacity;
+    // Point handed out by getPoint(), in the layout's packed order.
+    std::vector<char> m_row;
+    PointId m_rowId;
+    bool m_rowValid;
+    PointLayout m_layout;
+};
+
 /// A StreamPointTable must provide storage for point data up to its capacity.
 /// It must implement getPoint() which returns a pointer to a buffer of
 /// sufficient size to contain a point's data.  The minimum size required
@@ -188,6 +265,16 @@ public:
     /// the point data will be potentially overwritten.
     virtual void reset()
     {}
+    /// Called when the points in a range of the StreamPointTable have been
+    /// consumed and their data will be potentially overwritten.  Serial
+    /// streaming passes the filled part of the table.  Streaming that
+    /// overlaps stages passes each segment of the table as it's released,
+    /// while other segments may still hold unconsumed points.  By default
+    /// calls reset().
+    /// \param begin  ID of the first point in the range.
+    /// \param count  Number of points in the range.
+    virtual void resetSegment(PointId /*begin*/, point_count_t /*count*/)
+        { reset(); }
     virtual point_count_t capacity() const = 0;
 };
 
@@ -209,6 +296,8 @@ public:
 
     point_count_t capacity() const
         { return m_capacity; }
+    virtual std::size_t memoryUsage() const
+        { return m_buf.size(); }
 protected:
     virtual char *getPoint(PointId idx)
         { return m_buf.data() + pointsToBytes(idx); }
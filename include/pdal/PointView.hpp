@@ -41,6 +41,7 @@
 #include <pdal/PointRef.hpp>
 #include <pdal/PointTable.hpp>
 
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <set>
@@ -90,6 +91,25 @@ public:
         { return m_size == 0; }
 
     inline void appendPoint(const PointView& buffer, PointId id);
+
+    /**
+      Add points to the end of the view.  The points can then be set in any
+      order, which allows them to be filled by multiple threads as long as
+      no two threads set the same point.
+
+      \param count  Number of points to add.
+    */
+    void addPoints(point_count_t count);
+
+    /**
+      Reorder the points of the view.  Only the view's index is permuted;
+      point data isn't moved.
+
+      \param order  Current indices of the points in their new order.  Must
+        be a permutation of the indices of the view's points.
+    */
+    void reorder(const std::vector<PointId>& order);
+
     void append(const PointView& buf)
     {
         // We use size() instead of the index end because temp points
@@ -242,6 +262,15 @@ public:
     }
 
 
+    /// Get the point table that stores the view's points.
+    PointTableRef table() const
+        { return m_pointTable; }
+
+    /// Get the ID in the point table of a point in the view.
+    /// \param[in] idx  Index of the point in the view.
+    PointId rawId(PointId idx) const
+        { return m_index[idx]; }
+
     /// Provides access to the memory storing the point data.  Though this
     /// function is public, other access methods are safer and preferred.
     char *getPoint(PointId id)
@@ -267,7 +296,7 @@ protected:
     SpatialReference m_spatialReference;
 
 private:
-    static int m_lastId;
+    static std::atomic<int> m_lastId;
 
     template<typename T_IN, typename T_OUT>
     bool convertAndSet(Dimension::Id::Enum dim, PointId idx, T_IN in);
@@ -36,6 +36,7 @@
 #include <pdal/pdal_types.hpp>
 #include <pdal/Log.hpp>
 #include <pdal/PointRef.hpp>
+#include <pdal/PolygonIndex.hpp>
 #include <pdal/GDALUtils.hpp>
 #include <pdal/GEOSUtils.hpp>
 #include <pdal/util/Bounds.hpp>
@@ -96,6 +97,19 @@ public:
     double area() const;
 
     bool covers(PointRef& ref) const;
+    bool covers(double x, double y, double z = 0.0) const;
+
+    /**
+      Test a block of points for containment.  Points on the boundary
+      are covered.
+
+      \param x  X coordinates of the points.
+      \param y  Y coordinates of the points.
+      \param inside  Set to 1 for each covered point and 0 for each point
+        that isn't covered.  Resized to the number of points.
+    */
+    void covers(const std::vector<double>& x, const std::vector<double>& y,
+        std::vector<char>& inside) const;
     bool equal(const Polygon& p) const;
 
     bool valid() const;
@@ -112,7 +126,7 @@ private:
 
     void initializeFromBounds(const BOX3D& b);
     GEOSGeometry *m_geom;
-    const GEOSPreparedGeometry *m_prepGeom;
+    PolygonIndex m_index;
 
     SpatialReference m_srs;
     GEOSContextHandle_t m_ctx;
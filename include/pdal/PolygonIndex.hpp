@@ -0,0 +1,134 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Point-in-polygon index over the rings of one or more polygons.
+
+  Edges of the rings are bucketed into horizontal bands so that a
+  containment test only visits the edges that cross the band holding the
+  point.  Containment is determined by counting the crossings of a ray cast
+  in the +X direction (even-odd rule), so exterior rings and holes of all
+  polygons are simply added as rings.  Points on an edge are covered,
+  matching the semantics of Polygon::covers().
+*/
+class PDAL_DLL PolygonIndex
+{
+public:
+    PolygonIndex();
+
+    /**
+      Remove all rings from the index.
+    */
+    void clear();
+
+    /**
+      Add a ring to the index.  Must be followed by a call to build() before
+      the index is queried.
+
+      \param x  X coordinates of the ring's vertices.
+      \param y  Y coordinates of the ring's vertices.  The ring is closed
+        automatically if the last vertex isn't equal to the first.
+    */
+    void addRing(const std::vector<double>& x, const std::vector<double>& y);
+
+    /**
+      Bucket the edges of the rings that have been added.
+    */
+    void build();
+
+    /**
+      Determine if the index has no edges.
+    */
+    bool empty() const
+        { return m_edges.empty(); }
+
+    /**
+      Determine if a point is inside or on the boundary of the polygons.
+
+      \param x  X coordinate of the point.
+      \param y  Y coordinate of the point.
+      \return  Whether the point is covered.
+    */
+    bool covers(double x, double y) const;
+
+    /**
+      Test a block of points for containment.
+
+      \param x  X coordinates of the points.
+      \param y  Y coordinates of the points.
+      \param count  Number of points to test.
+      \param inside  Buffer of \a count entries, set to 1 for points that
+        are covered and 0 for points that aren't.
+    */
+    void covers(const double *x, const double *y, size_t count,
+        char *inside) const;
+
+private:
+    struct Edge
+    {
+        Edge(double x1, double y1, double x2, double y2);
+
+        double m_x1;
+        double m_y1;
+        double m_x2;
+        double m_y2;
+        double m_minx;
+        double m_maxx;
+        double m_dxdy;
+    };
+
+    std::vector<Edge> m_edges;
+    std::vector<Edge> m_bandEdges;
+    std::vector<size_t> m_bandStart;
+    double m_minx;
+    double m_maxx;
+    double m_miny;
+    double m_maxy;
+    double m_bandScale;
+    size_t m_numBands;
+
+    size_t band(double y) const;
+};
+
+} // namespace pdal
@@ -45,9 +45,11 @@
 #include <pdal/PipelineWriter.hpp>
 #include <pdal/PointTable.hpp>
 #include <pdal/PointRef.hpp>
+#include <pdal/PointSpan.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/QuickInfo.hpp>
 #include <pdal/SpatialReference.hpp>
+#include <pdal/StageStats.hpp>
 
 namespace pdal
 {
@@ -90,6 +92,44 @@ public:
     void setProgressFd(int fd)
         { m_progressFd = fd; }
 
+    /**
+      Set the maximum number of threads that may be used to run point
+      views through this stage concurrently.  Only stages that report
+      themselves as thread-safe are run concurrently.
+
+      \param threads  Maximum number of threads.
+    */
+    void setThreads(std::size_t threads)
+        { m_threads = threads; }
+
+    /**
+      Get the maximum number of threads that may be used to run point
+      views through this stage.
+
+      \return  Maximum number of threads.
+    */
+    std::size_t threads() const
+        { return m_threads; }
+
+    /**
+      Set whether the stage's execution statistics (see StageStats) are
+      added to its metadata, as a node named "timing", when it's executed.
+      Statistics are collected regardless.
+
+      \param timing  Whether to add statistics to the stage's metadata.
+    */
+    void setTiming(bool timing)
+        { m_timing = timing; }
+
+    /**
+      Get the statistics collected when the stage was last prepared and
+      executed.
+
+      \return  The stage's execution statistics.
+    */
+    const StageStats& stats() const
+        { return m_stats; }
+
     /**
       Retrieve some basic point information without reading all data when
       possible.  Usually implemented only by Readers.
@@ -126,7 +166,8 @@ public:
       Execute a prepared pipeline (linked set of stages) in streaming mode.
 
       This performs the action associated with the stage by executing the
-      \ref processOne function of each stage in depth first order.  Points
+      \ref processOne function of the reader and the \ref processBatch
+      function of each subsequent stage in depth first order.  Points
       are processed up to the capacity of the provided StreamPointTable.
       Not all stages support streaming mode and an exception will be thrown
       when attempting to \ref execute an unsupported stage.
@@ -134,12 +175,29 @@ public:
       Streaming points can reduce memory consumption, but may limit access
       to algorithms that need to operate on full point sets.
 
+      If the stage's thread count (see \ref setThreads) is greater than one,
+      the reader, the last stage and each thread-safe filter (see
+      \ref threadSafe) run on their own threads and the table is split into
+      segments, so that reading, filtering and writing of successive
+      segments overlap.  Other filters run on the thread of the stage before
+      them.  Each stage is still called from a single thread and sees points
+      in order.  The table's resetSegment() is called as each segment is
+      released.
+
       \param table  Streming point table used for stage pipeline.  This must be
         the same \ref table used in the \ref prepare function.
 
     */
     void execute(StreamPointTable& table);
 
+    /**
+      Determine whether this stage and all of its inputs support streaming
+      mode, so that \ref execute(StreamPointTable&) can be used.
+
+      \return  Whether the pipeline ending at this stage can be streamed.
+    */
+    bool pipelineStreamable() const;
+
     /**
       Set the spatial reference of a stage.
 
@@ -278,12 +336,15 @@ protected:
     Options m_options;          ///< Stage's options.
     MetadataNode m_metadata;    ///< Stage's metadata.
     int m_progressFd;           ///< Descriptor for progress info.
+    std::size_t m_threads;      ///< Maximum threads used to run views.
+    StageStats m_stats;         ///< Execution statistics.
 
     void setSpatialReference(MetadataNode& m, SpatialReference const&);
 
 private:
     bool m_debug;
     uint32_t m_verbose;
+    bool m_timing;
     std::vector<Stage *> m_inputs;
     LogPtr m_log;
     SpatialReference m_spatialReference;
@@ -306,6 +367,8 @@ private:
     virtual void writerProcessOptions(const Options& /*options*/)
         {}
     void l_initialize(PointTableRef table);
+    void recordStats(PointTableRef table);
+    void processSpan(PointSpan& span);
 
     /**
       Get basic metadata (avoids reading points).  Implement in subclass.
@@ -359,6 +422,15 @@ private:
     virtual void ready(PointTableRef /*table*/)
         {}
 
+    /**
+      Determine whether the stage supports streaming mode.  Stages that
+      return true must implement \ref processOne.  Implement in subclass.
+
+      \return  Whether the stage can be streamed.
+    */
+    virtual bool streamable() const
+        { return false; }
+
     /**
       Process a single point (streaming mode).  Implement in sublcass.
 
@@ -374,6 +446,42 @@ private:
         throw pdal_error(oss.str());
     }
 
+    /**
+      Process a block of points (streaming mode).  Points that have been
+      filtered out by a previous stage are marked as skipped in the span
+      and should be ignored.  The default implementation calls
+      \ref processOne for each point that hasn't been skipped.  Implement
+      in subclass when a stage can process a block of points more
+      efficiently than one point at a time.
+
+      \param span  Points to process.  Filters call PointSpan::skip() for
+        points that are to be filtered out.
+    */
+    virtual void processBatch(PointSpan& span)
+    {
+        PointRef point(span.container(), span.begin());
+        for (PointId idx = span.begin(); idx < span.end(); ++idx)
+        {
+            if (span.skipped(idx))
+                continue;
+            point.setPointId(idx);
+            if (!processOne(point))
+                span.skip(idx);
+        }
+    }
+
+    /**
+      Determine whether \ref run may be called for several point views
+      at the same time from different threads.  Stages that return true
+      must not modify shared state in \ref run and must not add points
+      to the point table.  Thread-safe filters also get a thread of their
+      own when streaming with more than one thread.  Implement in subclass.
+
+      \return  Whether the stage can run views concurrently.
+    */
+    virtual bool threadSafe() const
+        { return false; }
+
     /**
       Process all points in a view.  Implement in subclass.
 
@@ -394,6 +502,12 @@ private:
         {}
 
     void execute(StreamPointTable& table, std::list<Stage *>& stages);
+    void executeOverlapped(StreamPointTable& table,
+        std::list<Stage *>& stages);
+
+    // Number of segments into which a stream table is split for
+    // overlapped execution.
+    static const point_count_t m_streamSegments = 3;
 
     /*
       Test hook.
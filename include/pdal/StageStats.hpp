@@ -0,0 +1,162 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include <pdal/Metadata.hpp>
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/**
+  Execution statistics of a stage: the wall-clock and CPU time spent in
+  each phase of execution, the number of points passing through the stage,
+  the bytes read or written by I/O stages and the peak memory held by the
+  point table.  Statistics may be accumulated from several threads.
+*/
+class PDAL_DLL StageStats
+{
+public:
+    /// Phases of execution that are timed.  Process covers streaming
+    /// (processOne() and processBatch()).
+    enum Phase
+    {
+        Prepare,
+        Ready,
+        Run,
+        Process,
+        Done,
+        NumPhases
+    };
+
+    /**
+      Times a phase from construction to destruction and adds the time
+      to the statistics.
+    */
+    class PDAL_DLL Timer
+    {
+    public:
+        Timer(StageStats& stats, Phase phase);
+        ~Timer();
+
+    private:
+        StageStats& m_stats;
+        Phase m_phase;
+        std::chrono::steady_clock::time_point m_start;
+        double m_cpuStart;
+
+        Timer(const Timer&); // not implemented
+        Timer& operator=(const Timer&); // not implemented
+    };
+
+    StageStats();
+
+    /**
+      Clear all statistics.
+    */
+    void reset();
+
+    /**
+      Add time spent in a phase.
+
+      \param phase  Phase of execution.
+      \param wall  Elapsed time in seconds.
+      \param cpu  CPU time of the calling thread in seconds.
+    */
+    void addTime(Phase phase, double wall, double cpu);
+
+    void addPointsIn(point_count_t count);
+    void addPointsOut(point_count_t count);
+    void addBytesRead(uint64_t count);
+    void addBytesWritten(uint64_t count);
+
+    /**
+      Note the memory held by the point table.  The largest value noted
+      is kept.
+
+      \param bytes  Bytes of point data held by the table.
+    */
+    void noteTableMemory(uint64_t bytes);
+
+    double wallTime(Phase phase) const;
+    double cpuTime(Phase phase) const;
+    point_count_t pointsIn() const;
+    point_count_t pointsOut() const;
+    uint64_t bytesRead() const;
+    uint64_t bytesWritten() const;
+    uint64_t tableMemory() const;
+
+    /**
+      Add the statistics to a metadata node as a child named "timing".
+
+      \param parent  Node to which the statistics should be added.
+    */
+    void toMetadata(MetadataNode parent) const;
+
+    /**
+      Get the name of a phase as it appears in metadata.
+
+      \param phase  Phase of execution.
+      \return  Name of the phase.
+    */
+    static std::string phaseName(Phase phase);
+
+    /**
+      Get the CPU time used by the calling thread.
+
+      \return  CPU time in seconds.
+    */
+    static double threadCpuTime();
+
+private:
+    double m_wall[NumPhases];
+    double m_cpu[NumPhases];
+    point_count_t m_pointsIn;
+    point_count_t m_pointsOut;
+    uint64_t m_bytesRead;
+    uint64_t m_bytesWritten;
+    uint64_t m_tableMemory;
+    mutable std::mutex m_mutex;
+
+    StageStats(const StageStats&); // not implemented
+    StageStats& operator=(const StageStats&); // not implemented
+};
+
+} // namespace pdal
@@ -243,6 +243,77 @@ namespace FileUtils
       \return  Stem of filename.
     */
     PDAL_DLL std::string stem(const std::string& path);
+
+    /**
+      State of a file mapped to memory with mapFile().
+    */
+    struct MapContext
+    {
+        MapContext() : m_fd(-1), m_size(0), m_addr(nullptr), m_base(nullptr),
+            m_baseSize(0)
+#ifdef _WIN32
+            , m_handle(nullptr)
+#endif
+        {}
+
+        /**
+          Get the address of the first mapped byte.
+
+          \return  Address of the mapping, or nullptr if the file
+            isn't mapped.
+        */
+        void *addr() const
+            { return m_addr; }
+
+        /**
+          Get the number of bytes mapped.
+
+          \return  Number of bytes mapped at addr().
+        */
+        size_t size() const
+            { return m_size; }
+
+        /**
+          Get a description of an error that occurred while mapping.
+
+          \return  Error message.
+        */
+        std::string what() const
+            { return m_error; }
+
+        int m_fd;
+        size_t m_size;
+        void *m_addr;
+        void *m_base;       ///< Page-aligned start of the mapping.
+        size_t m_baseSize;  ///< Size of the mapping from m_base.
+        std::string m_error;
+#ifdef _WIN32
+        void *m_handle;
+#endif
+    };
+
+    /**
+      Map a file into memory for reading.
+
+      \param filename  Name of the file to map.
+      \param pos  Offset in the file of the first byte to map.
+      \param size  Number of bytes to map.  0 maps to the end of the file.
+      \param sequential  Hint to the operating system that the mapping
+        will be read from front to back, so that pages can be read ahead
+        and released aggressively.
+      \return  Mapping context.  addr() is nullptr and what() describes the
+        problem if the file couldn't be mapped.
+    */
+    PDAL_DLL MapContext mapFile(const std::string& filename,
+        uintmax_t pos = 0, uintmax_t size = 0, bool sequential = false);
+
+    /**
+      Unmap a file mapped with mapFile().
+
+      \param ctx  Context returned by mapFile().
+      \return  Context with the mapping released.
+    */
+    PDAL_DLL MapContext unmapFile(MapContext ctx);
 }
 
 } // namespace pdal
@@ -0,0 +1,148 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace pdal
+{
+
+namespace Utils
+{
+
+/**
+  Sort values by 64-bit unsigned keys with a stable LSD radix sort.
+  Passes over bytes that are the same in every key are skipped.  Because
+  the sort is stable, sorting on several keys can be done by sorting on
+  each key in turn, from least to most significant.
+
+  \param keys  Keys to sort.  Sorted on return.
+  \param values  Values associated with the keys.  Must be the same size
+    as \a keys.  Permuted along with the keys.
+  \param numThreads  Number of threads used to count and scatter.
+*/
+template<typename T>
+void radixSort(std::vector<uint64_t>& keys, std::vector<T>& values,
+    std::size_t numThreads = 1)
+{
+    typedef std::array<std::size_t, 256> Counts;
+
+    const std::size_t n = keys.size();
+    if (n < 2)
+        return;
+
+    // Each thread handles a contiguous range, so small inputs aren't
+    // worth splitting.
+    const std::size_t minPerThread = 1 << 16;
+    numThreads = (std::max)((std::size_t)1,
+        (std::min)(numThreads, n / minPerThread));
+    const std::size_t chunk = (n + numThreads - 1) / numThreads;
+
+    uint64_t diff = 0;
+    for (std::size_t i = 1; i < n; ++i)
+        diff |= keys[i] ^ keys[0];
+
+    std::vector<uint64_t> keyTmp(n);
+    std::vector<T> valTmp(n);
+    std::vector<Counts> counts(numThreads);
+    std::unique_ptr<ThreadPool> pool;
+    if (numThreads > 1)
+        pool.reset(new ThreadPool(numThreads));
+
+    auto runAll = [&](const std::function<void(std::size_t)>& f)
+    {
+        if (!pool)
+            f(0);
+        else
+        {
+            for (std::size_t t = 0; t < numThreads; ++t)
+                pool->add([&f, t](){ f(t); });
+            pool->await();
+        }
+    };
+
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        if (((diff >> shift) & 0xFF) == 0)
+            continue;
+
+        runAll([&](std::size_t t)
+        {
+            Counts& c = counts[t];
+            c.fill(0);
+            std::size_t end = (std::min)(n, (t + 1) * chunk);
+            for (std::size_t i = t * chunk; i < end; ++i)
+                c[(keys[i] >> shift) & 0xFF]++;
+        });
+
+        // Convert the counts to starting offsets.  Within a bucket, the
+        // ranges of earlier threads come first, which keeps the sort
+        // stable.
+        std::size_t sum = 0;
+        for (std::size_t b = 0; b < 256; ++b)
+            for (std::size_t t = 0; t < numThreads; ++t)
+            {
+                std::size_t c = counts[t][b];
+                counts[t][b] = sum;
+                sum += c;
+            }
+
+        runAll([&](std::size_t t)
+        {
+            Counts& c = counts[t];
+            std::size_t end = (std::min)(n, (t + 1) * chunk);
+            for (std::size_t i = t * chunk; i < end; ++i)
+            {
+                std::size_t pos = c[(keys[i] >> shift) & 0xFF]++;
+                keyTmp[pos] = keys[i];
+                valTmp[pos] = values[i];
+            }
+        });
+        keys.swap(keyTmp);
+        values.swap(valTmp);
+    }
+}
+
+} // namespace Utils
+
+} // namespace pdal
@@ -0,0 +1,149 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+
+/**
+  A fixed-size pool of worker threads that run queued tasks.
+
+  Tasks are run in the order that they're added, but may complete in any
+  order.  If a task throws, the first exception is saved and rethrown from
+  \ref await() or \ref join() on the thread that owns the pool.
+*/
+class PDAL_DLL ThreadPool
+{
+public:
+    /**
+      Create a thread pool.
+
+      \param numThreads  Number of worker threads.  A value of zero is
+        treated as one.
+    */
+    ThreadPool(std::size_t numThreads);
+    ~ThreadPool();
+
+    /**
+      Queue a task to be run by a worker thread.
+
+      \param task  Task to run.
+    */
+    void add(const std::function<void()>& task);
+
+    /**
+      Block until all queued tasks have completed.  Rethrows the first
+      exception raised by a task, if any.
+    */
+    void await();
+
+    /**
+      Wait for all queued tasks to complete and stop the worker threads.
+      No tasks may be added after the pool is joined.  Rethrows the first
+      exception raised by a task, if any.
+    */
+    void join();
+
+    /**
+      Return the number of worker threads.
+
+      \return  Number of worker threads.
+    */
+    std::size_t numThreads() const
+        { return m_threads.size(); }
+
+    /**
+      Return a sensible default number of threads for the machine.
+
+      \return  Number of hardware threads, or one if unknown.
+    */
+    static std::size_t hardwareThreads();
+
+    /**
+      Return the number of threads worth using to process items split into
+      contiguous ranges.
+
+      \param n  Number of items.
+      \param maxThreads  Maximum number of threads.
+      \param minPerThread  Minimum number of items handled by a thread.
+      \return  Number of threads, at least one.
+    */
+    static std::size_t threadsFor(std::size_t n, std::size_t maxThreads,
+        std::size_t minPerThread);
+
+    /**
+      Split the items [0, n) into contiguous ranges of equal size, one per
+      thread, and call a function for each range.  With one thread the
+      function is called with the whole range on the calling thread.
+      Rethrows the first exception raised by the function, if any.
+
+      \param n  Number of items.
+      \param numThreads  Number of threads (see \ref threadsFor()).
+      \param f  Function called with the index of the range, less than
+        \a numThreads, and the first and one-past-last items of the range.
+    */
+    static void parallelFor(std::size_t n, std::size_t numThreads,
+        const std::function<void(std::size_t, std::size_t, std::size_t)>& f);
+
+private:
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::size_t m_outstanding;
+    bool m_running;
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_produceCv;
+    std::condition_variable m_consumeCv;
+
+    void work();
+    void rethrow();
+
+    ThreadPool& operator=(const ThreadPool&); // not implemented
+    ThreadPool(const ThreadPool&); // not implemented
+};
+
+} // namespace pdal
+
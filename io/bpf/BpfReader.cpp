@@ -56,10 +56,11 @@ CREATE_STATIC_PLUGIN(1, 0, BpfReader, Reader, s_info)
 
 std::string BpfReader::getName() const { return s_info.name; }
 
-void BpfReader::processOptions(const Options&)
+void BpfReader::processOptions(const Options& options)
 {
     if (m_filename.empty())
         throw pdal_error("Can't read BPF file without filename.");
+    m_useMmap = options.getValueOrDefault<bool>("mmap", false);
 
     // Logfile doesn't get set until options are processed.
     m_header.setLog(log());
@@ -231,6 +232,9 @@ void BpfReader::ready(PointTableRef)
     m_stream.seek(m_header.m_len);
     m_index = 0;
     m_start = m_stream.position();
+    m_data = nullptr;
+    // Release a mapping left by a run that didn't finish.
+    m_map = FileUtils::unmapFile(m_map);
     if (m_header.m_compression)
     {
         m_deflateBuf.resize(numPoints() * m_dims.size() * sizeof(float));
@@ -241,16 +245,28 @@ void BpfReader::ready(PointTableRef)
             bytesRead = readBlock(m_deflateBuf, index);
             index += bytesRead;
         } while (bytesRead > 0 && index < m_deflateBuf.size());
-        m_charbuf.initialize(m_deflateBuf.data(), m_deflateBuf.size(), m_start);
-        m_stream.pushStream(new std::istream(&m_charbuf));
+        m_data = m_deflateBuf.data();
+    }
+    else if (m_useMmap && numPoints())
+    {
+        size_t size = numPoints() * m_dims.size() * sizeof(float);
+        m_map = FileUtils::mapFile(m_filename, m_start, size,
+            m_header.m_pointFormat == BpfFormat::PointMajor);
+        if (m_map.addr())
+            m_data = (const char *)m_map.addr();
+        else
+            log()->get(LogLevel::Warning) << getName() << ": unable to "
+                "map file, falling back to stream input: " <<
+                m_map.what() << std::endl;
     }
 }
 
 
 void BpfReader::done(PointTableRef)
 {
-     delete m_stream.popStream();
-     m_stream.close();
+    m_map = FileUtils::unmapFile(m_map);
+    m_data = nullptr;
+    m_stream.close();
 }
 
 
@@ -315,12 +331,10 @@ void BpfReader::readPointMajor(PointRef& point)
 {
     double x(0), y(0), z(0);
 
-    seekPointMajor(m_index);
+    const char *pos = seekPointMajor(m_index);
     for (size_t dim = 0; dim < m_dims.size(); ++dim)
     {
-        float f;
-
-        m_stream >> f;
+        float f = extractFloat(pos);
         double d = f + m_dims[dim].m_offset;
         if (m_dims[dim].m_id == Dimension::Id::X)
             x = d;
@@ -345,14 +359,12 @@ point_count_t BpfReader::readPointMajor(PointViewPtr view, point_count_t count)
     PointId nextId = view->size();
     PointId idx = m_index;
     point_count_t numRead = 0;
-    seekPointMajor(idx);
+    const char *pos = seekPointMajor(idx);
     while (numRead < count && idx < numPoints())
     {
         for (size_t d = 0; d < m_dims.size(); ++d)
         {
-            float f;
-
-            m_stream >> f;
+            float f = extractFloat(pos);
             view->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
         }
 
@@ -383,10 +395,8 @@ void BpfReader::readDimMajor(PointRef& point)
 
     for (size_t dim = 0; dim < m_dims.size(); ++dim)
     {
-        seekDimMajor(dim, m_index);
-
-        float f;
-        m_stream >> f;
+        const char *pos = seekDimMajor(dim, m_index);
+        float f = extractFloat(pos);
         double d = f + m_dims[dim].m_offset;
         if (m_dims[dim].m_id == Dimension::Id::X)
             x = d;
@@ -417,12 +427,10 @@ point_count_t BpfReader::readDimMajor(PointViewPtr data, point_count_t count)
         idx = m_index;
         PointId nextId = startId;
         numRead = 0;
-        seekDimMajor(d, idx);
+        const char *pos = seekDimMajor(d, idx);
         for (; numRead < count && idx < numPoints(); idx++, numRead++, nextId++)
         {
-            float f;
-
-            m_stream >> f;
+            float f = extractFloat(pos);
             data->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
         }
     }
@@ -463,9 +471,8 @@ void BpfReader::readByteMajor(PointRef& point)
         u.u32 = 0;
         for (size_t b = 0; b < sizeof(float); ++b)
         {
-            seekByteMajor(dim, b, m_index);
-
-            m_stream >> u8;
+            const char *pos = seekByteMajor(dim, b, m_index);
+            u8 = extractByte(pos);
             u.u32 |= ((uint32_t)u8 << (b * CHAR_BIT));
         }
         double d = u.f + m_dims[dim].m_offset;
@@ -509,7 +516,7 @@ point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
             idx = m_index;
             numRead = 0;
             PointId nextId = startId;
-            seekByteMajor(d, b, idx);
+            const char *pos = seekByteMajor(d, b, idx);
 
             for (;numRead < count && idx < numPoints();
                 idx++, numRead++, nextId++)
@@ -518,8 +525,7 @@ point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
 
                 if (b == 0)
                     u.u32 = 0;
-                uint8_t u8;
-                m_stream >> u8;
+                uint8_t u8 = extractByte(pos);
                 u.u32 |= ((uint32_t)u8 << (b * CHAR_BIT));
                 if (b == 3)
                 {
@@ -550,28 +556,75 @@ point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
 }
 
 
-void BpfReader::seekPointMajor(PointId ptIdx)
+// Position the input at an offset from the start of the point records.
+// Returns the location of the data if the records are in memory,
+// otherwise seeks the stream and returns nullptr.
+const char *BpfReader::seek(std::streamoff offset)
 {
-    std::streamoff offset = ptIdx * sizeof(float) * m_dims.size();
+    if (m_data)
+        return m_data + offset;
     m_stream.seek(m_start + offset);
+    return nullptr;
+}
+
+
+const char *BpfReader::seekPointMajor(PointId ptIdx)
+{
+    std::streamoff offset = ptIdx * sizeof(float) * m_dims.size();
+    return seek(offset);
 }
 
 
-void BpfReader::seekDimMajor(size_t dimIdx, PointId ptIdx)
+const char *BpfReader::seekDimMajor(size_t dimIdx, PointId ptIdx)
 {
     std::streamoff offset = ((sizeof(float) * dimIdx * numPoints()) +
         (sizeof(float) * ptIdx));
-    m_stream.seek(m_start + offset);
+    return seek(offset);
 }
 
 
-void BpfReader::seekByteMajor(size_t dimIdx, size_t byteIdx, PointId ptIdx)
+const char *BpfReader::seekByteMajor(size_t dimIdx, size_t byteIdx,
+    PointId ptIdx)
 {
     std::streamoff offset =
         (dimIdx * numPoints() * sizeof(float)) +
         (byteIdx * numPoints()) +
         ptIdx;
-    m_stream.seek(m_start + offset);
+    return seek(offset);
+}
+
+
+// Read a float from memory at 'pos' and advance it, or from the stream
+// if 'pos' is null.
+float BpfReader::extractFloat(const char *& pos)
+{
+    float f;
+
+    if (pos)
+    {
+        uint32_t u;
+        memcpy(&u, pos, sizeof(u));
+        u = le32toh(u);
+        memcpy(&f, &u, sizeof(f));
+        pos += sizeof(f);
+    }
+    else
+        m_stream >> f;
+    return f;
+}
+
+
+// Read a byte from memory at 'pos' and advance it, or from the stream
+// if 'pos' is null.
+uint8_t BpfReader::extractByte(const char *& pos)
+{
+    uint8_t u8;
+
+    if (pos)
+        u8 = (uint8_t)*pos++;
+    else
+        m_stream >> u8;
+    return u8;
 }
 
 
@@ -40,7 +40,7 @@
 #include <vector>
 
 #include <pdal/Reader.hpp>
-#include <pdal/util/Charbuf.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <pdal/util/IStream.hpp>
 #include <pdal/pdal_export.hpp>
 #include <pdal/plugin.hpp>
@@ -58,6 +58,13 @@ namespace pdal
 class PDAL_DLL BpfReader : public Reader
 {
 public:
+    BpfReader() : m_useMmap(false), m_data(nullptr)
+        {}
+    // The mapping is normally released in done(), which isn't called if
+    // reading fails.
+    ~BpfReader()
+        { FileUtils::unmapFile(m_map); }
+
     static void * create();
     static int32_t destroy(void *);
     std::string getName() const;
@@ -79,14 +86,21 @@ private:
     point_count_t m_index;
     /// Buffer for deflated data.
     std::vector<char> m_deflateBuf;
-    /// Streambuf for deflated data.
-    Charbuf m_charbuf;
+    /// Whether to map uncompressed files into memory.
+    bool m_useMmap;
+    /// Mapping of the point records of an uncompressed file.
+    FileUtils::MapContext m_map;
+    /// Point records in memory (mapped or deflated), or nullptr if they
+    /// must be read from the stream.
+    const char *m_data;
 
     virtual void processOptions(const Options& options);
     virtual QuickInfo inspect();
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr Layout);
     virtual void ready(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
     virtual point_count_t read(PointViewPtr data, point_count_t num);
     virtual void done(PointTableRef table);
@@ -107,9 +121,12 @@ private:
 
     int inflate(char *inbuf, uint32_t insize, char *outbuf, uint32_t outsize);
 
-    void seekPointMajor(PointId ptIdx);
-    void seekDimMajor(size_t dimIdx, PointId ptIdx);
-    void seekByteMajor(size_t dimIdx, size_t byteIdx, PointId ptIdx);
+    const char *seekPointMajor(PointId ptIdx);
+    const char *seekDimMajor(size_t dimIdx, PointId ptIdx);
+    const char *seekByteMajor(size_t dimIdx, size_t byteIdx, PointId ptIdx);
+    const char *seek(std::streamoff offset);
+    float extractFloat(const char *& pos);
+    uint8_t extractByte(const char *& pos);
 };
 
 } // namespace pdal
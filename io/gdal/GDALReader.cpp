@@ -34,8 +34,10 @@
 
 #include "GDALReader.hpp"
 
-#include <sstream>
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
 
 
 #include <pdal/PointView.hpp>
@@ -60,19 +62,37 @@ std::string GDALReader::getName() const
 }
 
 
-GDALReader::GDALReader()
-    : m_index(0)
+GDALReader::GDALReader() : m_colBegin(0), m_colEnd(0), m_rowBegin(0),
+    m_rowEnd(0), m_blockWidth(0), m_blockHeight(0), m_nextCol(0),
+    m_nextRow(0), m_winCol(0), m_winRow(0), m_winWidth(0), m_winHeight(0),
+    m_col(0), m_row(0)
 {}
 
 
+Options GDALReader::getDefaultOptions()
+{
+    Options options;
+    options.add("filename", "", "Raster file to read");
+    options.add("bounds", BOX2D(), "Only read pixels whose centers lie "
+        "within these bounds");
+    return options;
+}
+
+
+void GDALReader::processOptions(const Options& options)
+{
+    m_bounds = options.getValueOrDefault<BOX2D>("bounds");
+}
+
+
 void GDALReader::initialize()
 {
     GlobalEnvironment::get().initializeGDAL(log());
     m_raster.reset(new gdal::Raster(m_filename));
 
-    m_raster->open();
+    if (m_raster->open() == gdal::GDALError::CantOpen)
+        throw pdal_error(m_raster->errorMsg());
     setSpatialReference(m_raster->getSpatialRef());
-    m_count = m_raster->m_raster_x_size * m_raster->m_raster_y_size;
     m_raster->close();
 }
 
@@ -101,63 +121,168 @@ void GDALReader::addDimensions(PointLayoutPtr layout)
 {
     layout->registerDim(pdal::Dimension::Id::X);
     layout->registerDim(pdal::Dimension::Id::Y);
+    m_bands.clear();
+    m_bandIds.clear();
     for (int i = 0; i < m_raster->m_band_count; ++i)
     {
         std::ostringstream oss;
         oss << "band-" << (i + 1);
-        layout->registerOrAssignDim(oss.str(), Dimension::Type::Double);
+        m_bands.push_back(i + 1);
+        m_bandIds.push_back(
+            layout->registerOrAssignDim(oss.str(), Dimension::Type::Double));
     }
 }
 
 
 void GDALReader::ready(PointTableRef table)
 {
-    m_index = 0;
-    m_raster->open();
+    if (m_raster->open() == gdal::GDALError::CantOpen)
+        throw pdal_error(m_raster->errorMsg());
+
+    m_raster->getBlockSize(m_blockWidth, m_blockHeight);
+    m_blockWidth = (std::max)(m_blockWidth, 1);
+    m_blockHeight = (std::max)(m_blockHeight, 1);
+
+    // Rasters stored in strips often have blocks of a single row.  Read
+    // several strips at a time to keep the number of reads down.  This
+    // doesn't change the order of the points.
+    if (m_blockWidth >= m_raster->m_raster_x_size)
+        m_blockHeight *= (63 + m_blockHeight) / m_blockHeight;
+
+    computeWindow();
+    m_nextCol = (m_colBegin / m_blockWidth) * m_blockWidth;
+    m_nextRow = (m_rowBegin / m_blockHeight) * m_blockHeight;
+    m_winWidth = 0;
+    m_winHeight = 0;
+    m_col = 0;
+    m_row = 0;
 }
 
 
-point_count_t GDALReader::read(PointViewPtr view, point_count_t num)
+// Find the window of pixels that may lie within the bounds.  Pixel centers
+// are tested against the bounds as points are read.
+void GDALReader::computeWindow()
 {
-    point_count_t count = std::min(num, m_count - m_index);
-    PointId nextId = view->size();
+    m_colBegin = 0;
+    m_rowBegin = 0;
+    m_colEnd = m_raster->m_raster_x_size;
+    m_rowEnd = m_raster->m_raster_y_size;
+    if (m_bounds.empty())
+        return;
+
+    const double xs[] = { m_bounds.minx, m_bounds.maxx };
+    const double ys[] = { m_bounds.miny, m_bounds.maxy };
+    double colMin = (std::numeric_limits<double>::max)();
+    double colMax = std::numeric_limits<double>::lowest();
+    double rowMin = (std::numeric_limits<double>::max)();
+    double rowMax = std::numeric_limits<double>::lowest();
+    for (double x : xs)
+        for (double y : ys)
+        {
+            double col, row;
 
+            m_raster->getPixelPosition(x, y, col, row);
+            colMin = (std::min)(colMin, col);
+            colMax = (std::max)(colMax, col);
+            rowMin = (std::min)(rowMin, row);
+            rowMax = (std::max)(rowMax, row);
+        }
+
+    auto clamp = [](double v, int limit)
+    {
+        return (int)(std::min)((std::max)(v, 0.0), (double)limit);
+    };
+    m_colBegin = clamp(std::floor(colMin), m_colEnd);
+    m_colEnd = clamp(std::ceil(colMax) + 1, m_colEnd);
+    m_rowBegin = clamp(std::floor(rowMin), m_rowEnd);
+    m_rowEnd = clamp(std::ceil(rowMax) + 1, m_rowEnd);
+}
+
+
+// Read the next block of the raster that overlaps the window.
+bool GDALReader::nextBlock()
+{
+    if (m_colBegin >= m_colEnd || m_nextRow >= m_rowEnd)
+        return false;
+
+    m_winCol = (std::max)(m_nextCol, m_colBegin);
+    m_winRow = (std::max)(m_nextRow, m_rowBegin);
+    m_winWidth = (std::min)(m_nextCol + m_blockWidth, m_colEnd) - m_winCol;
+    m_winHeight = (std::min)(m_nextRow + m_blockHeight, m_rowEnd) - m_winRow;
+    m_col = 0;
+    m_row = 0;
+
+    m_nextCol += m_blockWidth;
+    if (m_nextCol >= m_colEnd)
+    {
+        m_nextCol = (m_colBegin / m_blockWidth) * m_blockWidth;
+        m_nextRow += m_blockHeight;
+    }
+
+    if (m_raster->readWindow(m_winCol, m_winRow, m_winWidth, m_winHeight,
+        m_bands, m_data) != gdal::GDALError::None)
+        throw pdal_error(m_raster->errorMsg());
+    return true;
+}
+
+
+bool GDALReader::processOne(PointRef& point)
+{
     std::array<double, 2> coords;
-    for (int row = 0; row < m_raster->m_raster_y_size; ++row)
+
+    while (true)
     {
-        for (int col = 0; col < m_raster->m_raster_x_size; ++col)
+        if (m_row >= m_winHeight && !nextBlock())
+            return false;
+
+        int col = m_winCol + m_col;
+        int row = m_winRow + m_row;
+        size_t offset = (size_t)m_row * m_winWidth + m_col;
+        if (++m_col == m_winWidth)
         {
-            m_raster->pixelToCoord(col, row, coords);
-            view->setField(Dimension::Id::X, nextId, coords[0]);
-            view->setField(Dimension::Id::Y, nextId, coords[1]);
-            nextId++;
+            m_col = 0;
+            m_row++;
         }
+
+        m_raster->pixelToCoord(col, row, coords);
+        if (!m_bounds.empty() && !m_bounds.contains(coords[0], coords[1]))
+            continue;
+
+        point.setField(Dimension::Id::X, coords[0]);
+        point.setField(Dimension::Id::Y, coords[1]);
+
+        // The window holds each band in turn.
+        size_t bandSize = (size_t)m_winWidth * m_winHeight;
+        for (size_t b = 0; b < m_bandIds.size(); ++b)
+            point.setField(m_bandIds[b], m_data[b * bandSize + offset]);
+        return true;
     }
+}
 
-    std::vector<uint8_t> band;
-    std::vector<Dimension::Type::Enum> band_types =
-        m_raster->getPDALDimensionTypes();
 
-    for (int b = 0; b < m_raster->m_band_count; ++b)
+point_count_t GDALReader::read(PointViewPtr view, point_count_t num)
+{
+    point_count_t count = 0;
+
+    PointId idx = view->size();
+    PointRef point = view->point(idx);
+    while (count < num)
     {
-        // Bands count from 1
-        m_raster->readBand(band, b + 1);
-        std::stringstream oss;
-        oss << "band-" << (b + 1);
-        log()->get(LogLevel::Info) << "Read band '" << oss.str() << "'" <<
-            std::endl;
-
-        Dimension::Id::Enum d = view->layout()->findDim(oss.str());
-        size_t dimSize = Dimension::size(band_types[b]);
-        uint8_t* p = band.data();
-        for (point_count_t i = 0; i < count; ++i)
-        {
-            view->setField(d, band_types[b], i, p);
-            p = p + dimSize;
-        }
+        point.setPointId(idx);
+        if (!processOne(point))
+            break;
+        idx++;
+        count++;
     }
+    return count;
+}
+
 
-    return view->size();
+void GDALReader::done(PointTableRef table)
+{
+    m_raster->close();
+    m_data.clear();
+    m_data.shrink_to_fit();
 }
 
 } // namespace pdal
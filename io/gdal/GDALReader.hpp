@@ -65,19 +65,48 @@ public:
     GDALReader();
 
     static Dimension::IdList getDefaultDimensions();
+    Options getDefaultOptions();
 
 private:
     virtual void initialize();
+    virtual void processOptions(const Options& options);
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t num);
-    virtual void done(PointTableRef table)
-        { m_raster->close(); }
+    virtual bool streamable() const
+        { return true; }
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
     virtual QuickInfo inspect();
 
-    std::unique_ptr<gdal::Raster> m_raster;
-    point_count_t m_index;
+    void computeWindow();
+    bool nextBlock();
 
+    std::unique_ptr<gdal::Raster> m_raster;
+    BOX2D m_bounds;
+    std::vector<int> m_bands;
+    std::vector<Dimension::Id::Enum> m_bandIds;
+
+    // Pixels [m_colBegin, m_colEnd) x [m_rowBegin, m_rowEnd) may lie
+    // within the bounds.
+    int m_colBegin;
+    int m_colEnd;
+    int m_rowBegin;
+    int m_rowEnd;
+    int m_blockWidth;
+    int m_blockHeight;
+    // Origin of the next block to read.
+    int m_nextCol;
+    int m_nextRow;
+    // Window of the raster held in m_data and the position of the next
+    // pixel within it.
+    int m_winCol;
+    int m_winRow;
+    int m_winWidth;
+    int m_winHeight;
+    int m_col;
+    int m_row;
+    std::vector<double> m_data;
 };
 }
 
@@ -33,6 +33,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <vector>
 
 #include <pdal/util/Algorithm.hpp>
@@ -52,9 +53,14 @@ public:
 
     void setLog(LogPtr log) { m_log = log; }
 
+    // Warnings may be issued from multiple threads when points are
+    // decoded in parallel.
     void returnNumWarning(int returnNum)
     {
         static std::vector<int> warned;
+        static std::mutex mutex;
+
+        std::lock_guard<std::mutex> lock(mutex);
 
         if (!Utils::contains(warned, returnNum))
         {
@@ -68,6 +74,9 @@ public:
     void numReturnsWarning(int numReturns)
     {
         static std::vector<int> warned;
+        static std::mutex mutex;
+
+        std::lock_guard<std::mutex> lock(mutex);
 
         if (!Utils::contains(warned, numReturns))
         {
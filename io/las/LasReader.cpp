@@ -34,6 +34,8 @@
 
 #include "LasReader.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 #include <string.h>
 
@@ -44,6 +46,7 @@
 #include <pdal/util/Extractor.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/IStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/pdal_macros.hpp>
 
 #ifdef PDAL_HAVE_LIBGEOTIFF
@@ -93,6 +96,65 @@ void LasReader::processOptions(const Options& options)
     // Set case-corrected value.
     m_compression = compression;
 
+    m_useMmap = options.getValueOrDefault<bool>("mmap", false);
+
+    m_bounds.clear();
+    try
+    {
+        std::vector<BOX2D> b2d = options.getValues<BOX2D>("bounds");
+        for (auto& b : b2d)
+            m_bounds.push_back(BOX3D(b.minx, b.miny,
+                std::numeric_limits<double>::lowest(), b.maxx, b.maxy,
+                (std::numeric_limits<double>::max)()));
+    }
+    catch (Option::cant_convert)
+    {
+        try
+        {
+            m_bounds = options.getValues<BOX3D>("bounds");
+        }
+        catch (Option::cant_convert)
+        {
+            std::ostringstream oss;
+            oss << getName() << ": Invalid bounds provided as option.  "
+                "Format: '([xmin,xmax],[ymin,ymax])'.";
+            throw pdal_error(oss.str());
+        }
+    }
+
+    try
+    {
+        m_polys = options.getValues<Polygon>("polygon");
+    }
+    catch (Option::cant_convert)
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Invalid polygon specification as option.  "
+            "Must be valid GeoJSON/WTK";
+        throw pdal_error(oss.str());
+    }
+    m_polyBounds.clear();
+    for (Polygon& poly : m_polys)
+    {
+        // Throws if invalid.
+        poly.valid();
+        m_polyBounds.push_back(poly.bounds());
+    }
+
+    m_ranges.clear();
+    StringList limits = options.getValueOrDefault<StringList>("limits");
+    try
+    {
+        for (auto& r : limits)
+            m_ranges.push_back(DimRange::parse(r));
+    }
+    catch (pdal_error& err)
+    {
+        std::ostringstream oss;
+        oss << getName() << ": invalid 'limits' option: " << err.what();
+        throw pdal_error(oss.str());
+    }
+
     m_error.setFilename(m_filename);
 }
 
@@ -174,9 +236,33 @@ void LasReader::initializeLocal(PointTableRef table, MetadataNode& m)
 
 void LasReader::ready(PointTableRef table)
 {
+    using namespace Dimension;
+
     createStream();
     std::istream *stream(m_streamIf->m_istream);
 
+    const PointLayout& layout(*table.layout());
+    m_acc.x = DimAccessor<double>(layout, Id::X);
+    m_acc.y = DimAccessor<double>(layout, Id::Y);
+    m_acc.z = DimAccessor<double>(layout, Id::Z);
+    m_acc.intensity = DimAccessor<uint16_t>(layout, Id::Intensity);
+    m_acc.returnNum = DimAccessor<uint8_t>(layout, Id::ReturnNumber);
+    m_acc.numReturns = DimAccessor<uint8_t>(layout, Id::NumberOfReturns);
+    m_acc.classFlags = DimAccessor<uint8_t>(layout, Id::ClassFlags);
+    m_acc.scanChannel = DimAccessor<uint8_t>(layout, Id::ScanChannel);
+    m_acc.scanDirFlag = DimAccessor<uint8_t>(layout, Id::ScanDirectionFlag);
+    m_acc.flight = DimAccessor<uint8_t>(layout, Id::EdgeOfFlightLine);
+    m_acc.classification = DimAccessor<uint8_t>(layout, Id::Classification);
+    m_acc.scanAngle = DimAccessor<double>(layout, Id::ScanAngleRank);
+    m_acc.user = DimAccessor<uint8_t>(layout, Id::UserData);
+    m_acc.pointSourceId = DimAccessor<uint16_t>(layout, Id::PointSourceId);
+    m_acc.gpsTime = DimAccessor<double>(layout, Id::GpsTime);
+    m_acc.red = DimAccessor<uint16_t>(layout, Id::Red);
+    m_acc.green = DimAccessor<uint16_t>(layout, Id::Green);
+    m_acc.blue = DimAccessor<uint16_t>(layout, Id::Blue);
+    m_acc.infrared = DimAccessor<uint16_t>(layout, Id::Infrared);
+    selectLoaders();
+
     m_index = 0;
     if (m_header.compressed())
     {
@@ -225,7 +311,70 @@ void LasReader::ready(PointTableRef table)
 #endif
     }
     else
+    {
         stream->seekg(m_header.pointOffset());
+        // Release a mapping left by a run that didn't finish.
+        m_map = FileUtils::unmapFile(m_map);
+        m_mapPoints = 0;
+        if (m_useMmap && getNumPoints())
+        {
+            // Points are read front to back, so ask for read-ahead.
+            m_map = FileUtils::mapFile(m_filename, m_header.pointOffset(),
+                0, true);
+            if (m_map.addr())
+                m_mapPoints = m_map.size() / m_header.pointLen();
+            else
+                log()->get(LogLevel::Warning) << getName() << ": unable to "
+                    "map file, falling back to stream input: " <<
+                    m_map.what() << std::endl;
+        }
+    }
+    readyFilter(layout);
+}
+
+
+// Resolve the point predicates and, for spatial predicates, look up the
+// ranges of points that need to be read in the file's LAX index, if any.
+void LasReader::readyFilter(const PointLayout& layout)
+{
+    m_filtered = m_bounds.size() || m_polys.size() || m_ranges.size();
+    m_intervals.clear();
+    m_curInterval = 0;
+    m_chunkOffsets.clear();
+    if (!m_filtered)
+        return;
+
+    for (auto& r : m_ranges)
+    {
+        r.m_id = layout.findDim(r.m_name);
+        if (!rawDimSupported(r.m_id))
+        {
+            std::ostringstream oss;
+            oss << getName() << ": invalid 'limits' option: dimension '" <<
+                r.m_name << "' isn't a standard dimension of point format " <<
+                (int)m_header.pointFormat() << ".";
+            throw pdal_error(oss.str());
+        }
+    }
+    std::sort(m_ranges.begin(), m_ranges.end());
+
+    LaxIndex index;
+    if ((m_bounds.size() || m_polys.size()) && index.open(m_filename))
+    {
+        std::vector<BOX3D> boxes(m_bounds);
+        boxes.insert(boxes.end(), m_polyBounds.begin(), m_polyBounds.end());
+        for (auto& b : boxes)
+        {
+            std::vector<LaxIndex::Interval> intervals = index.query(b.to2d());
+            m_intervals.insert(m_intervals.end(), intervals.begin(),
+                intervals.end());
+        }
+        std::sort(m_intervals.begin(), m_intervals.end());
+        log()->get(LogLevel::Debug) << getName() << ": using LAX index, " <<
+            m_intervals.size() << " point ranges to scan." << std::endl;
+    }
+    else
+        m_intervals.push_back(LaxIndex::Interval(0, getNumPoints()));
 }
 
 
@@ -483,12 +632,12 @@ void LasReader::addDimensions(PointLayoutPtr layout)
 }
 
 
-bool LasReader::processOne(PointRef& point)
+// Read the next point record from the file.  Returns a pointer to the
+// raw record.
+char *LasReader::readRawPoint()
 {
-    if (m_index >= getNumPoints())
-        return false;
-
     size_t pointLen = m_header.pointLen();
+    char *buf = nullptr;
 
     if (m_header.compressed())
     {
@@ -504,8 +653,7 @@ bool LasReader::processOne(PointRef& point)
                 error += err;
                 throw pdal_error(error);
             }
-            loadPoint(point, (char *)m_zipPoint->m_lz_point_data.data(),
-                pointLen);
+            buf = (char *)m_zipPoint->m_lz_point_data.data();
         }
 #endif
 
@@ -513,7 +661,7 @@ bool LasReader::processOne(PointRef& point)
         if (m_compression == "LAZPERF")
         {
             m_decompressor->decompress(m_decompressorBuf.data());
-            loadPoint(point, m_decompressorBuf.data(), pointLen);
+            buf = m_decompressorBuf.data();
         }
 #endif
 #if !defined(PDAL_HAVE_LAZPERF) && !defined(PDAL_HAVE_LASZIP)
@@ -521,14 +669,272 @@ bool LasReader::processOne(PointRef& point)
             "LAZperf decompression library.");
 #endif
     } // compression
+    else if (m_map.addr())
+    {
+        if (m_index >= m_mapPoints)
+            throw pdal_error("Unexpected end of point data in '" +
+                m_filename + "'.");
+        buf = (char *)m_map.addr() + m_index * pointLen;
+    }
     else
     {
-        std::vector<char> buf(m_header.pointLen());
-
-        m_streamIf->m_istream->read(buf.data(), pointLen);
-        loadPoint(point, buf.data(), pointLen);
+        m_rawBuf.resize(pointLen);
+        m_streamIf->m_istream->read(m_rawBuf.data(), pointLen);
+        buf = m_rawBuf.data();
     }
     m_index++;
+    return buf;
+}
+
+
+// Position the input so that the next point read is point 'idx'.
+void LasReader::seekPoint(point_count_t idx)
+{
+    if (idx == m_index)
+        return;
+
+    if (m_header.compressed())
+    {
+#ifdef PDAL_HAVE_LASZIP
+        if (m_compression == "LASZIP")
+        {
+            if (!m_unzipper->seek((unsigned)idx))
+            {
+                std::string error = "Error seeking in compressed point data: ";
+                const char* err = m_unzipper->get_error();
+                if (!err)
+                    err = "(unknown error)";
+                error += err;
+                throw pdal_error(error);
+            }
+            m_index = idx;
+        }
+#endif
+
+#ifdef PDAL_HAVE_LAZPERF
+        if (m_compression == "LAZPERF")
+        {
+            // Restart the decompressor at the chunk holding the point if
+            // we can, otherwise decompress forward to it.
+            uint32_t chunk = chunkSize();
+            if (chunk && m_chunkOffsets.empty())
+            {
+                std::unique_ptr<LasStreamIf> streamIf(openStream());
+                if (streamIf->m_istream)
+                    m_chunkOffsets = LazPerfVlrDecompressor::chunkOffsets(
+                        *streamIf->m_istream, m_header.pointOffset());
+            }
+            point_count_t chunkNum = chunk ? idx / chunk : 0;
+            if (chunkNum < m_chunkOffsets.size() &&
+                (idx < m_index || chunkNum > m_index / chunk))
+            {
+                VariableLengthRecord *vlr = m_header.findVlr(LASZIP_USER_ID,
+                    LASZIP_RECORD_ID);
+                m_decompressor.reset(new LazPerfVlrDecompressor(
+                    *m_streamIf->m_istream, vlr->data(),
+                    m_header.pointOffset(), m_chunkOffsets[chunkNum]));
+                m_index = chunkNum * chunk;
+            }
+            else if (idx < m_index)
+                throw pdal_error("Can't seek backward in LAZperf data "
+                    "without a chunk table.");
+            while (m_index < idx)
+                readRawPoint();
+        }
+#endif
+    }
+    else
+    {
+        if (!m_map.addr())
+            m_streamIf->m_istream->seekg(m_header.pointOffset() +
+                (std::streamoff)(idx * m_header.pointLen()));
+        m_index = idx;
+    }
+}
+
+
+// Read points until one passes the point predicates.  Returns the raw
+// record of the point, or nullptr if no more points pass.
+char *LasReader::nextPassingPoint()
+{
+    while (m_curInterval < m_intervals.size())
+    {
+        const LaxIndex::Interval& interval = m_intervals[m_curInterval];
+        point_count_t end = std::min(interval.second, getNumPoints());
+        if (m_index < interval.first)
+            seekPoint(interval.first);
+        if (m_index >= end)
+        {
+            m_curInterval++;
+            continue;
+        }
+        char *buf = readRawPoint();
+        if (passesFilter(buf))
+            return buf;
+    }
+    m_index = getNumPoints();
+    return nullptr;
+}
+
+
+bool LasReader::passesFilter(const char *buf) const
+{
+    using namespace Dimension;
+
+    if (m_bounds.size() || m_polys.size())
+    {
+        double x = rawValue(buf, Id::X);
+        double y = rawValue(buf, Id::Y);
+        double z = rawValue(buf, Id::Z);
+
+        bool inside = false;
+        for (auto& b : m_bounds)
+            if (b.contains(x, y, z))
+            {
+                inside = true;
+                break;
+            }
+        for (size_t i = 0; !inside && i < m_polys.size(); ++i)
+            inside = m_polyBounds[i].to2d().contains(x, y) &&
+                m_polys[i].covers(x, y, z);
+        if (!inside)
+            return false;
+    }
+    if (m_ranges.size())
+        return DimRange::pointPasses(m_ranges,
+            [this, buf](Dimension::Id::Enum id)
+            { return rawValue(buf, id); });
+    return true;
+}
+
+
+bool LasReader::rawDimSupported(Dimension::Id::Enum id) const
+{
+    using namespace Dimension;
+
+    switch (id)
+    {
+    case Id::X:
+    case Id::Y:
+    case Id::Z:
+    case Id::Intensity:
+    case Id::ReturnNumber:
+    case Id::NumberOfReturns:
+    case Id::ScanDirectionFlag:
+    case Id::EdgeOfFlightLine:
+    case Id::Classification:
+    case Id::ScanAngleRank:
+    case Id::UserData:
+    case Id::PointSourceId:
+        return true;
+    case Id::ClassFlags:
+    case Id::ScanChannel:
+        return m_header.has14Format();
+    case Id::GpsTime:
+        return m_header.hasTime();
+    case Id::Red:
+    case Id::Green:
+    case Id::Blue:
+        return m_header.hasColor();
+    case Id::Infrared:
+        return m_header.hasInfrared();
+    default:
+        return false;
+    }
+}
+
+
+namespace
+{
+
+template<typename T>
+T rawField(const char *buf, size_t offset)
+{
+    T t;
+    LeExtractor in(buf + offset, sizeof(T));
+    in >> t;
+    return t;
+}
+
+} // unnamed namespace
+
+
+// Get the value of a dimension from a raw point record without decoding
+// the whole record.  The dimension must be one for which rawDimSupported()
+// is true.
+double LasReader::rawValue(const char *buf, Dimension::Id::Enum id) const
+{
+    using namespace Dimension;
+
+    const bool v14 = m_header.has14Format();
+    const size_t colorOffset = v14 ? 30 : (m_header.hasTime() ? 28 : 20);
+
+    switch (id)
+    {
+    case Id::X:
+        return m_header.scaleX() * rawField<int32_t>(buf, 0) +
+            m_header.offsetX();
+    case Id::Y:
+        return m_header.scaleY() * rawField<int32_t>(buf, 4) +
+            m_header.offsetY();
+    case Id::Z:
+        return m_header.scaleZ() * rawField<int32_t>(buf, 8) +
+            m_header.offsetZ();
+    case Id::Intensity:
+        return rawField<uint16_t>(buf, 12);
+    case Id::ReturnNumber:
+        return v14 ? (buf[14] & 0x0F) : (buf[14] & 0x07);
+    case Id::NumberOfReturns:
+        return v14 ? ((uint8_t)buf[14] >> 4) : ((buf[14] >> 3) & 0x07);
+    case Id::ClassFlags:
+        return buf[15] & 0x0F;
+    case Id::ScanChannel:
+        return (buf[15] >> 4) & 0x03;
+    case Id::ScanDirectionFlag:
+        return v14 ? ((buf[15] >> 6) & 0x01) : ((buf[14] >> 6) & 0x01);
+    case Id::EdgeOfFlightLine:
+        return v14 ? ((buf[15] >> 7) & 0x01) : ((buf[14] >> 7) & 0x01);
+    case Id::Classification:
+        return v14 ? (uint8_t)buf[16] : (uint8_t)buf[15];
+    case Id::ScanAngleRank:
+        return v14 ? rawField<int16_t>(buf, 18) * .006 : (int8_t)buf[16];
+    case Id::UserData:
+        return (uint8_t)buf[17];
+    case Id::PointSourceId:
+        return rawField<uint16_t>(buf, v14 ? 20 : 18);
+    case Id::GpsTime:
+        return rawField<double>(buf, v14 ? 22 : 20);
+    case Id::Red:
+        return rawField<uint16_t>(buf, colorOffset);
+    case Id::Green:
+        return rawField<uint16_t>(buf, colorOffset + 2);
+    case Id::Blue:
+        return rawField<uint16_t>(buf, colorOffset + 4);
+    case Id::Infrared:
+        return rawField<uint16_t>(buf, colorOffset + 6);
+    default:
+        return 0;
+    }
+}
+
+
+bool LasReader::processOne(PointRef& point)
+{
+    char *buf;
+
+    if (m_filtered)
+    {
+        buf = nextPassingPoint();
+        if (!buf)
+            return false;
+    }
+    else
+    {
+        if (m_index >= getNumPoints())
+            return false;
+        buf = readRawPoint();
+    }
+    loadPoint(point, buf, m_header.pointLen());
     return true;
 }
 
@@ -538,19 +944,46 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
     size_t pointLen = m_header.pointLen();
     count = std::min(count, getNumPoints() - m_index);
 
+    // With predicates, only points that pass are loaded into the view.
+    if (m_filtered)
+    {
+        point_count_t cnt = 0;
+        char *buf;
+        while (cnt < count && (buf = nextPassingPoint()))
+        {
+            PointId id = view->size();
+            PointRef point = view->point(id);
+            loadPoint(point, buf, pointLen);
+            if (m_cb)
+                m_cb(*view, id);
+            cnt++;
+        }
+        return cnt;
+    }
+
     PointId i = 0;
     if (m_header.compressed())
     {
 #if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
         if (m_compression == "LASZIP" || m_compression == "LAZPERF")
         {
-            for (i = 0; i < count; i++)
+            // Chunks can be decompressed independently, but only when we
+            // start at the beginning of the data, since the
+            // point-at-a-time decompressor isn't advanced.
+            uint32_t chunk = chunkSize();
+            if (m_threads > 1 && m_index == 0 && count == getNumPoints() &&
+                chunk && count > chunk)
+                i = readParallel(*view, count, chunk);
+            if (i == 0)
             {
-                PointRef point = view->point(i);
-                PointId id = view->size();
-                processOne(point);
-                if (m_cb)
-                    m_cb(*view, id);
+                for (i = 0; i < count; i++)
+                {
+                    PointRef point = view->point(i);
+                    PointId id = view->size();
+                    processOne(point);
+                    if (m_cb)
+                        m_cb(*view, id);
+                }
             }
         }
 #else
@@ -558,6 +991,8 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
             "LAZperf decompression library.");
 #endif
     }
+    else if (m_map.addr())
+        i = readMapped(*view, count);
     else
     {
         point_count_t remaining = count;
@@ -572,17 +1007,8 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
             {
                 point_count_t blockPoints = readFileBlock(buf, remaining);
                 remaining -= blockPoints;
-                char *pos = buf.data();
-                while (blockPoints--)
-                {
-                    PointId id = view->size();
-                    PointRef point = view->point(id);
-                    loadPoint(point, pos, pointLen);
-                    if (m_cb)
-                        m_cb(*view, id);
-                    pos += pointLen;
-                    i++;
-                }
+                (this->*m_loadBlockFunc)(*view, buf.data(), blockPoints);
+                i += blockPoints;
             } while (remaining);
         }
         catch (std::out_of_range&)
@@ -595,6 +1021,179 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
 }
 
 
+// Get the number of points in each compressed chunk.  Returns 0 if the
+// file doesn't use fixed-size chunks.
+uint32_t LasReader::chunkSize()
+{
+    uint32_t size = 0;
+
+#ifdef PDAL_HAVE_LASZIP
+    if (m_compression == "LASZIP")
+        size = m_zipPoint->GetZipper()->chunk_size;
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+    if (m_compression == "LAZPERF")
+    {
+        VariableLengthRecord *vlr = m_header.findVlr(LASZIP_USER_ID,
+            LASZIP_RECORD_ID);
+        laszip::io::laz_vlr zipvlr(vlr->data());
+        size = zipvlr.chunk_size;
+    }
+#endif
+    // A chunk size of the maximum value indicates variable-sized chunks.
+    if (size == (std::numeric_limits<uint32_t>::max)())
+        size = 0;
+    return size;
+}
+
+
+// Decompress all the points in the file into the view, spreading ranges of
+// whole chunks across a thread pool.  Returns 0 if the chunk table can't
+// be used.
+point_count_t LasReader::readParallel(PointView& view, point_count_t count,
+    uint32_t chunkSize)
+{
+    point_count_t numChunks = (count + chunkSize - 1) / chunkSize;
+
+    std::vector<std::streamoff> offsets;
+#ifdef PDAL_HAVE_LAZPERF
+    if (m_compression == "LAZPERF")
+    {
+        std::unique_ptr<LasStreamIf> streamIf(openStream());
+        if (streamIf->m_istream)
+            offsets = LazPerfVlrDecompressor::chunkOffsets(
+                *streamIf->m_istream, m_header.pointOffset());
+        if (offsets.size() < numChunks)
+            return 0;
+    }
+#endif
+
+    PointId viewStart = view.size();
+    view.addPoints(count);
+
+    size_t numThreads = (size_t)std::min<point_count_t>(m_threads, numChunks);
+    point_count_t chunksPerThread = (numChunks + numThreads - 1) / numThreads;
+    ThreadPool pool(numThreads);
+    for (point_count_t chunk = 0; chunk < numChunks; chunk += chunksPerThread)
+    {
+        point_count_t start = chunk * chunkSize;
+        point_count_t end = std::min<point_count_t>(count,
+            (chunk + chunksPerThread) * chunkSize);
+        std::streamoff offset = offsets.size() ? offsets[chunk] : 0;
+
+        pool.add([this, &view, viewStart, start, end, offset]()
+        {
+            decompressRange(view, viewStart + start, start, end - start,
+                offset);
+        });
+    }
+    pool.join();
+
+    if (m_cb)
+        for (PointId idx = viewStart; idx < view.size(); ++idx)
+            m_cb(view, idx);
+    return count;
+}
+
+
+// Decompress 'count' points starting at point 'start' in the file into
+// the view at 'viewStart'.  Uses a separate stream and decompressor so
+// that ranges can be decompressed concurrently.
+void LasReader::decompressRange(PointView& view, PointId viewStart,
+    point_count_t start, point_count_t count, std::streamoff chunkOffset)
+{
+    std::unique_ptr<LasStreamIf> streamIf(openStream());
+    std::istream *stream(streamIf->m_istream);
+    if (!stream)
+        throw pdal_error("Unable to open stream for '" + m_filename + "'.");
+
+    size_t pointLen = m_header.pointLen();
+    VariableLengthRecord *vlr = m_header.findVlr(LASZIP_USER_ID,
+        LASZIP_RECORD_ID);
+
+#ifdef PDAL_HAVE_LASZIP
+    if (m_compression == "LASZIP")
+    {
+        ZipPoint zipPoint(vlr);
+        LASunzipper unzipper;
+
+        stream->seekg(m_header.pointOffset(), std::ios::beg);
+        if (!unzipper.open(*stream, zipPoint.GetZipper()) ||
+            !unzipper.seek((unsigned int)start))
+        {
+            std::ostringstream oss;
+            const char* err = unzipper.get_error();
+            if (err == NULL)
+                err = "(unknown error)";
+            oss << "Failed to open LASzip stream: " << std::string(err);
+            throw pdal_error(oss.str());
+        }
+
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            if (!unzipper.read(zipPoint.m_lz_point))
+            {
+                std::string error = "Error reading compressed point data: ";
+                const char* err = unzipper.get_error();
+                if (!err)
+                    err = "(unknown error)";
+                error += err;
+                throw pdal_error(error);
+            }
+            PointRef point(view, viewStart + i);
+            loadPoint(point, (char *)zipPoint.m_lz_point_data.data(),
+                pointLen);
+        }
+        unzipper.close();
+    }
+#endif
+
+#ifdef PDAL_HAVE_LAZPERF
+    if (m_compression == "LAZPERF")
+    {
+        LazPerfVlrDecompressor decompressor(*stream, vlr->data(),
+            m_header.pointOffset(), chunkOffset);
+        std::vector<char> buf(decompressor.pointSize());
+
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            decompressor.decompress(buf.data());
+            PointRef point(view, viewStart + i);
+            loadPoint(point, buf.data(), pointLen);
+        }
+    }
+#endif
+    (void)vlr;
+    (void)pointLen;
+    (void)chunkOffset;
+}
+
+
+// Decode points directly from the mapped file.  Like readFileBlock(),
+// a file shorter than its header claims yields fewer points.
+point_count_t LasReader::readMapped(PointView& view, point_count_t count)
+{
+    size_t pointLen = m_header.pointLen();
+    if (m_index >= m_mapPoints)
+        return 0;
+    count = std::min(count, m_mapPoints - m_index);
+
+    // Decode in blocks to keep the XYZ scratch buffers small.
+    const point_count_t blockSize = std::max<point_count_t>(1,
+        1000000 / pointLen);
+    char *pos = (char *)m_map.addr() + m_index * pointLen;
+    point_count_t remaining = count;
+    while (remaining)
+    {
+        point_count_t blockPoints = std::min(remaining, blockSize);
+        (this->*m_loadBlockFunc)(view, pos, blockPoints);
+        pos += blockPoints * pointLen;
+        remaining -= blockPoints;
+    }
+    return count;
+}
+
+
 point_count_t LasReader::readFileBlock(std::vector<char>& buf,
     point_count_t maxpoints)
 {
@@ -621,14 +1220,51 @@ point_count_t LasReader::readFileBlock(std::vector<char>& buf,
 
 void LasReader::loadPoint(PointRef& point, char *buf, size_t bufsize)
 {
-    if (m_header.has14Format())
-        loadPointV14(point, buf, bufsize);
+    (this->*m_loadFunc)(point, buf, bufsize);
+}
+
+
+// Select the point decoders specialized for the fields present in the
+// file's point format.
+void LasReader::selectLoaders()
+{
+    const LasHeader& h = m_header;
+
+    if (h.has14Format())
+    {
+        if (h.hasColor() && h.hasInfrared())
+            setLoaders<true, true, true, true>();
+        else if (h.hasColor())
+            setLoaders<true, true, true, false>();
+        else if (h.hasInfrared())
+            setLoaders<true, true, false, true>();
+        else
+            setLoaders<true, true, false, false>();
+    }
     else
-        loadPointV10(point, buf, bufsize);
+    {
+        if (h.hasTime() && h.hasColor())
+            setLoaders<false, true, true, false>();
+        else if (h.hasTime())
+            setLoaders<false, true, false, false>();
+        else if (h.hasColor())
+            setLoaders<false, false, true, false>();
+        else
+            setLoaders<false, false, false, false>();
+    }
+}
+
+
+template<bool V14, bool Time, bool Color, bool Infrared>
+void LasReader::setLoaders()
+{
+    m_loadFunc = &LasReader::loadPointT<V14, Time, Color, Infrared>;
+    m_loadBlockFunc = &LasReader::loadBlockT<V14, Time, Color, Infrared>;
 }
 
 
-void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
+template<bool V14, bool Time, bool Color, bool Infrared>
+void LasReader::loadPointT(PointRef& point, char *buf, size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
 
@@ -637,128 +1273,156 @@ void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
 
     const LasHeader& h = m_header;
 
-    double x = xi * h.scaleX() + h.offsetX();
-    double y = yi * h.scaleY() + h.offsetY();
-    double z = zi * h.scaleZ() + h.offsetZ();
-
-    uint16_t intensity;
-    uint8_t flags;
-    uint8_t classification;
-    int8_t scanAngleRank;
-    uint8_t user;
-    uint16_t pointSourceId;
-
-    istream >> intensity >> flags >> classification >> scanAngleRank >>
-        user >> pointSourceId;
+    // The layout types for the standard dimensions were registered by
+    // this stage, so the values are known to fit and the unchecked
+    // setters are safe.
+    m_acc.x.setUnchecked(point, xi * h.scaleX() + h.offsetX());
+    m_acc.y.setUnchecked(point, yi * h.scaleY() + h.offsetY());
+    m_acc.z.setUnchecked(point, zi * h.scaleZ() + h.offsetZ());
+    loadFieldsT<V14, Time, Color, Infrared>(point, istream);
+}
 
-    uint8_t returnNum = flags & 0x07;
-    uint8_t numReturns = (flags >> 3) & 0x07;
-    uint8_t scanDirFlag = (flags >> 6) & 0x01;
-    uint8_t flight = (flags >> 7) & 0x01;
 
-    if (returnNum == 0 || returnNum > 5)
-        m_error.returnNumWarning(returnNum);
+// Load a block of uncompressed points into a view.  XYZ are converted
+// for the whole block in a separate pass so that the scale/offset math
+// runs in a loop the compiler can vectorize.
+template<bool V14, bool Time, bool Color, bool Infrared>
+void LasReader::loadBlockT(PointView& view, char *buf, point_count_t count)
+{
+    const LasHeader& h = m_header;
+    const size_t pointLen = h.pointLen();
 
-    if (numReturns == 0 || numReturns > 5)
-        m_error.numReturnsWarning(numReturns);
+    m_xyzBuf.resize(count * 3);
+    m_xyzIntBuf.resize(count * 3);
+    int32_t *ibuf = m_xyzIntBuf.data();
+    char *pos = buf;
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        uint32_t v[3];
+        memcpy(v, pos, sizeof(v));
+        ibuf[i * 3] = (int32_t)le32toh(v[0]);
+        ibuf[i * 3 + 1] = (int32_t)le32toh(v[1]);
+        ibuf[i * 3 + 2] = (int32_t)le32toh(v[2]);
+        pos += pointLen;
+    }
 
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
-    point.setField(Dimension::Id::Z, z);
-    point.setField(Dimension::Id::Intensity, intensity);
-    point.setField(Dimension::Id::ReturnNumber, returnNum);
-    point.setField(Dimension::Id::NumberOfReturns, numReturns);
-    point.setField(Dimension::Id::ScanDirectionFlag, scanDirFlag);
-    point.setField(Dimension::Id::EdgeOfFlightLine, flight);
-    point.setField(Dimension::Id::Classification, classification);
-    point.setField(Dimension::Id::ScanAngleRank, scanAngleRank);
-    point.setField(Dimension::Id::UserData, user);
-    point.setField(Dimension::Id::PointSourceId, pointSourceId);
+    const double scale[] = { h.scaleX(), h.scaleY(), h.scaleZ() };
+    const double offset[] = { h.offsetX(), h.offsetY(), h.offsetZ() };
+    double *xyz = m_xyzBuf.data();
+    for (point_count_t i = 0; i < count * 3; i += 3)
+    {
+        xyz[i] = ibuf[i] * scale[0] + offset[0];
+        xyz[i + 1] = ibuf[i + 1] * scale[1] + offset[1];
+        xyz[i + 2] = ibuf[i + 2] * scale[2] + offset[2];
+    }
 
-    if (h.hasTime())
+    pos = buf;
+    for (point_count_t i = 0; i < count; ++i)
     {
-        double time;
-        istream >> time;
-        point.setField(Dimension::Id::GpsTime, time);
+        PointId id = view.size();
+        PointRef point = view.point(id);
+
+        m_acc.x.setUnchecked(point, xyz[i * 3]);
+        m_acc.y.setUnchecked(point, xyz[i * 3 + 1]);
+        m_acc.z.setUnchecked(point, xyz[i * 3 + 2]);
+
+        LeExtractor istream(pos, pointLen);
+        istream.skip(3 * sizeof(int32_t));
+        loadFieldsT<V14, Time, Color, Infrared>(point, istream);
+        if (m_cb)
+            m_cb(view, id);
+        pos += pointLen;
     }
+}
+
 
-    if (h.hasColor())
+// Load everything but XYZ from a point record.
+template<bool V14, bool Time, bool Color, bool Infrared>
+void LasReader::loadFieldsT(PointRef& point, LeExtractor& istream)
+{
+    uint16_t intensity;
+    uint8_t returnNum;
+    uint8_t numReturns;
+    uint8_t scanDirFlag;
+    uint8_t flight;
+    uint8_t classification;
+    uint8_t user;
+    uint16_t pointSourceId;
+
+    if (V14)
     {
-        uint16_t red, green, blue;
-        istream >> red >> green >> blue;
-        point.setField(Dimension::Id::Red, red);
-        point.setField(Dimension::Id::Green, green);
-        point.setField(Dimension::Id::Blue, blue);
+        uint8_t returnInfo;
+        uint8_t flags;
+        int16_t scanAngle;
+        double gpsTime;
+
+        istream >> intensity >> returnInfo >> flags >> classification >>
+            user >> scanAngle >> pointSourceId >> gpsTime;
+
+        returnNum = returnInfo & 0x0F;
+        numReturns = (returnInfo >> 4) & 0x0F;
+        uint8_t classFlags = flags & 0x0F;
+        uint8_t scanChannel = (flags >> 4) & 0x03;
+        scanDirFlag = (flags >> 6) & 0x01;
+        flight = (flags >> 7) & 0x01;
+
+        m_acc.classFlags.setUnchecked(point, classFlags);
+        m_acc.scanChannel.setUnchecked(point, scanChannel);
+        m_acc.scanAngle.setUnchecked(point, scanAngle * .006);
+        m_acc.gpsTime.setUnchecked(point, gpsTime);
     }
+    else
+    {
+        uint8_t flags;
+        int8_t scanAngleRank;
 
-    if (m_extraDims.size())
-        loadExtraDims(istream, point);
+        istream >> intensity >> flags >> classification >> scanAngleRank >>
+            user >> pointSourceId;
 
-}
+        returnNum = flags & 0x07;
+        numReturns = (flags >> 3) & 0x07;
+        scanDirFlag = (flags >> 6) & 0x01;
+        flight = (flags >> 7) & 0x01;
 
-void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
-{
-    LeExtractor istream(buf, bufsize);
+        if (returnNum == 0 || returnNum > 5)
+            m_error.returnNumWarning(returnNum);
 
-    int32_t xi, yi, zi;
-    istream >> xi >> yi >> zi;
+        if (numReturns == 0 || numReturns > 5)
+            m_error.numReturnsWarning(numReturns);
 
-    const LasHeader& h = m_header;
+        m_acc.scanAngle.setUnchecked(point, scanAngleRank);
+        if (Time)
+        {
+            double time;
+            istream >> time;
+            m_acc.gpsTime.setUnchecked(point, time);
+        }
+    }
 
-    double x = xi * h.scaleX() + h.offsetX();
-    double y = yi * h.scaleY() + h.offsetY();
-    double z = zi * h.scaleZ() + h.offsetZ();
+    m_acc.intensity.setUnchecked(point, intensity);
+    m_acc.returnNum.setUnchecked(point, returnNum);
+    m_acc.numReturns.setUnchecked(point, numReturns);
+    m_acc.scanDirFlag.setUnchecked(point, scanDirFlag);
+    m_acc.flight.setUnchecked(point, flight);
+    m_acc.classification.setUnchecked(point, classification);
+    m_acc.user.setUnchecked(point, user);
+    m_acc.pointSourceId.setUnchecked(point, pointSourceId);
 
-    uint16_t intensity;
-    uint8_t returnInfo;
-    uint8_t flags;
-    uint8_t classification;
-    uint8_t user;
-    int16_t scanAngle;
-    uint16_t pointSourceId;
-    double gpsTime;
-
-    istream >> intensity >> returnInfo >> flags >> classification >> user >>
-        scanAngle >> pointSourceId >> gpsTime;
-
-    uint8_t returnNum = returnInfo & 0x0F;
-    uint8_t numReturns = (returnInfo >> 4) & 0x0F;
-    uint8_t classFlags = flags & 0x0F;
-    uint8_t scanChannel = (flags >> 4) & 0x03;
-    uint8_t scanDirFlag = (flags >> 6) & 0x01;
-    uint8_t flight = (flags >> 7) & 0x01;
-
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
-    point.setField(Dimension::Id::Z, z);
-    point.setField(Dimension::Id::Intensity, intensity);
-    point.setField(Dimension::Id::ReturnNumber, returnNum);
-    point.setField(Dimension::Id::NumberOfReturns, numReturns);
-    point.setField(Dimension::Id::ClassFlags, classFlags);
-    point.setField(Dimension::Id::ScanChannel, scanChannel);
-    point.setField(Dimension::Id::ScanDirectionFlag, scanDirFlag);
-    point.setField(Dimension::Id::EdgeOfFlightLine, flight);
-    point.setField(Dimension::Id::Classification, classification);
-    point.setField(Dimension::Id::ScanAngleRank, scanAngle * .006);
-    point.setField(Dimension::Id::UserData, user);
-    point.setField(Dimension::Id::PointSourceId, pointSourceId);
-    point.setField(Dimension::Id::GpsTime, gpsTime);
-
-    if (h.hasColor())
+    if (Color)
     {
         uint16_t red, green, blue;
         istream >> red >> green >> blue;
-        point.setField(Dimension::Id::Red, red);
-        point.setField(Dimension::Id::Green, green);
-        point.setField(Dimension::Id::Blue, blue);
+        m_acc.red.setUnchecked(point, red);
+        m_acc.green.setUnchecked(point, green);
+        m_acc.blue.setUnchecked(point, blue);
     }
 
-    if (h.hasInfrared())
+    if (Infrared)
     {
         uint16_t nearInfraRed;
 
         istream >> nearInfraRed;
-        point.setField(Dimension::Id::Infrared, nearInfraRed);
+        m_acc.infrared.setUnchecked(point, nearInfraRed);
     }
 
     if (m_extraDims.size())
@@ -797,6 +1461,21 @@ void LasReader::done(PointTableRef)
     m_zipPoint.reset();
     m_unzipper.reset();
 #endif
+    // Like the stream's position, count the bytes up to the last point
+    // consumed rather than the whole mapping.
+    if (m_map.addr())
+        m_stats.addBytesRead(m_header.pointOffset() +
+            std::min(m_index, m_mapPoints) * m_header.pointLen());
+    else if (m_streamIf && m_streamIf->m_istream)
+    {
+        std::istream *in = m_streamIf->m_istream;
+        in->clear();
+        std::streamoff pos = in->tellg();
+        if (pos > 0)
+            m_stats.addBytesRead(pos);
+    }
+    m_map = FileUtils::unmapFile(m_map);
+    m_mapPoints = 0;
     m_streamIf.reset();
 }
 
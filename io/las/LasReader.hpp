@@ -37,11 +37,15 @@
 #include <pdal/pdal_export.hpp>
 #include <pdal/plugin.hpp>
 #include <pdal/Compression.hpp>
+#include <pdal/DimAccessor.hpp>
+#include <pdal/DimRange.hpp>
+#include <pdal/Polygon.hpp>
 #include <pdal/Reader.hpp>
 
 #include "LasError.hpp"
 #include "LasHeader.hpp"
 #include "LasUtils.hpp"
+#include "LaxIndex.hpp"
 #include "ZipPoint.hpp"
 
 extern "C" int32_t LasReader_ExitFunc();
@@ -61,14 +65,14 @@ protected:
     class LasStreamIf
     {
     protected:
-        LasStreamIf()
+        LasStreamIf() : m_istream(NULL)
         {}
 
     public:
         LasStreamIf(const std::string& filename)
             { m_istream = FileUtils::openFile(filename); }
 
-        ~LasStreamIf()
+        virtual ~LasStreamIf()
         {
             if (m_istream)
                 FileUtils::closeFile(m_istream);
@@ -79,8 +83,14 @@ protected:
 
     friend class NitfReader;
 public:
-    LasReader() : pdal::Reader(), m_index(0)
+    LasReader() : pdal::Reader(), m_index(0), m_loadFunc(nullptr),
+        m_loadBlockFunc(nullptr), m_filtered(false), m_curInterval(0),
+        m_useMmap(false), m_mapPoints(0)
         {}
+    // The mapping is normally released in done(), which isn't called if
+    // reading fails.
+    ~LasReader()
+        { FileUtils::unmapFile(m_map); }
 
     static void * create();
     static int32_t destroy(void *);
@@ -93,11 +103,16 @@ public:
         { return m_header.pointCount(); }
 
 protected:
-    virtual void createStream()
+    // Open a new stream for the point data.  Called for the main stream
+    // and for each worker when decompressing in parallel.
+    virtual LasStreamIf *openStream()
+        { return new LasStreamIf(m_filename); }
+
+    void createStream()
     {
         if (m_streamIf)
             std::cerr << "Attempt to create stream twice!\n";
-        m_streamIf.reset(new LasStreamIf(m_filename));
+        m_streamIf.reset(openStream());
         if (!m_streamIf->m_istream)
         {
             std::ostringstream oss;
@@ -110,8 +125,33 @@ protected:
     std::unique_ptr<LasStreamIf> m_streamIf;
 
 private:
+    // Accessors for the standard LAS dimensions, set up in ready().
+    struct Accessors
+    {
+        DimAccessor<double> x;
+        DimAccessor<double> y;
+        DimAccessor<double> z;
+        DimAccessor<uint16_t> intensity;
+        DimAccessor<uint8_t> returnNum;
+        DimAccessor<uint8_t> numReturns;
+        DimAccessor<uint8_t> classFlags;
+        DimAccessor<uint8_t> scanChannel;
+        DimAccessor<uint8_t> scanDirFlag;
+        DimAccessor<uint8_t> flight;
+        DimAccessor<uint8_t> classification;
+        DimAccessor<double> scanAngle;
+        DimAccessor<uint8_t> user;
+        DimAccessor<uint16_t> pointSourceId;
+        DimAccessor<double> gpsTime;
+        DimAccessor<uint16_t> red;
+        DimAccessor<uint16_t> green;
+        DimAccessor<uint16_t> blue;
+        DimAccessor<uint16_t> infrared;
+    };
+
     LasError m_error;
     LasHeader m_header;
+    Accessors m_acc;
     std::unique_ptr<ZipPoint> m_zipPoint;
     std::unique_ptr<LASunzipper> m_unzipper;
     std::unique_ptr<LazPerfVlrDecompressor> m_decompressor;
@@ -119,6 +159,29 @@ private:
     point_count_t m_index;
     std::vector<ExtraDim> m_extraDims;
     std::string m_compression;
+    typedef void (LasReader::*LoadFunc)(PointRef&, char *, size_t);
+    typedef void (LasReader::*LoadBlockFunc)(PointView&, char *,
+        point_count_t);
+    LoadFunc m_loadFunc;
+    LoadBlockFunc m_loadBlockFunc;
+    std::vector<int32_t> m_xyzIntBuf;
+    std::vector<double> m_xyzBuf;
+    std::vector<char> m_rawBuf;
+
+    // Predicates evaluated against the raw point records.
+    std::vector<BOX3D> m_bounds;
+    std::vector<Polygon> m_polys;
+    std::vector<BOX3D> m_polyBounds;
+    std::vector<DimRange> m_ranges;
+    bool m_filtered;
+    std::vector<LaxIndex::Interval> m_intervals;
+    size_t m_curInterval;
+    std::vector<std::streamoff> m_chunkOffsets;
+
+    // Point data of an uncompressed file mapped into memory.
+    bool m_useMmap;
+    FileUtils::MapContext m_map;
+    point_count_t m_mapPoints;
 
     virtual void processOptions(const Options& options);
     virtual void initialize(PointTableRef table)
@@ -128,6 +191,8 @@ private:
     virtual QuickInfo inspect();
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
     virtual void done(PointTableRef table);
     virtual bool eof()
@@ -138,11 +203,31 @@ private:
     void extractHeaderMetadata(MetadataNode& forward, MetadataNode& m);
     void extractVlrMetadata(MetadataNode& forward, MetadataNode& m);
     void loadPoint(PointRef& point, char *buf, size_t bufsize);
-    void loadPointV10(PointRef& point, char *buf, size_t bufsize);
-    void loadPointV14(PointRef& point, char *buf, size_t bufsize);
+    void selectLoaders();
+    template<bool V14, bool Time, bool Color, bool Infrared>
+    void setLoaders();
+    template<bool V14, bool Time, bool Color, bool Infrared>
+    void loadPointT(PointRef& point, char *buf, size_t bufsize);
+    template<bool V14, bool Time, bool Color, bool Infrared>
+    void loadBlockT(PointView& view, char *buf, point_count_t count);
+    template<bool V14, bool Time, bool Color, bool Infrared>
+    void loadFieldsT(PointRef& point, LeExtractor& istream);
     void loadExtraDims(LeExtractor& istream, PointRef& data);
     point_count_t readFileBlock(std::vector<char>& buf,
         point_count_t maxPoints);
+    point_count_t readMapped(PointView& view, point_count_t count);
+    uint32_t chunkSize();
+    point_count_t readParallel(PointView& view, point_count_t count,
+        uint32_t chunkSize);
+    void decompressRange(PointView& view, PointId viewStart,
+        point_count_t start, point_count_t count, std::streamoff chunkOffset);
+    void readyFilter(const PointLayout& layout);
+    char *readRawPoint();
+    void seekPoint(point_count_t idx);
+    char *nextPassingPoint();
+    bool passesFilter(const char *buf) const;
+    bool rawDimSupported(Dimension::Id::Enum id) const;
+    double rawValue(const char *buf, Dimension::Id::Enum id) const;
 
     LasReader& operator=(const LasReader&); // not implemented
     LasReader(const LasReader&); // not implemented
@@ -42,6 +42,7 @@
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/Inserter.hpp>
 #include <pdal/util/OStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/Utils.hpp>
 #include <pdal/pdal_macros.hpp>
 
@@ -64,7 +65,8 @@ CREATE_STATIC_PLUGIN(1, 0, LasWriter, Writer, s_info)
 
 std::string LasWriter::getName() const { return s_info.name; }
 
-LasWriter::LasWriter() : m_ostream(NULL), m_compression(LasCompression::None)
+LasWriter::LasWriter() : m_ostream(NULL), m_compression(LasCompression::None),
+    m_fillFunc(nullptr)
 {
     m_majorVersion.setDefault(1);
     m_minorVersion.setDefault(2);
@@ -292,8 +294,32 @@ void LasWriter::getHeaderOptions(const Options &options)
 
 void LasWriter::readyTable(PointTableRef table)
 {
+    using namespace Dimension;
+
     m_forwardMetadata = table.privateMetadata("lasforward");
     setExtraBytesVlr();
+
+    const PointLayout& layout(*table.layout());
+    m_acc.x = DimAccessor<double>(layout, Id::X);
+    m_acc.y = DimAccessor<double>(layout, Id::Y);
+    m_acc.z = DimAccessor<double>(layout, Id::Z);
+    m_acc.intensity = DimAccessor<uint16_t>(layout, Id::Intensity);
+    m_acc.returnNum = DimAccessor<uint8_t>(layout, Id::ReturnNumber);
+    m_acc.numReturns = DimAccessor<uint8_t>(layout, Id::NumberOfReturns);
+    m_acc.classFlags = DimAccessor<uint8_t>(layout, Id::ClassFlags);
+    m_acc.scanChannel = DimAccessor<uint8_t>(layout, Id::ScanChannel);
+    m_acc.scanDirFlag = DimAccessor<uint8_t>(layout, Id::ScanDirectionFlag);
+    m_acc.flight = DimAccessor<uint8_t>(layout, Id::EdgeOfFlightLine);
+    m_acc.classification = DimAccessor<uint8_t>(layout, Id::Classification);
+    m_acc.scanAngle = DimAccessor<float>(layout, Id::ScanAngleRank);
+    m_acc.scanAngleRank = DimAccessor<int8_t>(layout, Id::ScanAngleRank);
+    m_acc.user = DimAccessor<uint8_t>(layout, Id::UserData);
+    m_acc.pointSourceId = DimAccessor<uint16_t>(layout, Id::PointSourceId);
+    m_acc.gpsTime = DimAccessor<double>(layout, Id::GpsTime);
+    m_acc.red = DimAccessor<uint16_t>(layout, Id::Red);
+    m_acc.green = DimAccessor<uint16_t>(layout, Id::Green);
+    m_acc.blue = DimAccessor<uint16_t>(layout, Id::Blue);
+    m_acc.infrared = DimAccessor<uint16_t>(layout, Id::Infrared);
 }
 
 
@@ -339,6 +365,7 @@ void LasWriter::prepOutput(std::ostream *outStream, const SpatialReference& srs)
     // Compression should cause the last of the VLRs to get filled.  We now
     // have a valid count, so fill the header again.
     fillHeader();
+    selectFiller();
 
     // Write the header.
     OLeStream out(m_ostream);
@@ -727,6 +754,37 @@ bool LasWriter::processOne(PointRef& point)
 }
 
 
+// Fill the point buffer with all the points in the span that haven't been
+// skipped and write them with a single call.
+void LasWriter::processBatch(PointSpan& span)
+{
+    size_t pointLen = m_lasHeader.pointLen();
+    if (m_pointBuf.size() < pointLen * span.size())
+        m_pointBuf.resize(pointLen * span.size());
+
+    LeInserter ostream(m_pointBuf.data(), m_pointBuf.size());
+    PointRef point = span.point(span.begin());
+    point_count_t filled = 0;
+    for (PointId idx = span.begin(); idx < span.end(); ++idx)
+    {
+        if (span.skipped(idx))
+            continue;
+        point.setPointId(idx);
+        if (fillPointBuf(point, ostream))
+            filled++;
+        else
+            span.skip(idx);
+    }
+
+    if (m_compression == LasCompression::LasZip)
+        writeLasZipBuf(m_pointBuf.data(), pointLen, filled);
+    else if (m_compression == LasCompression::LazPerf)
+        writeLazPerfBuf(m_pointBuf.data(), pointLen, filled);
+    else
+        m_ostream->write(m_pointBuf.data(), filled * pointLen);
+}
+
+
 void LasWriter::writeView(const PointViewPtr view)
 {
     Utils::writeProgress(m_progressFd, "READYVIEW",
@@ -785,6 +843,17 @@ void LasWriter::writeLazPerfBuf(char *pos, size_t pointLen,
     point_count_t numPts)
 {
 #ifdef PDAL_HAVE_LAZPERF
+    // With multiple threads, points are buffered until there are enough
+    // to give each thread a chunk to compress.
+    if (m_threads > 1)
+    {
+        m_chunkBuf.insert(m_chunkBuf.end(), pos, pos + numPts * pointLen);
+        if (m_chunkBuf.size() >= m_threads * m_compressor->chunkSize() *
+                pointLen)
+            writeLazPerfChunks(false);
+        return;
+    }
+
     for (point_count_t i = 0; i < numPts; i++)
     {
         m_compressor->compress(pos);
@@ -794,27 +863,105 @@ void LasWriter::writeLazPerfBuf(char *pos, size_t pointLen,
 }
 
 
+// Compress buffered points into chunks on a thread pool and write the
+// chunks in order.  Points that don't fill a chunk are left in the buffer
+// unless this is the final flush.
+void LasWriter::writeLazPerfChunks(bool flush)
+{
+#ifdef PDAL_HAVE_LAZPERF
+    const size_t pointLen = m_lasHeader.pointLen();
+    const point_count_t chunkSize = m_compressor->chunkSize();
+    const point_count_t numPts = m_chunkBuf.size() / pointLen;
+
+    point_count_t numChunks = numPts / chunkSize;
+    if (flush && numPts % chunkSize)
+        numChunks++;
+    if (numChunks == 0)
+        return;
+
+    std::vector<std::vector<unsigned char>> chunks(numChunks);
+    const auto& schema = m_compressor->schema();
+    ThreadPool pool((size_t)std::min<point_count_t>(m_threads, numChunks));
+    for (point_count_t i = 0; i < numChunks; ++i)
+    {
+        const char *pos = m_chunkBuf.data() + i * chunkSize * pointLen;
+        uint32_t count =
+            (uint32_t)std::min(chunkSize, numPts - i * chunkSize);
+        std::vector<unsigned char>& chunk = chunks[i];
+
+        pool.add([&schema, pos, pointLen, count, &chunk]()
+        {
+            LazPerfVlrCompressor::compressChunk(schema, pos, pointLen,
+                count, chunk);
+        });
+    }
+    pool.join();
+
+    for (auto& chunk : chunks)
+        m_compressor->writeChunk(chunk);
+
+    size_t used = std::min(numPts, numChunks * chunkSize) * pointLen;
+    m_chunkBuf.erase(m_chunkBuf.begin(), m_chunkBuf.begin() + used);
+#endif
+}
+
+
 bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
 {
-    bool has14Format = m_lasHeader.has14Format();
-    bool hasColor = m_lasHeader.hasColor();
-    bool hasTime = m_lasHeader.hasTime();
-    bool hasInfrared = m_lasHeader.hasInfrared();
-    static const size_t maxReturnCount = m_lasHeader.maxReturnCount();
+    return (this->*m_fillFunc)(point, ostream);
+}
+
+
+// Select the point encoder specialized for the fields present in the
+// output point format.
+void LasWriter::selectFiller()
+{
+    const LasHeader& h = m_lasHeader;
+
+    if (h.has14Format())
+    {
+        if (h.hasColor() && h.hasInfrared())
+            m_fillFunc = &LasWriter::fillPointBufT<true, true, true, true>;
+        else if (h.hasColor())
+            m_fillFunc = &LasWriter::fillPointBufT<true, true, true, false>;
+        else if (h.hasInfrared())
+            m_fillFunc = &LasWriter::fillPointBufT<true, true, false, true>;
+        else
+            m_fillFunc = &LasWriter::fillPointBufT<true, true, false, false>;
+    }
+    else
+    {
+        if (h.hasTime() && h.hasColor())
+            m_fillFunc = &LasWriter::fillPointBufT<false, true, true, false>;
+        else if (h.hasTime())
+            m_fillFunc = &LasWriter::fillPointBufT<false, true, false, false>;
+        else if (h.hasColor())
+            m_fillFunc = &LasWriter::fillPointBufT<false, false, true, false>;
+        else
+            m_fillFunc =
+                &LasWriter::fillPointBufT<false, false, false, false>;
+    }
+}
+
+
+template<bool has14Format, bool hasTime, bool hasColor, bool hasInfrared>
+bool LasWriter::fillPointBufT(PointRef& point, LeInserter& ostream)
+{
+    const size_t maxReturnCount = m_lasHeader.maxReturnCount();
 
     // we always write the base fields
     using namespace Dimension;
 
     uint8_t returnNumber(1);
     uint8_t numberOfReturns(1);
-    if (point.hasDim(Id::ReturnNumber))
+    if (m_acc.returnNum.valid())
     {
-        returnNumber = point.getFieldAs<uint8_t>(Id::ReturnNumber);
+        returnNumber = m_acc.returnNum.get(point);
         if (returnNumber < 1 || returnNumber > maxReturnCount)
             m_error.returnNumWarning(returnNumber);
     }
-    if (point.hasDim(Id::NumberOfReturns))
-        numberOfReturns = point.getFieldAs<uint8_t>(Id::NumberOfReturns);
+    if (m_acc.numReturns.valid())
+        numberOfReturns = m_acc.numReturns.get(point);
     if (numberOfReturns == 0)
         m_error.numReturnsWarning(0);
     if (numberOfReturns > maxReturnCount)
@@ -830,9 +977,9 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
             m_error.numReturnsWarning(numberOfReturns);
     }
 
-    double xOrig = point.getFieldAs<double>(Id::X);
-    double yOrig = point.getFieldAs<double>(Id::Y);
-    double zOrig = point.getFieldAs<double>(Id::Z);
+    double xOrig = m_acc.x.get(point);
+    double yOrig = m_acc.y.get(point);
+    double zOrig = m_acc.z.get(point);
 
     double x = (xOrig - m_xXform.m_offset) / m_xXform.m_scale;
     double y = (yOrig - m_yXform.m_offset) / m_yXform.m_scale;
@@ -857,20 +1004,18 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
     ostream << converter(y, Id::Y);
     ostream << converter(z, Id::Z);
 
-    ostream << point.getFieldAs<uint16_t>(Id::Intensity);
+    ostream << m_acc.intensity.get(point);
 
-    uint8_t scanChannel = point.getFieldAs<uint8_t>(Id::ScanChannel);
-    uint8_t scanDirectionFlag =
-        point.getFieldAs<uint8_t>(Id::ScanDirectionFlag);
-    uint8_t edgeOfFlightLine =
-        point.getFieldAs<uint8_t>(Id::EdgeOfFlightLine);
+    uint8_t scanChannel = m_acc.scanChannel.get(point);
+    uint8_t scanDirectionFlag = m_acc.scanDirFlag.get(point);
+    uint8_t edgeOfFlightLine = m_acc.flight.get(point);
 
     if (has14Format)
     {
         uint8_t bits = returnNumber | (numberOfReturns << 4);
         ostream << bits;
 
-        uint8_t classFlags = point.getFieldAs<uint8_t>(Id::ClassFlags);
+        uint8_t classFlags = m_acc.classFlags.get(point);
         bits = (classFlags & 0x0F) |
             ((scanChannel & 0x03) << 4) |
             ((scanDirectionFlag & 0x01) << 6) |
@@ -884,35 +1029,34 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
         ostream << bits;
     }
 
-    ostream << point.getFieldAs<uint8_t>(Id::Classification);
+    ostream << m_acc.classification.get(point);
 
-    uint8_t userData = point.getFieldAs<uint8_t>(Id::UserData);
+    uint8_t userData = m_acc.user.get(point);
     if (has14Format)
     {
-         int16_t scanAngleRank =
-             point.getFieldAs<float>(Id::ScanAngleRank) / .006;
+         int16_t scanAngleRank = m_acc.scanAngle.get(point) / .006;
          ostream << userData << scanAngleRank;
     }
     else
     {
-        int8_t scanAngleRank = point.getFieldAs<int8_t>(Id::ScanAngleRank);
+        int8_t scanAngleRank = m_acc.scanAngleRank.get(point);
         ostream << scanAngleRank << userData;
     }
 
-    ostream << point.getFieldAs<uint16_t>(Id::PointSourceId);
+    ostream << m_acc.pointSourceId.get(point);
 
     if (hasTime)
-        ostream << point.getFieldAs<double>(Id::GpsTime);
+        ostream << m_acc.gpsTime.get(point);
 
     if (hasColor)
     {
-        ostream << point.getFieldAs<uint16_t>(Id::Red);
-        ostream << point.getFieldAs<uint16_t>(Id::Green);
-        ostream << point.getFieldAs<uint16_t>(Id::Blue);
+        ostream << m_acc.red.get(point);
+        ostream << m_acc.green.get(point);
+        ostream << m_acc.blue.get(point);
     }
 
     if (hasInfrared)
-        ostream << point.getFieldAs<uint16_t>(Id::Infrared);
+        ostream << m_acc.infrared.get(point);
 
     Everything e;
     for (auto& dim : m_extraDims)
@@ -949,6 +1093,10 @@ void LasWriter::doneFile()
     finishOutput();
     Utils::writeProgress(m_progressFd, "DONEFILE", m_curFilename);
     m_curFilename.clear();
+    m_ostream->seekp(0, std::ios::end);
+    std::streamoff pos = m_ostream->tellp();
+    if (pos > 0)
+        m_stats.addBytesWritten(pos);
     delete m_ostream;
     m_ostream = NULL;
 }
@@ -1001,6 +1149,8 @@ void LasWriter::finishLasZipOutput()
 void LasWriter::finishLazPerfOutput()
 {
 #ifdef PDAL_HAVE_LAZPERF
+    if (m_threads > 1)
+        writeLazPerfChunks(true);
     m_compressor->done();
 #endif
 }
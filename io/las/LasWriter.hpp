@@ -35,6 +35,7 @@
 #pragma once
 
 #include <pdal/Compression.hpp>
+#include <pdal/DimAccessor.hpp>
 #include <pdal/FlexWriter.hpp>
 #include <pdal/plugin.hpp>
 
@@ -82,8 +83,34 @@ protected:
     void finishOutput();
 
 private:
+    // Accessors for the standard LAS dimensions, set up in readyTable().
+    struct Accessors
+    {
+        DimAccessor<double> x;
+        DimAccessor<double> y;
+        DimAccessor<double> z;
+        DimAccessor<uint16_t> intensity;
+        DimAccessor<uint8_t> returnNum;
+        DimAccessor<uint8_t> numReturns;
+        DimAccessor<uint8_t> classFlags;
+        DimAccessor<uint8_t> scanChannel;
+        DimAccessor<uint8_t> scanDirFlag;
+        DimAccessor<uint8_t> flight;
+        DimAccessor<uint8_t> classification;
+        DimAccessor<float> scanAngle;
+        DimAccessor<int8_t> scanAngleRank;
+        DimAccessor<uint8_t> user;
+        DimAccessor<uint16_t> pointSourceId;
+        DimAccessor<double> gpsTime;
+        DimAccessor<uint16_t> red;
+        DimAccessor<uint16_t> green;
+        DimAccessor<uint16_t> blue;
+        DimAccessor<uint16_t> infrared;
+    };
+
     LasError m_error;
     LasHeader m_lasHeader;
+    Accessors m_acc;
     std::unique_ptr<SummaryData> m_summaryData;
     std::unique_ptr<LASzipper> m_zipper;
     std::unique_ptr<ZipPoint> m_zipPoint;
@@ -102,6 +129,9 @@ private:
     bool m_forwardVlrs;
     LasCompression::Enum m_compression;
     std::vector<char> m_pointBuf;
+    std::vector<char> m_chunkBuf;
+    typedef bool (LasWriter::*FillFunc)(PointRef&, LeInserter&);
+    FillFunc m_fillFunc;
 
     NumHeaderVal<uint8_t, 1, 1> m_majorVersion;
     NumHeaderVal<uint8_t, 1, 4> m_minorVersion;
@@ -131,7 +161,10 @@ private:
     virtual void readyFile(const std::string& filename,
         const SpatialReference& srs);
     virtual void writeView(const PointViewPtr view);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual void processBatch(PointSpan& span);
     virtual void doneFile();
 
     void fillForwardList(const Options& options);
@@ -142,6 +175,9 @@ private:
     void handleHeaderForwards(MetadataNode& forward);
     void fillHeader();
     bool fillPointBuf(PointRef& point, LeInserter& ostream);
+    void selectFiller();
+    template<bool has14Format, bool hasTime, bool hasColor, bool hasInfrared>
+    bool fillPointBufT(PointRef& point, LeInserter& ostream);
     point_count_t fillWriteBuf(const PointView& view, PointId startId,
         std::vector<char>& buf);
     void writeLasZipBuf(char *data, size_t pointLen, point_count_t numPts);
@@ -154,6 +190,7 @@ private:
     void readyCompression();
     void readyLasZipCompression();
     void readyLazPerfCompression();
+    void writeLazPerfChunks(bool flush);
     void openCompression();
     void addVlr(const std::string& userId, uint16_t recordId,
         const std::string& description, std::vector<uint8_t>& data);
@@ -0,0 +1,204 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "LaxIndex.hpp"
+
+#include <algorithm>
+
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/IStream.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+bool checkSignature(ILeStream& in, const std::string& sig)
+{
+    std::string s;
+    in.get(s, sig.size());
+    return in.good() && s == sig;
+}
+
+} // unnamed namespace
+
+
+// The .lax format is written by LAStools' lasindex:
+//   "LASX", version, quadtree, interval list
+// The quadtree is:
+//   "LASS", type, "LASQ", version, levels, level index, implicit levels,
+//   min x, max x, min y, max y (floats)
+// The interval list is:
+//   "LASV", version, cell count, and for each cell:
+//     cell index, interval count, point count, and for each interval:
+//       first point, last point (inclusive)
+bool LaxIndex::open(const std::string& filename)
+{
+    std::string ext = FileUtils::extension(filename);
+    std::string laxFilename =
+        filename.substr(0, filename.size() - ext.size()) + ".lax";
+    if (!FileUtils::fileExists(laxFilename))
+        return false;
+
+    ILeStream in(laxFilename);
+    if (!in.good())
+        return false;
+
+    uint32_t version;
+    uint32_t type;
+    uint32_t levels;
+    uint32_t levelIndex;
+    uint32_t implicitLevels;
+
+    if (!checkSignature(in, "LASX"))
+        return false;
+    in >> version;
+    if (!checkSignature(in, "LASS"))
+        return false;
+    in >> type;
+    if (!checkSignature(in, "LASQ"))
+        return false;
+    in >> version >> levels >> levelIndex >> implicitLevels;
+    in >> m_minx >> m_maxx >> m_miny >> m_maxy;
+    // Cell numbers of more than 15 levels don't fit in 32 bits.
+    if (!in.good() || levels > 15 || m_minx > m_maxx || m_miny > m_maxy)
+        return false;
+
+    // Cells of all levels are numbered consecutively, starting with the
+    // single cell at level zero.
+    m_levelOffset.resize(levels + 2);
+    m_levelOffset[0] = 0;
+    for (uint32_t l = 0; l <= levels; ++l)
+        m_levelOffset[l + 1] = m_levelOffset[l] + (1u << (2 * l));
+
+    if (!checkSignature(in, "LASV"))
+        return false;
+    int32_t numCells;
+    in >> version >> numCells;
+    if (!in.good() || numCells < 0)
+        return false;
+
+    m_cells.resize(numCells);
+    for (Cell& cell : m_cells)
+    {
+        int32_t index;
+        uint32_t numIntervals;
+        uint32_t numPoints;
+
+        in >> index >> numIntervals >> numPoints;
+        if (!in.good() || index < 0 ||
+            (uint32_t)index >= m_levelOffset[levels + 1])
+            return false;
+        cell.m_index = (uint32_t)index;
+        cell.m_intervals.reserve(numIntervals);
+        for (uint32_t i = 0; i < numIntervals; ++i)
+        {
+            uint32_t start, end;
+            in >> start >> end;
+            cell.m_intervals.push_back(Interval(start, (point_count_t)end + 1));
+        }
+        if (!in.good())
+            return false;
+    }
+    return true;
+}
+
+
+// Cell indices encode the level of the cell (by offset) and, within the
+// level, two bits per level giving the quadrant (bit 0 set: upper half in
+// X, bit 1 set: upper half in Y) starting from the root.
+BOX2D LaxIndex::cellBounds(uint32_t cellIndex) const
+{
+    uint32_t level = 0;
+    while (cellIndex >= m_levelOffset[level + 1])
+        level++;
+    uint32_t levelIndex = cellIndex - m_levelOffset[level];
+
+    float minx = m_minx;
+    float maxx = m_maxx;
+    float miny = m_miny;
+    float maxy = m_maxy;
+    while (level)
+    {
+        uint32_t quad = (levelIndex >> (2 * (level - 1))) & 3;
+        float midx = (minx + maxx) / 2;
+        float midy = (miny + maxy) / 2;
+        if (quad & 1)
+            minx = midx;
+        else
+            maxx = midx;
+        if (quad & 2)
+            miny = midy;
+        else
+            maxy = midy;
+        level--;
+    }
+    return BOX2D(minx, miny, maxx, maxy);
+}
+
+
+std::vector<LaxIndex::Interval> LaxIndex::query(const BOX2D& box) const
+{
+    std::vector<Interval> intervals;
+
+    for (const Cell& cell : m_cells)
+    {
+        BOX2D b = cellBounds(cell.m_index);
+
+        // The quadtree is computed in single precision, so be generous
+        // at the edges.
+        double fuzzx = (b.maxx - b.minx) * 1e-4;
+        double fuzzy = (b.maxy - b.miny) * 1e-4;
+        if (box.maxx < b.minx - fuzzx || box.minx > b.maxx + fuzzx ||
+            box.maxy < b.miny - fuzzy || box.miny > b.maxy + fuzzy)
+            continue;
+        intervals.insert(intervals.end(), cell.m_intervals.begin(),
+            cell.m_intervals.end());
+    }
+
+    // Sort and merge overlapping/adjacent intervals.
+    std::sort(intervals.begin(), intervals.end());
+    std::vector<Interval> merged;
+    for (const Interval& i : intervals)
+    {
+        if (merged.size() && i.first <= merged.back().second)
+            merged.back().second = std::max(merged.back().second, i.second);
+        else
+            merged.push_back(i);
+    }
+    return merged;
+}
+
+} // namespace pdal
@@ -0,0 +1,95 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+/**
+  Spatial index of a LAS/LAZ file stored in a LAStools-style .lax file.
+  The index is a quadtree whose cells each list the intervals of point
+  indices of the points that fall in the cell.
+*/
+class PDAL_DLL LaxIndex
+{
+public:
+    /// Interval of point indices: [first, second).
+    typedef std::pair<point_count_t, point_count_t> Interval;
+
+    LaxIndex() : m_minx(0), m_maxx(0), m_miny(0), m_maxy(0)
+    {}
+
+    /**
+      Load the index file that accompanies a LAS/LAZ file.
+
+      \param filename  Name of the LAS/LAZ file (not the index file).
+      \return  Whether a valid index was found.
+    */
+    bool open(const std::string& filename);
+
+    /**
+      Get the intervals of points that may fall in a box.  Intervals are
+      sorted and don't overlap.
+
+      \param box  Query box.
+      \return  Intervals of points in cells that overlap the box.
+    */
+    std::vector<Interval> query(const BOX2D& box) const;
+
+private:
+    struct Cell
+    {
+        uint32_t m_index;
+        std::vector<Interval> m_intervals;
+    };
+
+    float m_minx;
+    float m_maxx;
+    float m_miny;
+    float m_maxy;
+    std::vector<uint32_t> m_levelOffset;
+    std::vector<Cell> m_cells;
+
+    BOX2D cellBounds(uint32_t cellIndex) const;
+};
+
+} // namespace pdal
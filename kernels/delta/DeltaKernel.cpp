@@ -35,7 +35,13 @@
 #include "DeltaKernel.hpp"
 
 #include <pdal/PDALUtils.hpp>
+#include <pdal/PointTable.hpp>
 #include <pdal/pdal_macros.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+#include <streamcallback/StreamCallbackFilter.hpp>
+
+#include <iomanip>
 
 namespace pdal
 {
@@ -49,7 +55,8 @@ CREATE_STATIC_PLUGIN(1, 0, DeltaKernel, Kernel, s_info)
 
 std::string DeltaKernel::getName() const { return s_info.name; }
 
-DeltaKernel::DeltaKernel() : m_3d(true), m_detail(false), m_allDims(false)
+DeltaKernel::DeltaKernel() : m_out(NULL), m_3d(true), m_detail(false),
+    m_allDims(false), m_threads(1), m_chunkSize(1000000)
 {}
 
 
@@ -66,6 +73,25 @@ void DeltaKernel::addSwitches(ProgramArgs& args)
     args.add("detail", "Output deltas per-point", m_detail);
     args.add("alldims", "Compute diffs for all dimensions (not just X,Y,Z)",
         m_allDims);
+    args.add("format", "Format of per-point output (csv, binary)",
+        m_format, "csv");
+    args.add("threads", "Number of threads used for neighbor queries",
+        m_threads, ThreadPool::hardwareThreads());
+    args.add("chunk_size", "Number of source points compared at a time",
+        m_chunkSize, (point_count_t)1000000);
+}
+
+
+void DeltaKernel::validateSwitches(ProgramArgs& /*args*/)
+{
+    m_format = Utils::tolower(m_format);
+    if (m_format != "csv" && m_format != "binary")
+        throw pdal_error("Invalid 'format' '" + m_format + "'.  "
+            "Must be 'csv' or 'binary'.");
+    if (m_chunkSize == 0)
+        throw pdal_error("Option 'chunk_size' must be greater than 0.");
+    if (m_threads == 0)
+        m_threads = 1;
 }
 
 
@@ -87,18 +113,13 @@ PointViewPtr DeltaKernel::loadSet(const std::string& filename,
 }
 
 
-int DeltaKernel::execute()
+// Find the dimensions that are in both the source and candidate, ordered
+// by name.
+DimIndexList DeltaKernel::selectDims(PointLayoutPtr srcLayout,
+    PointLayoutPtr candLayout)
 {
-    PointTable srcTable;
-    PointTable candTable;
     DimIndexMap dims;
 
-    PointViewPtr srcView = loadSet(m_sourceFile, srcTable);
-    PointViewPtr candView = loadSet(m_candidateFile, candTable);
-
-    PointLayoutPtr srcLayout = srcTable.layout();
-    PointLayoutPtr candLayout = candTable.layout();
-
     Dimension::IdList ids = srcLayout->dims();
     for (Dimension::Id::Enum dim : ids)
     {
@@ -123,62 +144,256 @@ int DeltaKernel::execute()
     }
 
     // Remove dimensions that aren't in both the source and candidate lists.
-    for (auto di = dims.begin(); di != dims.end();)
+    DimIndexList list;
+    for (auto& dpair : dims)
+        if (dpair.second.m_candId != Dimension::Id::Unknown)
+            list.push_back(dpair.second);
+    return list;
+}
+
+
+int DeltaKernel::execute()
+{
+    PointTable candTable;
+    m_candView = loadSet(m_candidateFile, candTable);
+    if (m_candView->empty())
+        throw pdal_error("No points in candidate file '" +
+            m_candidateFile + "'.");
+
+    // Index the candidate data.
+    if (m_3d)
     {
-        DimIndex& d = di->second;
-        if (d.m_candId == Dimension::Id::Unknown)
-            dims.erase(di++);
-        else
-            ++di;
+        m_index3.reset(new KD3Index(*m_candView));
+        m_index3->build(m_threads);
+    }
+    else
+    {
+        m_index2.reset(new KD2Index(*m_candView));
+        m_index2->build(m_threads);
     }
 
-    // Index the candidate data.
-    KD3Index index(*candView);
-    index.build();
+    if (m_outputFile.size())
+    {
+        m_out = FileUtils::createFile(m_outputFile, true);
+        if (!m_out)
+            throw pdal_error("Unable to open output file '" +
+                m_outputFile + "'.");
+    }
+    else
+        m_out = &std::cout;
 
-    MetadataNode root;
+    Options ops;
+    ops.add<std::string>("filename", m_sourceFile);
+    ops.add<bool>("debug", isDebug());
+    ops.add<uint32_t>("verbose", getVerboseLevel());
 
-    if (m_detail)
-        root = dumpDetail(srcView, candView, index, dims);
-    else
-        root = dump(srcView, candView, index, dims);
-    Utils::toJSON(root, std::cout);
+    Stage& reader = makeReader(m_sourceFile);
+    reader.setOptions(ops);
+    streamSource(reader);
+
+    if (!m_detail)
+        Utils::toJSON(dump(), *m_out);
 
+    if (m_out != &std::cout)
+        FileUtils::closeFile(m_out);
+    m_out = NULL;
     return 0;
 }
 
 
-MetadataNode DeltaKernel::dump(PointViewPtr& srcView, PointViewPtr& candView,
-    KD3Index& index, DimIndexMap& dims)
+// Read the source in chunks of points.  Readers that can't stream are
+// read in full and their points passed along in the same way.
+void DeltaKernel::streamSource(Stage& reader)
 {
-    MetadataNode root;
+    if (!reader.pipelineStreamable())
+    {
+        PointTable table;
+        PointViewPtr view = loadSet(m_sourceFile, table);
+        m_dims = selectDims(table.layout(), m_candView->table().layout());
+        if (m_detail)
+            writeHeader();
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            PointRef point(view->point(idx));
+            addPoint(point);
+        }
+        processChunk();
+        return;
+    }
+
+    StreamCallbackFilter f;
+    f.setInput(reader);
+    f.setCallback([this](PointRef& point)
+    {
+        addPoint(point);
+        return true;
+    });
+
+    FixedPointTable srcTable(10000);
+    f.prepare(srcTable);
+    m_dims = selectDims(srcTable.layout(), m_candView->table().layout());
+    if (m_detail)
+        writeHeader();
+    f.execute(srcTable);
+    processChunk();
+}
+
+
+void DeltaKernel::addPoint(PointRef& point)
+{
+    Chunk& c = m_chunk;
+
+    c.m_positions.push_back(point.getFieldAs<double>(Dimension::Id::X));
+    c.m_positions.push_back(point.getFieldAs<double>(Dimension::Id::Y));
+    if (m_3d)
+        c.m_positions.push_back(point.getFieldAs<double>(Dimension::Id::Z));
+    for (DimIndex& d : m_dims)
+        c.m_values.push_back(point.getFieldAs<double>(d.m_srcId));
+    c.m_count++;
+
+    if (c.m_count == m_chunkSize)
+        processChunk();
+}
+
+
+void DeltaKernel::findNeighbors(std::vector<PointId>& ids)
+{
+    std::vector<double> sqrDists;
+
+    if (m_3d)
+        m_index3->knnSearch(m_chunk.m_positions, 1, ids, sqrDists, m_threads);
+    else
+        m_index2->knnSearch(m_chunk.m_positions, 1, ids, sqrDists, m_threads);
+}
+
+
+// Compare a chunk of source points with their nearest candidates.  Each
+// task collects statistics in its own accumulators, which are merged in
+// order once all tasks are done.  Tasks are a fixed size, so the results
+// don't depend on the number of threads.
+void DeltaKernel::processChunk()
+{
+    Chunk& c = m_chunk;
+    if (c.m_count == 0)
+        return;
 
-    for (PointId id = 0; id < srcView->size(); ++id)
+    std::vector<PointId> ids;
+    findNeighbors(ids);
+
+    const std::size_t numDims = m_dims.size();
+    const point_count_t taskSize = 256;
+    const std::size_t numTasks = (c.m_count + taskSize - 1) / taskSize;
+
+    std::vector<double> deltas(m_detail ? c.m_count * numDims : 0);
+    std::vector<DimIndexList> accums(numTasks);
+
+    auto compare = [&](std::size_t task)
     {
-        double x = srcView->getFieldAs<double>(Dimension::Id::X, id);
-        double y = srcView->getFieldAs<double>(Dimension::Id::Y, id);
-        double z = srcView->getFieldAs<double>(Dimension::Id::Z, id);
+        DimIndexList& acc = accums[task];
+        for (const DimIndex& d : m_dims)
+        {
+            DimIndex a;
+            a.m_candId = d.m_candId;
+            acc.push_back(a);
+        }
 
-        PointId candId = index.neighbor(x, y, z);
+        point_count_t begin = task * taskSize;
+        point_count_t end = (std::min)(begin + taskSize, c.m_count);
+        for (point_count_t i = begin; i < end; ++i)
+        {
+            const double *sv = c.m_values.data() + i * numDims;
+            for (std::size_t di = 0; di < numDims; ++di)
+            {
+                DimIndex& a = acc[di];
+                double cv = m_candView->getFieldAs<double>(a.m_candId, ids[i]);
+                double delta = sv[di] - cv;
+                accumulate(a, delta);
+                if (m_detail)
+                    deltas[i * numDims + di] = delta;
+            }
+        }
+    };
+
+    if (m_threads > 1 && numTasks > 1)
+    {
+        ThreadPool pool((std::min)(m_threads, numTasks));
+        for (std::size_t task = 0; task < numTasks; ++task)
+            pool.add([&compare, task](){ compare(task); });
+        pool.join();
+    }
+    else
+        for (std::size_t task = 0; task < numTasks; ++task)
+            compare(task);
+
+    for (DimIndexList& acc : accums)
+        for (std::size_t di = 0; di < numDims; ++di)
+            merge(m_dims[di], acc[di]);
 
-        // It may be faster to put in a special case to avoid having to
-        // fetch X, Y and Z, more than once but this is simpler and
-        // I'm thinking in most cases it will make no practical difference.
-        for (auto di = dims.begin(); di != dims.end(); ++di)
+    if (m_detail)
+        writeDetail(deltas);
+
+    c.m_firstId += c.m_count;
+    c.m_count = 0;
+    c.m_positions.clear();
+    c.m_values.clear();
+}
+
+
+// CSV output has a header line.  Binary output is a record for each
+// point of the source point ID as a uint64 followed by a double for each
+// dimension, in machine byte order.
+void DeltaKernel::writeHeader()
+{
+    if (m_format != "csv")
+        return;
+
+    *m_out << "\"ID\"";
+    for (DimIndex& d : m_dims)
+        *m_out << ",\"Delta" << d.m_name << "\"";
+    *m_out << std::endl;
+}
+
+
+void DeltaKernel::writeDetail(const std::vector<double>& deltas)
+{
+    const std::size_t numDims = m_dims.size();
+    const double *delta = deltas.data();
+
+    if (m_format == "binary")
+    {
+        std::vector<char> buf(sizeof(uint64_t) + numDims * sizeof(double));
+        for (point_count_t i = 0; i < m_chunk.m_count; ++i)
         {
-            DimIndex& d = di->second;
-            double sv = srcView->getFieldAs<double>(d.m_srcId, id);
-            double cv = candView->getFieldAs<double>(d.m_candId, candId);
-            accumulate(d, sv - cv);
+            uint64_t id = m_chunk.m_firstId + i;
+            memcpy(buf.data(), &id, sizeof(id));
+            memcpy(buf.data() + sizeof(id), delta, numDims * sizeof(double));
+            m_out->write(buf.data(), buf.size());
+            delta += numDims;
         }
+        return;
+    }
+
+    std::ostringstream oss;
+    oss << std::setprecision(10);
+    for (point_count_t i = 0; i < m_chunk.m_count; ++i)
+    {
+        oss << (m_chunk.m_firstId + i);
+        for (std::size_t di = 0; di < numDims; ++di)
+            oss << "," << *delta++;
+        oss << "\n";
     }
+    *m_out << oss.str();
+}
+
+
+MetadataNode DeltaKernel::dump()
+{
+    MetadataNode root;
 
     root.add("source", m_sourceFile);
     root.add("candidate", m_candidateFile);
-    for (auto dpair : dims)
+    for (DimIndex& d : m_dims)
     {
-        DimIndex& d = dpair.second;
-
         MetadataNode dimNode = root.add(d.m_name);
         dimNode.add("min", d.m_min);
         dimNode.add("max", d.m_max);
@@ -197,30 +412,16 @@ void DeltaKernel::accumulate(DimIndex& d, double v)
 }
 
 
-MetadataNode DeltaKernel::dumpDetail(PointViewPtr& srcView,
-    PointViewPtr& candView, KD3Index& index, DimIndexMap& dims)
+void DeltaKernel::merge(DimIndex& d, const DimIndex& other)
 {
-    MetadataNode root;
-
-    for (PointId id = 0; id < srcView->size(); ++id)
-    {
-        double x = srcView->getFieldAs<double>(Dimension::Id::X, id);
-        double y = srcView->getFieldAs<double>(Dimension::Id::Y, id);
-        double z = srcView->getFieldAs<double>(Dimension::Id::Z, id);
-        PointId candId = index.neighbor(x, y, z);
-
-        MetadataNode delta = root.add("delta");
-        delta.add("i", id);
-        for (auto di = dims.begin(); di != dims.end(); ++di)
-        {
-            DimIndex& d = di->second;
-            double sv = srcView->getFieldAs<double>(d.m_srcId, id);
-            double cv = candView->getFieldAs<double>(d.m_candId, candId);
-
-            delta.add(d.m_name, sv - cv);
-        }
-    }
-    return root;
+    if (other.m_cnt == 0)
+        return;
+
+    point_count_t cnt = d.m_cnt + other.m_cnt;
+    d.m_avg += (other.m_avg - d.m_avg) * other.m_cnt / cnt;
+    d.m_cnt = cnt;
+    d.m_min = std::min(other.m_min, d.m_min);
+    d.m_max = std::max(other.m_max, d.m_max);
 }
 
 } // pdal
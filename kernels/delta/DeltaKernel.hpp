@@ -35,6 +35,8 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <vector>
 
 #include <pdal/KDIndex.hpp>
 #include <pdal/Kernel.hpp>
@@ -65,6 +67,7 @@ struct DimIndex
     {}
 };
 typedef std::map<std::string, DimIndex> DimIndexMap;
+typedef std::vector<DimIndex> DimIndexList;
 
 class PDAL_DLL DeltaKernel : public Kernel
 {
@@ -75,26 +78,51 @@ public:
     int execute();
 
 private:
+    // Source points waiting for their neighbors to be found.
+    struct Chunk
+    {
+        Chunk() : m_firstId(0), m_count(0)
+        {}
+
+        PointId m_firstId;
+        point_count_t m_count;
+        std::vector<double> m_positions;
+        std::vector<double> m_values;
+    };
+
     DeltaKernel();
     void addSwitches(ProgramArgs& args);
+    void validateSwitches(ProgramArgs& args);
     PointViewPtr loadSet(const std::string& filename, PointTable& table);
-    MetadataNode dump(PointViewPtr& srcView, PointViewPtr& candView,
-        KD3Index& index, DimIndexMap& dims);
-    MetadataNode dumpDetail(PointViewPtr& srcView, PointViewPtr& candView,
-        KD3Index& index, DimIndexMap& dims);
-    void accumulate(DimIndex& d, double v);
+    DimIndexList selectDims(PointLayoutPtr srcLayout,
+        PointLayoutPtr candLayout);
+    void streamSource(Stage& reader);
+    void addPoint(PointRef& point);
+    void processChunk();
+    void findNeighbors(std::vector<PointId>& ids);
+    void writeHeader();
+    void writeDetail(const std::vector<double>& deltas);
+    MetadataNode dump();
+    static void accumulate(DimIndex& d, double v);
+    static void merge(DimIndex& d, const DimIndex& other);
 
     std::string m_sourceFile;
     std::string m_candidateFile;
     std::string m_outputFile;
-
-    /**
-    std::ostream* m_outputStream;
-    **/
+    std::string m_format;
+    std::ostream *m_out;
 
     bool m_3d;
     bool m_detail;
     bool m_allDims;
+    std::size_t m_threads;
+    point_count_t m_chunkSize;
+
+    PointViewPtr m_candView;
+    std::unique_ptr<KD2Index> m_index2;
+    std::unique_ptr<KD3Index> m_index3;
+    DimIndexList m_dims;
+    Chunk m_chunk;
 };
 
 } // namespace pdal
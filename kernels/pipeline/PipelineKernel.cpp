@@ -54,7 +54,8 @@ CREATE_STATIC_PLUGIN(1, 0, PipelineKernel, Kernel, s_info)
 
 std::string PipelineKernel::getName() const { return s_info.name; }
 
-PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1)
+PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1),
+    m_threads(1), m_columnar(false), m_timing(false)
 {}
 
 
@@ -80,6 +81,12 @@ void PipelineKernel::addSwitches(ProgramArgs& args)
         "information.  The file/FIFO must exist.  PDAL will not create "
         "the progress file.",
         m_progressFile);
+    args.add("threads", "Maximum number of threads used to run point views "
+        "through each stage", m_threads, 1u);
+    args.add("columnar", "Store points in a columnar point table (one array "
+        "per dimension)", m_columnar);
+    args.add("timing", "Report the time, points and memory used by each "
+        "stage", m_timing);
     args.add("pointcloudschema", "dump PointCloudSchema XML output",
         m_PointCloudSchemaOutput).setHidden();
 }
@@ -91,11 +98,20 @@ int PipelineKernel::execute()
     if (m_progressFile.size())
         m_progressFd = Utils::openProgress(m_progressFile);
 
-    PipelineManager manager(m_progressFd);
+    std::unique_ptr<BasePointTable> table;
+    if (m_columnar)
+        table.reset(new ColumnPointTable);
+    else
+        table.reset(new PointTable);
+    PipelineManager manager(*table, m_progressFd);
 
     manager.readPipeline(m_inputFile);
+    manager.setThreads(m_threads);
+    manager.setTiming(m_timing);
     applyExtraStageOptionsRecursive(manager.getStage());
     manager.execute();
+    if (m_timing)
+        outputTiming(manager.stages());
 
     if (m_pipelineFile.size() > 0)
         PipelineWriter::writePipeline(manager.getStage(), m_pipelineFile);
@@ -65,6 +65,9 @@ private:
     std::string m_PointCloudSchemaOutput;
     std::string m_progressFile;
     int m_progressFd;
+    uint32_t m_threads;
+    bool m_columnar;
+    bool m_timing;
 };
 
 } // pdal
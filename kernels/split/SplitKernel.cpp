@@ -34,9 +34,15 @@
 
 #include "SplitKernel.hpp"
 
+#include <fstream>
+#include <map>
+
 #include <buffer/BufferReader.hpp>
+#include <pdal/Filter.hpp>
+#include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/pdal_macros.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 namespace pdal
 {
@@ -64,6 +70,10 @@ void SplitKernel::addSwitches(ProgramArgs& args)
         std::numeric_limits<double>::quiet_NaN());
     args.add("origin_y", "Origin in Y axis for splitter cells", m_yOrigin,
         std::numeric_limits<double>::quiet_NaN());
+    args.add("memory", "Stream the input and limit buffered points to this "
+        "many megabytes, spilling tiles to temporary files", m_memory, 0u);
+    args.add("temp_dir", "Directory for spill files [default: output "
+        "directory]", m_tempDir);
 }
 
 
@@ -81,6 +91,10 @@ void SplitKernel::validateSwitches(ProgramArgs& args)
         m_capacity = 100000;
     if (m_outputFile.back() == pathSeparator)
         m_outputFile += m_inputFile;
+    if (m_tempDir.empty())
+        m_tempDir = FileUtils::getDirectory(m_outputFile);
+    else if (m_tempDir.back() != pathSeparator)
+        m_tempDir += pathSeparator;
 }
 
 
@@ -95,11 +109,214 @@ std::string makeFilename(const std::string& s, int i)
     out.insert(pos, std::string("_") + std::to_string(i));
     return out;
 }
+
+
+// Routes streamed points to grid cells, buffering the packed points of
+// each cell in memory and appending them to a spill file per cell when
+// the memory allocated to the buffers would exceed the budget.
+class TileSpiller : public Filter
+{
+public:
+    typedef std::pair<int, int> Coord;
+
+    TileSpiller(double length, double xOrigin, double yOrigin,
+            size_t budget, const std::string& spillBase) :
+        m_length(length), m_xOrigin(xOrigin), m_yOrigin(yOrigin),
+        m_budget(budget), m_allocated(0), m_peak(0), m_spillBase(spillBase),
+        m_pointSize(0)
+    {}
+
+    ~TileSpiller()
+    {
+        for (auto& t : m_tiles)
+            if (t.second.m_spilled)
+                FileUtils::deleteFile(spillFilename(t.second.m_num));
+    }
+
+    std::string getName() const
+        { return "split.spiller"; }
+
+    void setLength(double length)
+        { m_length = length; }
+
+    // Cells in the order their first point was encountered, which is
+    // the order in which filters.splitter emits its views.
+    std::vector<Coord> tiles() const
+    {
+        std::vector<Coord> coords(m_tiles.size());
+        for (auto& t : m_tiles)
+            coords[t.second.m_num - 1] = t.first;
+        return coords;
+    }
+
+    // Load the points of a tile into a view and release its storage.
+    // The view's layout must have the dimensions of the streamed layout.
+    void loadTile(const Coord& c, PointView& view)
+    {
+        Tile& tile = m_tiles[c];
+        DimTypeList dims = viewDims(view);
+        std::vector<char> buf(m_pointSize);
+
+        if (tile.m_spilled)
+        {
+            std::string filename(spillFilename(tile.m_num));
+            std::ifstream in(filename, std::ios::binary);
+            while (in.read(buf.data(), m_pointSize))
+                view.setPackedPoint(dims, view.size(), buf.data());
+            in.close();
+            FileUtils::deleteFile(filename);
+            tile.m_spilled = false;
+        }
+        for (size_t pos = 0; pos < tile.m_buf.size(); pos += m_pointSize)
+            view.setPackedPoint(dims, view.size(), tile.m_buf.data() + pos);
+        m_allocated -= tile.m_buf.capacity();
+        std::vector<char>().swap(tile.m_buf);
+    }
+
+private:
+    struct Tile
+    {
+        Tile() : m_num(0), m_spilled(false)
+        {}
+
+        int m_num;
+        bool m_spilled;
+        std::vector<char> m_buf;
+    };
+
+    double m_length;
+    double m_xOrigin;
+    double m_yOrigin;
+    size_t m_budget;
+    size_t m_allocated;  // Capacity of all tile buffers.
+    size_t m_peak;
+    std::string m_spillBase;
+    DimTypeList m_dims;
+    StringList m_names;
+    size_t m_pointSize;
+    std::map<Coord, Tile> m_tiles;
+
+    virtual void ready(PointTableRef table)
+    {
+        PointLayoutPtr layout(table.layout());
+        m_dims = layout->dimTypes();
+        m_names.clear();
+        for (auto& d : m_dims)
+            m_names.push_back(layout->dimName(d.m_id));
+        m_pointSize = layout->pointSize();
+    }
+
+    virtual bool streamable() const
+        { return true; }
+
+    virtual bool processOne(PointRef& point)
+    {
+        double x = point.getFieldAs<double>(Dimension::Id::X);
+        double y = point.getFieldAs<double>(Dimension::Id::Y);
+
+        // Use the location of the first point as the origin, unless
+        // specified, as filters.splitter does.
+        if (m_xOrigin != m_xOrigin)
+            m_xOrigin = x;
+        if (m_yOrigin != m_yOrigin)
+            m_yOrigin = y;
+
+        Coord loc((int)((x - m_xOrigin) / m_length),
+            (int)((y - m_yOrigin) / m_length));
+        auto it = m_tiles.find(loc);
+        if (it == m_tiles.end())
+        {
+            it = m_tiles.insert(std::make_pair(loc, Tile())).first;
+            it->second.m_num = (int)m_tiles.size();
+        }
+        std::vector<char>& buf = it->second.m_buf;
+
+        // Grow the buffer here rather than leaving it to resize(), so that
+        // the spill happens before the allocation would exceed the budget.
+        if (buf.size() + m_pointSize > buf.capacity())
+        {
+            size_t cap = (std::max)(2 * buf.capacity(), m_pointSize);
+            if (m_allocated - buf.capacity() + cap > m_budget)
+            {
+                spill();
+                cap = m_pointSize;
+            }
+            m_allocated -= buf.capacity();
+            buf.reserve(cap);
+            m_allocated += buf.capacity();
+            m_peak = (std::max)(m_peak, m_allocated);
+        }
+        size_t pos = buf.size();
+        buf.resize(pos + m_pointSize);
+        point.getPackedData(m_dims, buf.data() + pos);
+        return true;
+    }
+
+    virtual void done(PointTableRef)
+    {
+        log()->get(LogLevel::Debug) << "Peak tile buffer memory: " <<
+            m_peak << " bytes." << std::endl;
+    }
+
+    // Append all buffered points to the tile spill files.
+    void spill()
+    {
+        for (auto& t : m_tiles)
+        {
+            Tile& tile = t.second;
+            if (tile.m_buf.empty())
+                continue;
+            std::ofstream out(spillFilename(tile.m_num),
+                std::ios::binary | std::ios::app);
+            out.write(tile.m_buf.data(), tile.m_buf.size());
+            if (!out)
+            {
+                std::ostringstream oss;
+                oss << "Unable to write spill file '" <<
+                    spillFilename(tile.m_num) << "'.";
+                throw pdal_error(oss.str());
+            }
+            tile.m_spilled = true;
+            std::vector<char>().swap(tile.m_buf);
+        }
+        m_allocated = 0;
+    }
+
+    std::string spillFilename(int num) const
+        { return m_spillBase + std::to_string(num) + ".spill"; }
+
+    // Dimensions of the streamed layout mapped to a view's layout.
+    DimTypeList viewDims(PointView& view) const
+    {
+        DimTypeList dims;
+        PointLayoutPtr layout(view.layout());
+        for (size_t i = 0; i < m_dims.size(); ++i)
+            dims.push_back(DimType(layout->findDim(m_names[i]),
+                m_dims[i].m_type));
+        return dims;
+    }
+};
+
+} // unnamed namespace
+
+
+void SplitKernel::writeView(PointViewPtr view, PointTableRef table,
+    const std::string& filename)
+{
+    BufferReader reader;
+    reader.addView(view);
+
+    Stage& writer = makeWriter(filename, reader);
+    writer.prepare(table);
+    writer.execute(table);
 }
 
 
 int SplitKernel::execute()
 {
+    if (m_memory)
+        return executeSpilled();
+
     PointTable table;
 
     Options readerOpts;
@@ -142,5 +359,91 @@ int SplitKernel::execute()
     return 0;
 }
 
+
+// Tile without holding the input in memory.  The input is streamed into
+// grid cells that are spilled to disk as the memory budget is reached.
+// Each cell is then loaded into a table of its own and written (splitter
+// mode) or chipped and written (chipper mode).  Chips don't cross the cell
+// boundaries, which are sized so that a cell fits in the budget when the
+// points are evenly distributed.
+int SplitKernel::executeSpilled()
+{
+    FixedPointTable table(10000);
+
+    Options readerOpts;
+    readerOpts.add("filename", m_inputFile);
+    readerOpts.add("debug", isDebug());
+    readerOpts.add("verbose", getVerboseLevel());
+
+    Stage& reader = makeReader(m_inputFile);
+    reader.setOptions(readerOpts);
+
+    size_t budget = (size_t)m_memory * 1024 * 1024;
+    std::string spillBase = m_tempDir +
+        FileUtils::stem(m_outputFile) + "_";
+    TileSpiller spiller(m_length, m_xOrigin, m_yOrigin, budget, spillBase);
+    Options spillerOpts;
+    spillerOpts.add("debug", isDebug());
+    spillerOpts.add("verbose", getVerboseLevel());
+    spiller.setOptions(spillerOpts);
+    spiller.setInput(reader);
+    spiller.prepare(table);
+
+    if (!m_length)
+    {
+        QuickInfo qi = reader.preview();
+        if (!qi.valid() || qi.m_bounds.empty() || qi.m_pointCount == 0)
+            throw pdal_error("Can't determine the bounds of the input to "
+                "partition it for chipping.  Use --length.");
+        point_count_t cellPoints = std::max<point_count_t>(m_capacity,
+            budget / table.layout()->pointSize());
+        double cells = std::ceil((double)qi.m_pointCount / cellPoints);
+        double area = (qi.m_bounds.maxx - qi.m_bounds.minx) *
+            (qi.m_bounds.maxy - qi.m_bounds.miny);
+        double length = std::sqrt(area / cells);
+        spiller.setLength(length > 0 ? length : 1.0);
+    }
+    spiller.execute(table);
+
+    SpatialReference srs = reader.getSpatialReference();
+    int filenum = 1;
+    for (auto& c : spiller.tiles())
+    {
+        PointTable tileTable;
+        PointLayoutPtr layout(tileTable.layout());
+        for (auto& d : table.layout()->dimTypes())
+            layout->registerOrAssignDim(table.layout()->dimName(d.m_id),
+                d.m_type);
+
+        BufferReader bufReader;
+        Stage *last = &bufReader;
+        if (!m_length)
+        {
+            Options chipperOpts;
+            chipperOpts.add("capacity", m_capacity);
+            last = &createStage("filters.chipper");
+            last->setOptions(chipperOpts);
+            last->setInput(bufReader);
+        }
+        last->prepare(tileTable);
+        tileTable.finalize();
+
+        PointViewPtr view(new PointView(tileTable, srs));
+        spiller.loadTile(c, *view);
+        if (m_length)
+            writeView(view, tileTable,
+                makeFilename(m_outputFile, filenum++));
+        else
+        {
+            bufReader.addView(view);
+            PointViewSet chips = last->execute(tileTable);
+            for (auto& chip : chips)
+                writeView(chip, tileTable,
+                    makeFilename(m_outputFile, filenum++));
+        }
+    }
+    return 0;
+}
+
 } // namespace pdal
 
@@ -54,6 +54,9 @@ public:
 private:
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
+    int executeSpilled();
+    void writeView(PointViewPtr view, PointTableRef table,
+        const std::string& filename);
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -61,6 +64,8 @@ private:
     double m_length;
     double m_xOrigin;
     double m_yOrigin;
+    uint32_t m_memory;
+    std::string m_tempDir;
 };
 
 } // namespace pdal
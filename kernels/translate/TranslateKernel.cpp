@@ -74,6 +74,9 @@ TranslateKernel::TranslateKernel()
     , m_pipelineOutput("")
     , m_readerType("")
     , m_writerType("")
+    , m_threads(1)
+    , m_columnar(false)
+    , m_timing(false)
 {}
 
 void TranslateKernel::addSwitches(ProgramArgs& args)
@@ -84,6 +87,12 @@ void TranslateKernel::addSwitches(ProgramArgs& args)
     args.add("pipeline,p", "Pipeline output", m_pipelineOutput);
     args.add("reader,r", "Reader type", m_readerType);
     args.add("writer,w", "Writer type", m_writerType);
+    args.add("threads", "Maximum number of threads used to run point views "
+        "through each stage", m_threads, 1u);
+    args.add("columnar", "Store points in a columnar point table (one array "
+        "per dimension)", m_columnar);
+    args.add("timing", "Report the time, points and memory used by each "
+        "stage", m_timing);
 }
 
 int TranslateKernel::execute()
@@ -95,7 +104,14 @@ int TranslateKernel::execute()
     setCommonOptions(filterOptions);
     setCommonOptions(writerOptions);
 
-    m_manager = std::unique_ptr<PipelineManager>(new PipelineManager);
+    if (m_columnar)
+        m_table.reset(new ColumnPointTable);
+    else
+        m_table.reset(new PointTable);
+    m_manager = std::unique_ptr<PipelineManager>(
+        new PipelineManager(*m_table));
+    m_manager->setThreads(m_threads);
+    m_manager->setTiming(m_timing);
 
     if (!m_readerType.empty())
     {
@@ -179,6 +195,8 @@ int TranslateKernel::execute()
     applyExtraStageOptionsRecursive(writer);
 
     m_manager->execute();
+    if (m_timing)
+        outputTiming(m_manager->stages());
 
     if (m_pipelineOutput.size() > 0)
         PipelineWriter::writePipeline(m_manager->getStage(), m_pipelineOutput);
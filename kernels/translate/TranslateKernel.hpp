@@ -68,7 +68,11 @@ private:
     std::string m_readerType;
     std::vector<std::string> m_filterType;
     std::string m_writerType;
+    uint32_t m_threads;
+    bool m_columnar;
+    bool m_timing;
 
+    std::unique_ptr<BasePointTable> m_table;
     std::unique_ptr<PipelineManager> m_manager;
 };
 
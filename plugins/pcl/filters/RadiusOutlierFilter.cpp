@@ -85,19 +85,13 @@ void RadiusOutlierFilter::addDimensions(PointLayoutPtr layout)
     layout->registerDim(Dimension::Id::Classification);
 }
 
-PointViewSet RadiusOutlierFilter::run(PointViewPtr input)
+// Set up once for all views, since run() may be called for several views
+// concurrently.
+void RadiusOutlierFilter::ready(PointTableRef /*table*/)
 {
     bool logOutput = log()->getLevel() > LogLevel::Debug1;
     if (logOutput)
         log()->floatPrecision(8);
-    log()->get(LogLevel::Debug2) << "Process RadiusOutlierFilter...\n";
-
-    // convert PointView to PointXYZ
-    typedef pcl::PointCloud<pcl::PointXYZ> Cloud;
-    Cloud::Ptr cloud(new Cloud);
-    BOX3D bounds;
-    input->calculateBounds(bounds);
-    pclsupport::PDALtoPCD(input, *cloud, bounds);
 
     // PCL should provide console output at similar verbosity level as PDAL
     int level = log()->getLevel();
@@ -122,6 +116,18 @@ PointViewSet RadiusOutlierFilter::run(PointViewPtr input)
             pcl::console::setVerbosityLevel(pcl::console::L_VERBOSE);
             break;
     }
+}
+
+PointViewSet RadiusOutlierFilter::run(PointViewPtr input)
+{
+    log()->get(LogLevel::Debug2) << "Process RadiusOutlierFilter...\n";
+
+    // convert PointView to PointXYZ
+    typedef pcl::PointCloud<pcl::PointXYZ> Cloud;
+    Cloud::Ptr cloud(new Cloud);
+    BOX3D bounds;
+    input->calculateBounds(bounds);
+    pclsupport::PDALtoPCD(input, *cloud, bounds);
 
     // setup the outlier filter
     pcl::RadiusOutlierRemoval<pcl::PointXYZ> ror(true);
@@ -67,7 +67,10 @@ private:
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void processOptions(const Options& options);
+    virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool threadSafe() const
+        { return true; }
 
     RadiusOutlierFilter& operator=(const RadiusOutlierFilter&); // not implemented
     RadiusOutlierFilter(const RadiusOutlierFilter&); // not implemented
@@ -85,19 +85,14 @@ void StatisticalOutlierFilter::addDimensions(PointLayoutPtr layout)
     layout->registerDim(Dimension::Id::Classification);
 }
 
-PointViewSet StatisticalOutlierFilter::run(PointViewPtr input)
+// Logging and PCL's verbosity are shared by all views, so they're set up
+// once here rather than in run(), which may be called for several views at
+// once (see threadSafe()).
+void StatisticalOutlierFilter::ready(PointTableRef /*table*/)
 {
     bool logOutput = log()->getLevel() > LogLevel::Debug1;
     if (logOutput)
         log()->floatPrecision(8);
-    log()->get(LogLevel::Debug2) << "Process StatisticalOutlierFilter...\n";
-
-    // convert PointView to PointXYZ
-    typedef pcl::PointCloud<pcl::PointXYZ> Cloud;
-    Cloud::Ptr cloud(new Cloud);
-    BOX3D bounds;
-    input->calculateBounds(bounds);
-    pclsupport::PDALtoPCD(input, *cloud, bounds);
 
     // PCL should provide console output at similar verbosity level as PDAL
     int level = log()->getLevel();
@@ -122,6 +117,18 @@ PointViewSet StatisticalOutlierFilter::run(PointViewPtr input)
             pcl::console::setVerbosityLevel(pcl::console::L_VERBOSE);
             break;
     }
+}
+
+PointViewSet StatisticalOutlierFilter::run(PointViewPtr input)
+{
+    log()->get(LogLevel::Debug2) << "Process StatisticalOutlierFilter...\n";
+
+    // convert PointView to PointXYZ
+    typedef pcl::PointCloud<pcl::PointXYZ> Cloud;
+    Cloud::Ptr cloud(new Cloud);
+    BOX3D bounds;
+    input->calculateBounds(bounds);
+    pclsupport::PDALtoPCD(input, *cloud, bounds);
 
     // setup the outlier filter
     pcl::StatisticalOutlierRemoval<pcl::PointXYZ> sor(true);
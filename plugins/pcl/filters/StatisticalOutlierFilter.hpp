@@ -67,7 +67,10 @@ private:
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void processOptions(const Options& options);
+    virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool threadSafe() const
+        { return true; }
 
     StatisticalOutlierFilter& operator=(const StatisticalOutlierFilter&); // not implemented
     StatisticalOutlierFilter(const StatisticalOutlierFilter&); // not implemented
@@ -52,7 +52,8 @@ inline pdal::CompressionType::Enum getCompressionType(
         return CompressionType::Dimensional;
     else if (compression_type == "ght")
         return CompressionType::Ght;
-    else if (compression_type == "laszperf")
+    else if (compression_type == "lazperf" ||
+        compression_type == "laszperf")
         return CompressionType::Lazperf;
     return CompressionType::None;
 }
@@ -35,9 +35,11 @@
 
 #include "PgReader.hpp"
 #include <pdal/PointView.hpp>
+#include <pdal/Polygon.hpp>
 #include <pdal/XMLSchema.hpp>
 #include <pdal/pdal_macros.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 namespace pdal
@@ -53,13 +55,17 @@ CREATE_SHARED_PLUGIN(1, 0, PgReader, Reader, s_info)
 
 std::string PgReader::getName() const { return s_info.name; }
 
-PgReader::PgReader() : m_session(NULL), m_pcid(0), m_cached_point_count(0),
-    m_cached_max_points(0)
+PgReader::PgReader() : m_session(NULL), m_fetchSize(16), m_pcid(0),
+    m_cached_point_count(0), m_cached_max_points(0), m_atEnd(false),
+    m_cursorDone(false), m_curPatch(0)
 {}
 
 
 PgReader::~PgReader()
 {
+    // Let any outstanding fetch finish before closing the session.
+    if (m_nextPatches.valid())
+        m_nextPatches.wait();
     //ABELL - Do bad things happen if we don't do this?  Already in done().
     if (m_session)
         PQfinish(m_session);
@@ -75,6 +81,11 @@ Options PgReader::getDefaultOptions()
     ops.add("schema", "", "Schema to read out of");
     ops.add("column", "", "Column to read out of");
     ops.add("where", "", "SQL where clause to filter query");
+    ops.add("bounds", BOX2D(),
+        "Only read patches that intersect these 2D bounds");
+    ops.add("polygon", "",
+        "Only read patches that intersect this WKT or GeoJSON polygon");
+    ops.add("fetch_size", 16, "Number of patches to fetch per round trip");
     ops.add("spatialreference", "",
         "override the source data spatialreference");
 
@@ -96,6 +107,26 @@ void PgReader::processOptions(const Options& options)
 
     // Read other preferences
     m_where = options.getValueOrDefault<std::string>("where", "");
+    m_bounds = options.getValueOrDefault<BOX2D>("bounds");
+    m_fetchSize = options.getValueOrDefault<point_count_t>("fetch_size", 16);
+    if (m_fetchSize == 0)
+        throw pdal_error("Option 'fetch_size' must be greater than 0.");
+
+    // Normalize GeoJSON or WKT to WKT so that the server can parse it.
+    std::string polygon =
+        options.getValueOrDefault<std::string>("polygon", "");
+    if (polygon.size())
+    {
+        Polygon p(polygon);
+        if (!p.valid())
+        {
+            std::ostringstream oss;
+            oss << getName() << ": invalid 'polygon' option: " <<
+                p.validReason();
+            throw pdal_error(oss.str());
+        }
+        m_polygon = p.wkt(15);
+    }
 
     // Spatial reference.
     setSpatialReference(options.getValueOrDefault<SpatialReference>(
@@ -114,8 +145,7 @@ point_count_t PgReader::getNumPoints() const
     if (m_schema_name.size())
         oss << pg_quote_identifier(m_schema_name) << ".";
     oss << pg_quote_identifier(m_table_name);
-    if (m_where.size())
-        oss << " WHERE " << m_where;
+    oss << whereClause();
 
     PGresult *result = pg_query_result(m_session, oss.str());
 
@@ -132,18 +162,59 @@ point_count_t PgReader::getNumPoints() const
 }
 
 
+// Combine the spatial predicates with the user's where clause.  The
+// predicates are evaluated against the patch envelopes, so whole patches
+// are returned.
+std::string PgReader::whereClause() const
+{
+    std::vector<std::string> predicates;
+    std::string column = pg_quote_identifier(m_column_name);
+
+    if (!m_bounds.empty() || m_polygon.size())
+    {
+        int32_t srid = (std::max)(fetchSrid(), 0);
+
+        std::ostringstream oss;
+        oss.precision(15);
+        if (!m_bounds.empty())
+        {
+            oss << "PC_Intersects(" << column << ", ST_MakeEnvelope(" <<
+                m_bounds.minx << ", " << m_bounds.miny << ", " <<
+                m_bounds.maxx << ", " << m_bounds.maxy << ", " << srid <<
+                "))";
+            predicates.push_back(oss.str());
+            oss.str("");
+        }
+        if (m_polygon.size())
+        {
+            oss << "PC_Intersects(" << column << ", ST_GeomFromText(" <<
+                pg_quote_literal(m_polygon) << ", " << srid << "))";
+            predicates.push_back(oss.str());
+        }
+    }
+    if (m_where.size())
+        predicates.push_back("(" + m_where + ")");
+
+    std::string clause;
+    for (auto& p : predicates)
+        clause += (clause.empty() ? " WHERE " : " AND ") + p;
+    return clause;
+}
+
+
 std::string PgReader::getDataQuery() const
 {
+    // The patch is converted to bytea on the server so that it can be
+    // transferred in binary rather than as hex text.
     std::ostringstream oss;
-    oss << "SELECT text(PC_Uncompress(" << pg_quote_identifier(m_column_name) <<
-        ")) AS pa, ";
+    oss << "SELECT decode(text(PC_Uncompress(" <<
+        pg_quote_identifier(m_column_name) << ")), 'hex') AS pa, ";
     oss << "PC_NumPoints(" << pg_quote_identifier(m_column_name) <<
         ") AS npoints FROM ";
     if (!m_schema_name.empty())
         oss << pg_quote_identifier(m_schema_name) << ".";
     oss << pg_quote_identifier(m_table_name);
-    if (!m_where.empty())
-        oss << " WHERE " << m_where;
+    oss << whereClause();
 
     log()->get(LogLevel::Debug) << "Constructed data query " <<
         oss.str() << std::endl;
@@ -226,9 +297,8 @@ void PgReader::addDimensions(PointLayoutPtr layout)
 }
 
 
-pdal::SpatialReference PgReader::fetchSpatialReference() const
+int32_t PgReader::fetchSrid() const
 {
-    // Fetch the WKT for the SRID to set the coordinate system of this stage
     log()->get(LogLevel::Debug) << "Fetching SRID ..." << std::endl;
 
     uint32_t pcid = fetchPcid();
@@ -241,9 +311,18 @@ pdal::SpatialReference PgReader::fetchSpatialReference() const
         throw pdal_error("Unable to fetch srid for this table and column");
 
     int32_t srid = atoi(srid_str);
+    free(srid_str);
     log()->get(LogLevel::Debug) << "     got SRID = " << srid << std::endl;
+    return srid;
+}
 
-    oss.str("");
+
+pdal::SpatialReference PgReader::fetchSpatialReference() const
+{
+    // Fetch the WKT for the SRID to set the coordinate system of this stage
+    int32_t srid = fetchSrid();
+
+    std::ostringstream oss;
     oss << "EPSG:" << srid;
 
     if (srid >= 0)
@@ -256,9 +335,9 @@ pdal::SpatialReference PgReader::fetchSpatialReference() const
 void PgReader::ready(PointTableRef /*table*/)
 {
     m_atEnd = false;
-    m_cur_row = 0;
-    m_cur_nrows = 0;
-    m_cur_result = NULL;
+    m_cursorDone = false;
+    m_patches.clear();
+    m_curPatch = 0;
 
     CursorSetup();
 }
@@ -266,12 +345,22 @@ void PgReader::ready(PointTableRef /*table*/)
 
 void PgReader::done(PointTableRef /*table*/)
 {
+    // The session can't be used while a fetch is outstanding.
+    if (m_nextPatches.valid())
+    {
+        try
+        {
+            m_nextPatches.get();
+        }
+        catch (const pdal_error&)
+        {}
+    }
+    m_patches.clear();
+
     CursorTeardown();
     if (m_session)
         PQfinish(m_session);
     m_session = NULL;
-    if (m_cur_result)
-        PQclear(m_cur_result);
 }
 
 void PgReader::initialize()
@@ -307,12 +396,14 @@ void PgReader::CursorTeardown()
 
 point_count_t PgReader::readPgPatch(PointViewPtr view, point_count_t numPts)
 {
-    point_count_t numRemaining = m_patch.remaining;
+    Patch& patch = m_patches[m_curPatch];
+    point_count_t numRemaining = patch.remaining;
     PointId nextId = view->size();
     point_count_t numRead = 0;
 
-    size_t offset = (m_patch.count - m_patch.remaining) * packedPointSize();
-    char *pos = (char *)(m_patch.binary.data() + offset);
+    size_t offset = Patch::header +
+        (patch.count - patch.remaining) * packedPointSize();
+    char *pos = (char *)(patch.binary.data() + offset);
 
     while (numRead < numPts && numRemaining > 0)
     {
@@ -322,40 +413,93 @@ point_count_t PgReader::readPgPatch(PointViewPtr view, point_count_t numPts)
         nextId++;
         numRead++;
     }
-    m_patch.remaining = numRemaining;
+    patch.remaining = numRemaining;
     return numRead;
 }
 
 
-bool PgReader::NextBuffer()
+// Fetch the next batch of patches from the cursor.  Results are requested
+// in binary so that patch data arrives as raw bytes.  This runs
+// asynchronously to the reading of the previous batch, so it mustn't touch
+// anything but the session and the new patches.
+PgReader::PatchList PgReader::fetchPatches()
 {
-    if (m_cur_row >= m_cur_nrows || !m_cur_result)
+    std::ostringstream oss;
+    oss << "FETCH " << m_fetchSize << " FROM cur";
+
+    PGresult *result = PQexecParams(m_session, oss.str().c_str(), 0,
+        NULL, NULL, NULL, NULL, 1);
+    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK)
     {
-        static std::string fetch = "FETCH 2 FROM cur";
-        if (m_cur_result)
-            PQclear(m_cur_result);
-        m_cur_result = pg_query_result(m_session, fetch);
-        bool logOutput = (log()->getLevel() > LogLevel::Debug3);
-        if (logOutput)
-            log()->get(LogLevel::Debug3) << "SQL: " << fetch << std::endl;
-        if ((PQresultStatus(m_cur_result) != PGRES_TUPLES_OK) ||
-            (PQntuples(m_cur_result) == 0))
+        std::string errmsg = result ? PQresultErrorMessage(result) :
+            PQerrorMessage(m_session);
+        PQclear(result);
+        throw pdal_error(errmsg);
+    }
+
+    PatchList patches(PQntuples(result));
+    for (size_t i = 0; i < patches.size(); ++i)
+    {
+        Patch& patch = patches[i];
+
+        // int4 in binary format is in network byte order.
+        const uint8_t *n = (const uint8_t *)PQgetvalue(result, (int)i, 1);
+        patch.count = ((uint32_t)n[0] << 24) | ((uint32_t)n[1] << 16) |
+            ((uint32_t)n[2] << 8) | n[3];
+        patch.remaining = patch.count;
+
+        const uint8_t *data = (const uint8_t *)PQgetvalue(result, (int)i, 0);
+        size_t size = PQgetlength(result, (int)i, 0);
+        if (size < Patch::header + patch.count * packedPointSize())
         {
-            PQclear(m_cur_result);
-            m_cur_result = NULL;
-            m_atEnd = true;
-            return false;
+            PQclear(result);
+            throw pdal_error("Patch data is shorter than its point count "
+                "requires.");
         }
+        patch.binary.assign(data, data + size);
+    }
+    PQclear(result);
+    return patches;
+}
 
-        m_cur_row = 0;
-        m_cur_nrows = PQntuples(m_cur_result);
+
+bool PgReader::NextBuffer()
+{
+    if (m_curPatch + 1 < m_patches.size())
+    {
+        m_curPatch++;
+        return true;
+    }
+
+    if (m_cursorDone)
+    {
+        m_atEnd = true;
+        return false;
     }
-    m_patch.hex = PQgetvalue(m_cur_result, m_cur_row, 0);
-    m_patch.count = atoi(PQgetvalue(m_cur_result, m_cur_row, 1));
-    m_patch.remaining = m_patch.count;
-    m_patch.update_binary();
 
-    m_cur_row++;
+    bool logOutput = (log()->getLevel() > LogLevel::Debug3);
+    if (logOutput)
+        log()->get(LogLevel::Debug3) << "SQL: FETCH " << m_fetchSize <<
+            " FROM cur" << std::endl;
+
+    if (m_nextPatches.valid())
+        m_patches = m_nextPatches.get();
+    else
+        m_patches = fetchPatches();
+    m_curPatch = 0;
+
+    // A short batch means the cursor is exhausted.
+    if (m_patches.size() < m_fetchSize)
+        m_cursorDone = true;
+    else
+        m_nextPatches = std::async(std::launch::async,
+            &PgReader::fetchPatches, this);
+
+    if (m_patches.empty())
+    {
+        m_atEnd = true;
+        return false;
+    }
     return true;
 }
 
@@ -372,13 +516,10 @@ point_count_t PgReader::read(PointViewPtr view, point_count_t count)
     point_count_t totalNumRead = 0;
     while (totalNumRead < count)
     {
-        if (m_patch.remaining == 0)
+        if (m_patches.empty() || m_patches[m_curPatch].remaining == 0)
             if (!NextBuffer())
                 return totalNumRead;
-        PointId bufBegin = view->size();
-        point_count_t numRead = readPgPatch(view, count - totalNumRead);
-        PointId bufEnd = bufBegin + numRead;
-        totalNumRead += numRead;
+        totalNumRead += readPgPatch(view, count - totalNumRead);
     }
     return totalNumRead;
 }
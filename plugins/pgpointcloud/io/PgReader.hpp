@@ -41,6 +41,7 @@
 
 #include "PgCommon.hpp"
 
+#include <future>
 #include <vector>
 
 namespace pdal
@@ -56,30 +57,13 @@ class PDAL_DLL PgReader : public DbReader
 
         point_count_t count;
         point_count_t remaining;
-        std::string hex;
-
         std::vector<uint8_t> binary;
-        static const uint32_t trim = 26;
-
-#define _base(x) ((x >= '0' && x <= '9') ? '0' : \
-             (x >= 'a' && x <= 'f') ? 'a' - 10 : \
-             (x >= 'A' && x <= 'F') ? 'A' - 10 : \
-                '\255')
-#define HEXOF(x) (x - _base(x))
-
-        inline void update_binary()
-        {
-            // http://stackoverflow.com/questions/8197838/convert-a-long-hex-string-in-to-int-array-with-sscanf
-            binary.resize((hex.size() - trim)/2);
-
-            char const* source = hex.c_str() + trim;
-            char const* p = 0;
-
-            for (p = source; p && *p; p += 2)
-                binary[(p - source) >> 1] =
-                    ((HEXOF(*p)) << 4) + HEXOF(*(p + 1));
-        }
+
+        // Size of the serialized patch header (endian flag, pcid,
+        // compression and point count) that precedes the point data.
+        static const uint32_t header = 13;
     };
+    typedef std::vector<Patch> PatchList;
 
 public:
     PgReader();
@@ -108,6 +92,8 @@ private:
         { return m_atEnd; }
 
     SpatialReference fetchSpatialReference() const;
+    int32_t fetchSrid() const;
+    std::string whereClause() const;
     uint32_t fetchPcid() const;
     point_count_t readPgPatch(PointViewPtr view, point_count_t numPts);
 
@@ -115,6 +101,7 @@ private:
     void CursorSetup();
     void CursorTeardown();
     bool NextBuffer();
+    PatchList fetchPatches();
 
     PGconn* m_session;
     std::string m_connection;
@@ -122,15 +109,18 @@ private:
     std::string m_schema_name;
     std::string m_column_name;
     std::string m_where;
+    BOX2D m_bounds;
+    std::string m_polygon;
+    point_count_t m_fetchSize;
     mutable uint32_t m_pcid;
     mutable point_count_t m_cached_point_count;
     mutable point_count_t m_cached_max_points;
 
     bool m_atEnd;
-    uint32_t m_cur_row;
-    uint32_t m_cur_nrows;
-    PGresult* m_cur_result;
-    Patch m_patch;
+    bool m_cursorDone;
+    PatchList m_patches;
+    size_t m_curPatch;
+    std::future<PatchList> m_nextPatches;
 
     PgReader& operator=(const PgReader&); // not implemented
     PgReader(const PgReader&); // not implemented
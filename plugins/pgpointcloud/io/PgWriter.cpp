@@ -42,6 +42,8 @@
 #include <pdal/XMLSchema.hpp>
 #include <pdal/pdal_macros.hpp>
 
+#include <zlib.h>
+
 namespace pdal
 {
 
@@ -55,8 +57,6 @@ CREATE_SHARED_PLUGIN(1, 0, PgWriter, Writer, s_info)
 std::string PgWriter::getName() const { return s_info.name; }
 
 // TO DO:
-// - change INSERT into COPY
-//
 // - PCID / Schema consistency. If a PCID is specified,
 // must it be consistent with the buffer schema? Or should
 // the writer shove the data into the database schema as best
@@ -72,12 +72,16 @@ PgWriter::PgWriter()
     , m_srid(0)
     , m_pcid(0)
     , m_overwrite(true)
+    , m_copying(false)
     , m_schema_is_initialized(false)
 {}
 
 
 PgWriter::~PgWriter()
 {
+    // The session can't be closed while a patch is being sent.
+    if (m_sending.valid())
+        m_sending.wait();
     if (m_session)
         PQfinish(m_session);
 }
@@ -96,6 +100,11 @@ void PgWriter::processOptions(const Options& options)
     std::string compression_str =
         options.getValueOrDefault<std::string>("compression", "dimensional");
     m_patch_compression_type = getCompressionType(compression_str);
+#ifndef PDAL_HAVE_LAZPERF
+    if (m_patch_compression_type == CompressionType::Lazperf)
+        throw pdal_error("Can't write LAZperf compressed patches.  "
+            "PDAL not built with LAZperf.");
+#endif
 
     // Connection string needs to exist and actually work
     m_connection = options.getValueOrThrow<std::string>("connection");
@@ -133,7 +142,7 @@ Options PgWriter::getDefaultOptions()
     Option schema("schema", "", "schema table resides in");
     Option column("column", "", "column to write to");
     Option compression("compression", "dimensional",
-        "patch compression format to use (none, dimensional, ght)");
+        "patch compression format to use (none, dimensional, ght, lazperf)");
     Option overwrite("overwrite", true, "replace any existing table");
     Option srid("srid", 4326, "spatial reference id to store data in");
     Option pcid("pcid", 0, "use this existing pointcloud schema id, if it "
@@ -211,6 +220,9 @@ void PgWriter::done(PointTableRef /*table*/)
 {
     //CreateIndex(m_schema_name, m_table_name, m_column_name);
 
+    if (m_copying)
+        endCopy();
+
     if (m_post_sql.size())
     {
         std::string sql = FileUtils::readFileIntoString(m_post_sql);
@@ -274,6 +286,8 @@ uint32_t PgWriter::SetupSchema(uint32_t srid)
         compression = "dimensional";
     else if (m_patch_compression_type == CompressionType::Ght)
         compression = "ght";
+    else if (m_patch_compression_type == CompressionType::Lazperf)
+        compression = "lazperf";
 
     Metadata metadata;
     MetadataNode m = metadata.getNode();
@@ -465,71 +479,256 @@ void PgWriter::CreateIndex(std::string const& schema_name,
 }
 
 
-void PgWriter::writeTile(const PointViewPtr view)
+// Patches are loaded with COPY in text format.  pcpatch has no binary
+// receive function, so each row is the hex WKB of a patch, the same as is
+// accepted by INSERT.
+void PgWriter::startCopy()
+{
+    std::ostringstream oss;
+    oss << "COPY ";
+    if (m_schema_name.size())
+        oss << pg_quote_identifier(m_schema_name) << ".";
+    oss << pg_quote_identifier(m_table_name);
+    oss << " (" << pg_quote_identifier(m_column_name) << ") FROM STDIN";
+
+    PGresult *result = PQexec(m_session, oss.str().c_str());
+    if (!result || PQresultStatus(result) != PGRES_COPY_IN)
+    {
+        std::string errmsg(PQerrorMessage(m_session));
+        PQclear(result);
+        throw pdal_error(errmsg);
+    }
+    PQclear(result);
+    m_copying = true;
+}
+
+
+void PgWriter::sendCopyData(const std::string& data)
+{
+    if (PQputCopyData(m_session, data.data(), (int)data.size()) != 1)
+        throw pdal_error(PQerrorMessage(m_session));
+}
+
+
+// Wait for the previous patch to be sent, rethrowing any error.
+void PgWriter::waitForSend()
+{
+    if (m_sending.valid())
+        m_sending.get();
+}
+
+
+void PgWriter::endCopy()
 {
-    std::vector<char> storage(packedPointSize());
-    std::string hexrep;
-    size_t maxHexrepSize = packedPointSize() * view->size() * 2;
-    hexrep.reserve(maxHexrepSize);
+    waitForSend();
+    m_copying = false;
 
-    m_insert.clear();
-    m_insert.reserve(maxHexrepSize + 3000);
+    if (PQputCopyEnd(m_session, NULL) != 1)
+        throw pdal_error(PQerrorMessage(m_session));
 
-    for (PointId idx = 0; idx < view->size(); ++idx)
+    std::string errmsg;
+    PGresult *result;
+    while ((result = PQgetResult(m_session)))
     {
-        size_t size = readPoint(*view.get(), idx, storage.data());
+        if (PQresultStatus(result) != PGRES_COMMAND_OK && errmsg.empty())
+            errmsg = PQresultErrorMessage(result);
+        PQclear(result);
+    }
+    if (errmsg.size())
+        throw pdal_error(errmsg);
+}
+
+
+// Encoding of a patch happens while the previous one is being sent.
+void PgWriter::writeTile(const PointViewPtr view)
+{
+    if (view->empty())
+        return;
+
+    if (!m_copying)
+        startCopy();
+
+    encodePatch(*view, m_encodeBuf);
+
+    waitForSend();
+    std::swap(m_encodeBuf, m_sendBuf);
+    m_sending = std::async(std::launch::async,
+        &PgWriter::sendCopyData, this, std::cref(m_sendBuf));
+}
+
+
+namespace
+{
+
+// Dimension compression types understood by pgpointcloud.
+enum DimCompression
+{
+    DimNone = 0,
+    DimRle = 1,
+    DimZlib = 3
+};
 
-        /* We are always getting uncompressed bytes off the block_data */
-        /* so we always used compression type 0 (uncompressed) in writing */
-        /* our WKB */
-        static char syms[] = "0123456789ABCDEF";
-        for (size_t i = 0; i != size; i++)
+
+// Run-length encode values of 'size' bytes as (run length, value) pairs.
+void encodeRle(const std::vector<uint8_t>& in, size_t size,
+    std::vector<uint8_t>& out)
+{
+    out.clear();
+    const uint8_t *pos = in.data();
+    const uint8_t *end = pos + in.size();
+    while (pos < end)
+    {
+        const uint8_t *run = pos + size;
+        uint8_t count = 1;
+        while (run < end && count < 255 && memcmp(run, pos, size) == 0)
         {
-            hexrep.push_back(syms[((storage[i] >> 4) & 0xf)]);
-            hexrep.push_back(syms[storage[i] & 0xf]);
+            run += size;
+            count++;
         }
+        out.push_back(count);
+        out.insert(out.end(), pos, pos + size);
+        pos = run;
     }
+}
 
-    std::string insert_into("INSERT INTO ");
-    std::string values(" (" + pg_quote_identifier(m_column_name) +
-                       ") VALUES ('");
 
-    m_insert.append(insert_into);
+bool encodeZlib(const std::vector<uint8_t>& in, std::vector<uint8_t>& out)
+{
+    uLongf size = compressBound(in.size());
+    out.resize(size);
+    if (compress2(out.data(), &size, in.data(), in.size(),
+            Z_DEFAULT_COMPRESSION) != Z_OK)
+        return false;
+    out.resize(size);
+    return true;
+}
 
-    if (m_schema_name.size())
-    {
-        m_insert.append(pg_quote_identifier(m_schema_name));
-        m_insert.append(".");
-    }
 
-    m_insert.append(pg_quote_identifier(m_table_name));
-    m_insert.append(values);
+template<typename T>
+void append(std::vector<uint8_t>& buf, T t)
+{
+    const uint8_t *b = (const uint8_t *)&t;
+    buf.insert(buf.end(), b, b + sizeof(T));
+}
 
-    std::ostringstream options;
+} // unnamed namespace
 
-    uint32_t num_points = htobe32(view->size());
-    int32_t pcid = htobe32(m_pcid);
-    CompressionType::Enum compression_v = CompressionType::None;
-    uint32_t compression = htobe32(static_cast<uint32_t>(compression_v));
 
+// Write the patch in the serialized form of a pcpatch (see
+// pc_patch_*_to_wkb in pgpointcloud) and hex-encode it as a COPY row.
+// The header values are in machine order, flagged by the first byte.
+void PgWriter::encodePatch(const PointView& view, std::string& row)
+{
+    point_count_t count = view.size();
+
+    std::vector<char> points(count * packedPointSize());
+    char *pos = points.data();
+    for (PointId idx = 0; idx < count; ++idx)
+        pos += readPoint(view, idx, pos);
+    points.resize(pos - points.data());
+
+    // GHT compression isn't supported on the client.  The database
+    // compresses the patch according to the schema.
+    CompressionType::Enum compression = m_patch_compression_type;
+    if (compression == CompressionType::Ght)
+        compression = CompressionType::None;
+
+    std::vector<uint8_t> wkb;
+    wkb.reserve(13 + points.size());
 #if BYTE_ORDER == LITTLE_ENDIAN
-    options << "01";
+    append<uint8_t>(wkb, 1);
 #elif BYTE_ORDER == BIG_ENDIAN
-    options << "00";
+    append<uint8_t>(wkb, 0);
 #endif
+    append<uint32_t>(wkb, m_pcid);
+    append<uint32_t>(wkb, compression);
+    append<uint32_t>(wkb, (uint32_t)count);
+
+    if (compression == CompressionType::Dimensional)
+        encodeDimensional(points, count, wkb);
+    else if (compression == CompressionType::Lazperf)
+        encodeLazperf(points, wkb);
+    else
+        wkb.insert(wkb.end(), points.begin(), points.end());
+
+    static const char syms[] = "0123456789ABCDEF";
+    row.resize(wkb.size() * 2 + 1);
+    char *out = &row[0];
+    for (uint8_t b : wkb)
+    {
+        *out++ = syms[b >> 4];
+        *out++ = syms[b & 0xf];
+    }
+    *out = '\n';
+}
 
-    // needs to be 4 bytes
-    options << std::hex << std::setfill('0') << std::setw(8) << pcid;
-    // needs to be 4 bytes
-    options << std::hex << std::setfill('0') << std::setw(8) << compression;
-    // needs to be 4 bytes
-    options << std::hex << std::setfill('0') << std::setw(8) << num_points;
 
-    m_insert.append(options.str());
-    m_insert.append(hexrep);
-    m_insert.append("')");
+// Write each dimension separately, using whichever of run-length, zlib
+// or no compression gives the smallest result.
+void PgWriter::encodeDimensional(const std::vector<char>& points,
+    point_count_t count, std::vector<uint8_t>& wkb)
+{
+    XMLDimList dims = dbDimTypes();
+    size_t pointSize = points.size() / count;
+
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> rle;
+    std::vector<uint8_t> zlib;
+    size_t offset = 0;
+    for (auto& dim : dims)
+    {
+        size_t size = Dimension::size(dim.m_dimType.m_type);
+
+        raw.resize(count * size);
+        const char *in = points.data() + offset;
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            memcpy(raw.data() + i * size, in, size);
+            in += pointSize;
+        }
+        offset += size;
 
-    pg_execute(m_session, m_insert);
+        const std::vector<uint8_t> *best = &raw;
+        uint8_t type = DimNone;
+        encodeRle(raw, size, rle);
+        if (rle.size() < best->size())
+        {
+            best = &rle;
+            type = DimRle;
+        }
+        if (encodeZlib(raw, zlib) && zlib.size() < best->size())
+        {
+            best = &zlib;
+            type = DimZlib;
+        }
+
+        append<uint8_t>(wkb, type);
+        append<uint32_t>(wkb, (uint32_t)best->size());
+        wkb.insert(wkb.end(), best->begin(), best->end());
+    }
+}
+
+
+void PgWriter::encodeLazperf(const std::vector<char>& points,
+    std::vector<uint8_t>& wkb)
+{
+#ifdef PDAL_HAVE_LAZPERF
+    DimTypeList dimTypes;
+    for (auto& dim : dbDimTypes())
+        dimTypes.push_back(dim.m_dimType);
+
+    std::vector<unsigned char> compressed;
+    LazPerfBuf buf(compressed);
+    LazPerfCompressor<LazPerfBuf> compressor(buf, dimTypes);
+    compressor.compress(points.data(), points.size());
+    compressor.done();
+
+    append<uint32_t>(wkb, (uint32_t)compressed.size());
+    wkb.insert(wkb.end(), compressed.begin(), compressed.end());
+#else
+    (void)points;
+    (void)wkb;
+#endif
 }
 
 } // namespace pdal
@@ -39,6 +39,8 @@
 #include <pdal/StageFactory.hpp>
 #include "PgCommon.hpp"
 
+#include <future>
+
 namespace pdal
 {
 
@@ -67,6 +69,16 @@ private:
 
     void writeInit();
     void writeTile(const PointViewPtr view);
+    void encodePatch(const PointView& view, std::string& row);
+    void encodeDimensional(const std::vector<char>& points,
+        point_count_t count, std::vector<uint8_t>& wkb);
+    void encodeLazperf(const std::vector<char>& points,
+        std::vector<uint8_t>& wkb);
+
+    void startCopy();
+    void sendCopyData(const std::string& data);
+    void waitForSend();
+    void endCopy();
 
     bool CheckTableExists(std::string const& name);
     bool CheckPointCloudExists();
@@ -97,7 +109,10 @@ private:
     uint32_t m_srid;
     uint32_t m_pcid;
     bool m_overwrite;
-    std::string m_insert;
+    bool m_copying;
+    std::string m_encodeBuf;
+    std::string m_sendBuf;
+    std::future<void> m_sending;
     Orientation::Enum m_orientation;
     std::string m_pre_sql;
     std::string m_post_sql;
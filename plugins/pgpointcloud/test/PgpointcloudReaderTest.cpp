@@ -0,0 +1,316 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <tuple>
+
+#include <pdal/StageFactory.hpp>
+
+#include "Support.hpp"
+#include "Pgtest-Support.hpp"
+#include "../io/PgCommon.hpp"
+
+using namespace pdal;
+
+namespace { // anonymous
+
+std::string getTestConnBase()
+{
+    std::string s;
+    if ( ! testDbPort.empty() )
+        s += " port='" + testDbPort + "'";
+    if ( ! testDbHost.empty() )
+        s += " host='" + testDbHost + "'";
+    if ( ! testDbUser.empty() )
+        s += " user='" + testDbUser + "'";
+    return s;
+}
+
+
+std::string getConnectionString(const std::string& dbname)
+{
+    return getTestConnBase() + " dbname='" + dbname + "'";
+}
+
+
+std::string getTestDBTempConn()
+{
+    return getConnectionString(testDbTempname);
+}
+
+std::string getMasterDBConn()
+{
+    return getConnectionString(testDbName);
+}
+
+} // anonymous namespace
+
+Options getDbOptions()
+{
+    Options options;
+
+    options.add(Option("connection", getTestDBTempConn()));
+    options.add(Option("table", "4dal-\"test\"-table")); // intentional quotes
+    options.add(Option("column", "p\"a")); // intentional quotes
+    options.add(Option("srid", "4326"));
+    options.add(Option("capacity", "10000"));
+
+    return options;
+}
+
+class PgpointcloudReaderTest : public testing::Test
+{
+public:
+    PgpointcloudReaderTest() : m_masterConnection(0), m_testConnection(0),
+                               m_bSkipTests(false) {};
+protected:
+    virtual void SetUp()
+    {
+        std::string connstr = getMasterDBConn();
+        m_masterConnection = pg_connect( connstr );
+        m_testConnection = NULL;
+
+        // Silence those pesky notices
+        executeOnMasterDb("SET client_min_messages TO WARNING");
+
+        dropTestDb();
+
+        std::stringstream createDbSql;
+        createDbSql << "CREATE DATABASE " <<
+            testDbTempname << " TEMPLATE template0";
+        try
+        {
+            executeOnMasterDb(createDbSql.str());
+        }
+        catch( const pdal_error& error )
+        {
+            m_bSkipTests = true;
+            return;
+        }
+
+        m_testConnection = pg_connect( getTestDBTempConn() );
+
+        try
+        {
+            executeOnTestDb("CREATE EXTENSION pointcloud");
+        }
+        catch( const pdal_error& error )
+        {
+            m_bSkipTests = true;
+            return;
+        }
+    }
+
+    void executeOnTestDb(const std::string& sql)
+    {
+        pg_execute(m_testConnection, sql);
+    }
+
+    virtual void TearDown()
+    {
+        if (!m_testConnection || !m_masterConnection) return;
+        if (m_testConnection)
+        {
+            PQfinish(m_testConnection);
+        }
+        dropTestDb();
+        if (m_masterConnection)
+        {
+            PQfinish(m_masterConnection);
+        }
+    }
+
+    bool shouldSkipTests() const { return m_bSkipTests; }
+
+private:
+
+    void executeOnMasterDb(const std::string& sql)
+    {
+        pg_execute(m_masterConnection, sql);
+    }
+
+    void execute(PGconn* connection, const std::string& sql)
+    {
+        pg_execute(connection, sql);
+    }
+
+    void dropTestDb()
+    {
+        std::stringstream dropDbSql;
+        dropDbSql << "DROP DATABASE IF EXISTS " << testDbTempname;
+        executeOnMasterDb(dropDbSql.str());
+    }
+
+    PGconn* m_masterConnection;
+    PGconn* m_testConnection;
+    bool m_bSkipTests;
+};
+
+namespace
+{
+
+// Write the test file, split by the chipper into patches of 'capacity'
+// points, so that reads span several patches.
+void writePatches(point_count_t capacity)
+{
+    StageFactory f;
+    Stage* reader(f.createStage("readers.las"));
+    Stage* chipper(f.createStage("filters.chipper"));
+    Stage* writer(f.createStage("writers.pgpointcloud"));
+
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/1.2-with-color.las"));
+    reader->setOptions(readerOps);
+
+    Options chipperOps;
+    chipperOps.add("capacity", capacity);
+    chipper->setOptions(chipperOps);
+    chipper->setInput(*reader);
+
+    writer->setOptions(getDbOptions());
+    writer->setInput(*chipper);
+
+    PointTable table;
+    writer->prepare(table);
+    PointViewSet written = writer->execute(table);
+
+    point_count_t count(0);
+    for (auto& v : written)
+        count += v->size();
+    EXPECT_GT(written.size(), 1U);
+    EXPECT_EQ(count, 1065U);
+}
+
+
+typedef std::tuple<double, double, double> Xyz;
+
+// Collect the coordinates of the points of a view, sorted, since the order
+// of the patches returned by the database isn't defined.
+std::vector<Xyz> sortedPoints(const PointView& view)
+{
+    std::vector<Xyz> points;
+    for (PointId idx = 0; idx < view.size(); ++idx)
+        points.push_back(Xyz(
+            view.getFieldAs<double>(Dimension::Id::X, idx),
+            view.getFieldAs<double>(Dimension::Id::Y, idx),
+            view.getFieldAs<double>(Dimension::Id::Z, idx)));
+    std::sort(points.begin(), points.end());
+    return points;
+}
+
+
+std::vector<Xyz> readPoints(const Options& extra)
+{
+    StageFactory factory;
+    Stage* reader(factory.createStage("readers.pgpointcloud"));
+    Options ops = getDbOptions();
+    for (auto& o : extra.getOptions())
+        ops.add(o);
+    reader->setOptions(ops);
+
+    PointTable table;
+    reader->prepare(table);
+    PointViewSet viewSet = reader->execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    return sortedPoints(**viewSet.begin());
+}
+
+
+std::vector<Xyz> fileXyz()
+{
+    StageFactory factory;
+    Stage* reader(factory.createStage("readers.las"));
+    Options ops;
+    ops.add("filename", Support::datapath("las/1.2-with-color.las"));
+    reader->setOptions(ops);
+
+    PointTable table;
+    reader->prepare(table);
+    PointViewSet viewSet = reader->execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    return sortedPoints(**viewSet.begin());
+}
+
+} // unnamed namespace
+
+TEST_F(PgpointcloudReaderTest, fetchBatches)
+{
+    if (shouldSkipTests())
+    {
+        return;
+    }
+
+    // 50 point patches give 22 patches.  Fetching one or three patches at
+    // a time reads many batches, each after the first fetched in the
+    // background while the previous one is read.  A fetch size larger
+    // than the number of patches reads everything in one batch.
+    writePatches(50);
+
+    std::vector<Xyz> expected = fileXyz();
+    ASSERT_EQ(expected.size(), 1065u);
+    for (int fetchSize : { 1, 3, 1000 })
+    {
+        Options ops;
+        ops.add("fetch_size", fetchSize);
+        EXPECT_TRUE(readPoints(ops) == expected) << "fetch_size " <<
+            fetchSize;
+    }
+}
+
+TEST_F(PgpointcloudReaderTest, readBounds)
+{
+    if (shouldSkipTests())
+    {
+        return;
+    }
+
+    writePatches(50);
+
+    Options all;
+    all.add("fetch_size", 3);
+    all.add("bounds", BOX2D(635000, 848000, 639000, 854000));
+    EXPECT_EQ(readPoints(all).size(), 1065u);
+
+    Options none;
+    none.add("fetch_size", 3);
+    none.add("bounds", BOX2D(0, 0, 10, 10));
+    EXPECT_EQ(readPoints(none).size(), 0u);
+
+    Options poly;
+    poly.add("fetch_size", 3);
+    poly.add("polygon", "POLYGON ((0 0, 10 0, 10 10, 0 10, 0 0))");
+    EXPECT_EQ(readPoints(poly).size(), 0u);
+}
@@ -293,3 +293,36 @@ TEST_F(PgpointcloudWriterTest, writetNoPointcloudExtension)
 
     EXPECT_THROW(writer->execute(table), pdal_error);
 }
+
+TEST_F(PgpointcloudWriterTest, writeCompressed)
+{
+    if (shouldSkipTests())
+    {
+        return;
+    }
+
+    std::vector<std::string> types { "none", "dimensional" };
+#ifdef PDAL_HAVE_LAZPERF
+    types.push_back("lazperf");
+#endif
+    for (auto& type : types)
+    {
+        Options ops = getDbOptions();
+        ops.add("compression", type);
+        ops.add("scale_x", .01);
+        ops.add("scale_y", .01);
+        ops.add("scale_z", .01);
+        optionsWrite(ops);
+
+        StageFactory factory;
+        Stage* reader(factory.createStage("readers.pgpointcloud"));
+        reader->setOptions(getDbOptions());
+
+        PointTable table;
+        reader->prepare(table);
+        PointViewSet viewSet = reader->execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        EXPECT_EQ((*viewSet.begin())->size(), 1065u) << "compression " <<
+            type;
+    }
+}
@@ -99,9 +99,7 @@ public:
     size_t idx;
 
     void putBytes(const unsigned char* b, size_t len) {
-        while(len --) {
-            buf.push_back(*b++);
-        }
+        buf.insert(buf.end(), b, b + len);
     }
 
     void putByte(const unsigned char b) {
@@ -113,13 +111,21 @@ public:
     }
 
     void getBytes(unsigned char *b, int len) {
-        for (int i = 0 ; i < len ; i ++) {
-            b[i] = getByte();
-        }
+        memcpy(b, buf.data() + idx, len);
+        idx += len;
     }
 
     void setBytes(const std::vector<uint8_t>& data)
-        { buf = data; }
+    {
+        buf = data;
+        idx = 0;
+    }
+
+    void clear()
+    {
+        buf.clear();
+        idx = 0;
+    }
 
     const std::vector<uint8_t>& getBytes() const
         { return buf; }
@@ -150,6 +156,8 @@ public:
 
     ~SQLite()
     {
+        for (auto& p : m_prepared)
+            sqlite3_finalize(p.second);
 
         if (m_session)
         {
@@ -374,6 +382,8 @@ public:
         return (int64_t)sqlite3_last_insert_rowid(m_session);
     }
 
+    // Prepared statements are cached by their SQL text and reused by
+    // subsequent inserts until the session is closed.
     void insert(std::string const& statement, records const& rs)
     {
         checkSession();
@@ -383,14 +393,22 @@ public:
         records::size_type rows = rs.size();
 
         assert(!m_statement);
-        status = sqlite3_prepare_v2(m_session,
-                                    statement.c_str(),
-                                    static_cast<int>(statement.size()),
-                                    &m_statement,
-                                    0);
-        if (status != SQLITE_OK)
+        auto pi = m_prepared.find(statement);
+        if (pi != m_prepared.end())
+            m_statement = pi->second;
+        else
         {
-            error("insert preparation failed", "insert");
+            status = sqlite3_prepare_v2(m_session,
+                                        statement.c_str(),
+                                        static_cast<int>(statement.size()),
+                                        &m_statement,
+                                        0);
+            if (status != SQLITE_OK)
+            {
+                m_statement = NULL;
+                error("insert preparation failed", "insert");
+            }
+            m_prepared[statement] = m_statement;
         }
 
         m_log->get(LogLevel::Debug3) << "Inserting '" << statement << "'"<<
@@ -423,6 +441,8 @@ public:
 
                 if (SQLITE_OK != status)
                 {
+                    sqlite3_clear_bindings(m_statement);
+                    m_statement = NULL;
                     std::ostringstream oss;
                     oss << "insert bind failed (row=" << r
                         <<", position=" << pos
@@ -432,19 +452,17 @@ public:
             }
 
             status = sqlite3_step(m_statement);
+            sqlite3_reset(m_statement);
 
             if (status != SQLITE_DONE && status != SQLITE_ROW)
             {
+                m_statement = NULL;
                 error("insert step failed", "insert");
             }
         }
 
-        status = sqlite3_finalize(m_statement);
-        if (status != SQLITE_OK)
-        {
-            error("insert finalize failed", "insert");
-        }
-
+        // Release the bound values, which may point into 'rs'.
+        sqlite3_clear_bindings(m_statement);
         m_statement = NULL;
     }
 
@@ -550,6 +568,7 @@ private:
     std::string m_connection;
     sqlite3* m_session;
     sqlite3_stmt* m_statement;
+    std::map<std::string, sqlite3_stmt*> m_prepared;
     records m_data;
     records::size_type m_position;
     std::map<std::string, int32_t> m_columns;
@@ -34,8 +34,11 @@
 
 #include "SQLiteReader.hpp"
 #include <pdal/PointView.hpp>
+#include <pdal/Polygon.hpp>
 #include <pdal/pdal_macros.hpp>
 
+#include <iomanip>
+
 namespace pdal
 {
 
@@ -93,9 +96,26 @@ Options SQLiteReader::getDefaultOptions()
         "Connection string to connect to database");
     Option query("query", "",
         "SELECT statement that returns point cloud");
+    Option blockTable("block_table_name", "",
+        "Table of point blocks, used to select blocks by area");
+    Option cloudTable("cloud_table_name", "",
+        "Table of point clouds, used with 'block_table_name' when no "
+        "'query' is given");
+    Option cloudColumn("cloud_column_name", "id",
+        "Column that relates blocks to their point cloud");
+    Option bounds("bounds", BOX2D(),
+        "Only read blocks whose extents intersect these 2D bounds");
+    Option polygon("polygon", "",
+        "Only read blocks whose extents intersect the bounding box of "
+        "this WKT or GeoJSON polygon");
 
     options.add(connection);
     options.add(query);
+    options.add(blockTable);
+    options.add(cloudTable);
+    options.add(cloudColumn);
+    options.add(bounds);
+    options.add(polygon);
 
     return options;
 }
@@ -141,9 +161,97 @@ void SQLiteReader::processOptions(const Options& options)
 
     m_spatialRef =
         options.getValueOrDefault<pdal::SpatialReference>( "spatialreference");
-    m_query = options.getValueOrThrow<std::string>("query");
     m_connection = options.getValueOrDefault<std::string>("connection", "");
     m_modulename = options.getValueOrDefault<std::string>("module", "");
+    m_blockTable = Utils::tolower(
+        options.getValueOrDefault<std::string>("block_table_name", ""));
+    m_cloudTable = Utils::tolower(
+        options.getValueOrDefault<std::string>("cloud_table_name", ""));
+    m_cloudColumn = Utils::tolower(
+        options.getValueOrDefault<std::string>("cloud_column_name", "id"));
+
+    m_areas.clear();
+    BOX2D bounds = options.getValueOrDefault<BOX2D>("bounds");
+    if (!bounds.empty())
+        m_areas.push_back(bounds);
+    std::string polygon =
+        options.getValueOrDefault<std::string>("polygon", "");
+    if (polygon.size())
+        m_areas.push_back(Polygon(polygon).bounds().to2d());
+
+    std::string query = options.getValueOrDefault<std::string>("query", "");
+    if (query.empty() && (m_blockTable.empty() || m_cloudTable.empty()))
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Option 'query' or options 'block_table_name' "
+            "and 'cloud_table_name' must be provided.";
+        throw pdal_error(oss.str());
+    }
+    if (m_areas.size() && m_blockTable.empty())
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Option 'block_table_name' is required with "
+            "options 'bounds' and 'polygon'.";
+        throw pdal_error(oss.str());
+    }
+    m_query = buildQuery(query, true);
+    // The schema is read without the area filter so that it's available
+    // even if no blocks intersect.
+    m_schemaQuery = buildQuery(query, false);
+}
+
+
+// Select the rowids of the blocks that intersect every requested area
+// from the block table's R*Tree, as created by writers.sqlite.
+std::string SQLiteReader::blockFilter() const
+{
+    std::ostringstream oss;
+    oss << std::setprecision(17);
+    oss << "SELECT id FROM " << m_blockTable << "_rtree WHERE ";
+    for (size_t i = 0; i < m_areas.size(); ++i)
+    {
+        const BOX2D& b = m_areas[i];
+        if (i)
+            oss << " AND ";
+        oss << "minx <= " << b.maxx << " AND maxx >= " << b.minx <<
+            " AND miny <= " << b.maxy << " AND maxy >= " << b.miny;
+    }
+    return oss.str();
+}
+
+
+// Without a user query, blocks are selected directly from the block table,
+// so the R*Tree drives the lookup and only intersecting blocks are read.
+// A user query is wrapped and its rows matched to the intersecting blocks
+// by cloud and block ID.
+std::string SQLiteReader::buildQuery(const std::string& query,
+    bool filter) const
+{
+    std::ostringstream oss;
+    if (query.empty())
+    {
+        oss << "SELECT c.schema AS schema, l." << m_cloudColumn <<
+            " AS cloud, l.block_id AS block_id, l.num_points AS num_points, "
+            "l.points AS points FROM " << m_blockTable << " l JOIN " <<
+            m_cloudTable << " c ON c." << m_cloudColumn << " = l." <<
+            m_cloudColumn;
+        if (filter && m_areas.size())
+            oss << " WHERE l.rowid IN (" << blockFilter() << ")";
+        oss << " ORDER BY l." << m_cloudColumn << ", l.block_id";
+    }
+    else if (filter && m_areas.size())
+    {
+        oss << "SELECT q.* FROM (" << query << ") AS q WHERE "
+            "q.cloud || ':' || q.block_id IN (SELECT l." << m_cloudColumn <<
+            " || ':' || l.block_id FROM " << m_blockTable << " l WHERE "
+            "l.rowid IN (" << blockFilter() << "))";
+    }
+    else
+        oss << query;
+
+    log()->get(LogLevel::Debug) << "Constructed query " << oss.str() <<
+        std::endl;
+    return oss.str();
 }
 
 
@@ -173,7 +281,7 @@ void SQLiteReader::addDimensions(PointLayoutPtr layout)
     log()->get(LogLevel::Debug) << "Fetching schema object" << std::endl;
 
     std::ostringstream oss;
-    oss << "SELECT SCHEMA FROM (" << m_query <<") as q LIMIT 1";
+    oss << "SELECT SCHEMA FROM (" << m_schemaQuery <<") as q LIMIT 1";
     std::string q(oss.str());
 
     m_session->query(q);
@@ -309,8 +417,13 @@ point_count_t SQLiteReader::read(PointViewPtr view, point_count_t count)
     {
         // read first patch
         m_session->query(m_query);
-        validateQuery();
         b_doneQuery = true;
+        if (!m_session->get())
+        {
+            m_at_end = true;
+            return 0;
+        }
+        validateQuery();
         totalNumRead = readPatch(view, count);
     }
 
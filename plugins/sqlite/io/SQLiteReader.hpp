@@ -63,6 +63,11 @@ public:
 private:
     std::unique_ptr<SQLite> m_session;
     std::string m_query;
+    std::string m_schemaQuery;
+    std::string m_blockTable;
+    std::string m_cloudTable;
+    std::string m_cloudColumn;
+    std::vector<BOX2D> m_areas;
     std::string m_schemaFile;
     std::string m_connection;
     std::string m_modulename;
@@ -81,6 +86,8 @@ private:
         { return m_at_end; }
 
     void validateQuery() const;
+    std::string blockFilter() const;
+    std::string buildQuery(const std::string& query, bool filter) const;
     point_count_t readPatch(PointViewPtr view, point_count_t count);
     bool nextBuffer();
 
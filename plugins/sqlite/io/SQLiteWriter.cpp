@@ -67,6 +67,7 @@ SQLiteWriter::SQLiteWriter() :
     , m_orientation(Orientation::PointMajor)
     , m_is3d(false)
     , m_doCompression(false)
+    , m_haveBlockIndex(false)
 {}
 
 
@@ -205,6 +206,21 @@ void SQLiteWriter::writeInit()
     {
         m_doCreateIndex = true;
         CreateBlockTable();
+        CreateBlockIndex();
+    }
+    else
+    {
+        // Only maintain an existing index.  A new one would be missing the
+        // blocks that are already in the table.
+        m_haveBlockIndex = m_session->doesTableExist(blockIndexName());
+    }
+
+    if (m_haveBlockIndex)
+    {
+        std::ostringstream oss;
+        oss << "INSERT INTO " << blockIndexName() <<
+            " (id, minx, maxx, miny, maxy) VALUES (?, ?, ?, ?, ?)";
+        m_rtree_insert_query = oss.str();
     }
     CreateCloud();
     m_sdo_pc_is_initialized = true;
@@ -238,10 +254,50 @@ void SQLiteWriter::CreateBlockTable()
     }
 }
 
+std::string SQLiteWriter::blockIndexName() const
+{
+    return Utils::tolower(m_block_table) + "_rtree";
+}
+
+
+// Create an R*Tree of the 2D extent of each block, keyed by the rowid of
+// the block.  Readers use it to select blocks by area without needing
+// SpatiaLite.
+void SQLiteWriter::CreateBlockIndex()
+{
+    std::ostringstream oss;
+
+    // Any existing index is stale, since the block table is new.
+    oss << "DROP TABLE IF EXISTS " << blockIndexName();
+    m_session->execute(oss.str());
+    oss.str("");
+
+    oss << "CREATE VIRTUAL TABLE " << blockIndexName() <<
+        " USING rtree(id, minx, maxx, miny, maxy)";
+    try
+    {
+        m_session->execute(oss.str());
+        m_haveBlockIndex = true;
+        log()->get(LogLevel::Debug) << "Created block index '" <<
+            blockIndexName() << "'" << std::endl;
+    }
+    catch (pdal_error& e)
+    {
+        log()->get(LogLevel::Warning) << "Unable to create R*Tree block "
+            "index.  SQLite may not be built with R*Tree support: " <<
+            e.what() << std::endl;
+    }
+}
+
+
 void SQLiteWriter::DeleteBlockTable()
 {
     std::ostringstream oss;
 
+    oss << "DROP TABLE IF EXISTS " << blockIndexName();
+    m_session->execute(oss.str());
+    oss.str("");
+
     // Delete all the items from the table first
     oss << "DELETE FROM " << m_block_table;
     m_session->execute(oss.str());
@@ -493,7 +549,14 @@ void SQLiteWriter::writeTile(const PointViewPtr view)
 {
     using namespace std;
 
-    Patch outpatch;
+    m_patch->clear();
+
+    // Pack all the points of the block before compressing them.
+    std::vector<char> storage(view->size() * packedPointSize());
+    char *pos = storage.data();
+    for (PointId idx = 0; idx < view->size(); idx++)
+        pos += readPoint(*view.get(), idx, pos);
+    size_t packedSize = pos - storage.data();
 
     if (m_doCompression)
     {
@@ -504,22 +567,7 @@ void SQLiteWriter::writeTile(const PointViewPtr view)
             dimTypes.push_back(xmlDim.m_dimType);
 
         LazPerfCompressor<Patch> compressor(*m_patch, dimTypes);
-
-        try
-        {
-            std::vector<char> outbuf(packedPointSize());
-            for (PointId idx = 0; idx < view->size(); idx++)
-            {
-                size_t size = readPoint(*view.get(), idx, outbuf.data());
-                // Read the data and write to the patch.
-                compressor.compress(outbuf.data(), size);
-            }
-        }
-        catch (pdal_error)
-        {
-            compressor.done();
-            throw;
-        }
+        compressor.compress(storage.data(), packedSize);
         compressor.done();
 #else
         throw pdal_error("Can't compress without LAZperf.");
@@ -533,13 +581,7 @@ void SQLiteWriter::writeTile(const PointViewPtr view)
     }
     else
     {
-        std::vector<char> storage(packedPointSize());
-
-        for (PointId idx = 0; idx < view->size(); idx++)
-        {
-            size_t size = readPoint(*view.get(), idx, storage.data());
-            m_patch->putBytes((const unsigned char *)storage.data(), size);
-        }
+        m_patch->putBytes((const unsigned char *)storage.data(), packedSize);
         log()->get(LogLevel::Debug3) << "uncompressed size: " <<
             m_patch->getBytes().size() << std::endl;
     }
@@ -566,8 +608,30 @@ void SQLiteWriter::writeTile(const PointViewPtr view)
     r.push_back(column(box));
     rs.push_back(r);
     m_session->insert(m_block_insert_query.str(), rs);
-    m_block_id++;
 
+    if (m_haveBlockIndex)
+    {
+        // Bind coordinates at full precision so the R*Tree, which rounds
+        // outward, never excludes part of a block.
+        auto coord = [](double d)
+        {
+            std::ostringstream oss;
+            oss << std::setprecision(17) << d;
+            return column(oss.str());
+        };
+
+        records rs;
+        row r;
+
+        r.push_back(column(m_session->last_row_id()));
+        r.push_back(coord(b.minx));
+        r.push_back(coord(b.maxx));
+        r.push_back(coord(b.miny));
+        r.push_back(coord(b.maxy));
+        rs.push_back(r);
+        m_session->insert(m_rtree_insert_query, rs);
+    }
+    m_block_id++;
 }
 
 } // namespaces
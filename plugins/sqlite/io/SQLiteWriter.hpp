@@ -64,6 +64,8 @@ private:
     void writeInit();
     void writeTile(const PointViewPtr view);
     void CreateBlockTable();
+    void CreateBlockIndex();
+    std::string blockIndexName() const;
     void CreateCloudTable();
     bool CheckTableExists(std::string const& name);
     void DeleteBlockTable();
@@ -94,7 +96,9 @@ private:
     std::string m_connection;
     std::string m_modulename;
     bool m_is3d;
-    bool m_doCompression;;
+    bool m_doCompression;
+    bool m_haveBlockIndex;
+    std::string m_rtree_insert_query;
     PatchPtr m_patch;
 };
 
@@ -168,6 +168,78 @@ TEST(SQLiteTest, readWriteCompressScale)
 }
 #endif
 
+// Read the test file back from blocks selected by 'bounds'.
+point_count_t readBounds(const BOX2D& bounds)
+{
+    Options options = getSQLITEOptions();
+    options.remove(Option("query", ""));
+    options.add("bounds", bounds);
+
+    StageFactory f;
+    Stage* sqliteReader(f.createStage("readers.sqlite"));
+    sqliteReader->setOptions(options);
+
+    PointTable table;
+    sqliteReader->prepare(table);
+    PointViewSet viewSet = sqliteReader->execute(table);
+    EXPECT_EQ(viewSet.size(), 1U);
+    return (*viewSet.begin())->size();
+}
+
+
+TEST(SQLiteTest, bounds)
+{
+    std::string tempFilename =
+        getSQLITEOptions().getValueOrThrow<std::string>("connection");
+    FileUtils::deleteFile(tempFilename);
+
+    const BOX2D west(635000, 848000, 637000, 854000);
+    point_count_t inWest = 0;
+    {
+        Options lasReadOpts;
+        lasReadOpts.add("filename",
+            Support::datapath("las/1.2-with-color.las"));
+        LasReader reader;
+        reader.setOptions(lasReadOpts);
+
+        StageFactory f;
+        Stage* chipper(f.createStage("filters.chipper"));
+        Options chipperOpts;
+        chipperOpts.add("capacity", 100);
+        chipper->setOptions(chipperOpts);
+        chipper->setInput(reader);
+
+        Stage* sqliteWriter(f.createStage("writers.sqlite"));
+        sqliteWriter->setOptions(getSQLITEOptions());
+        sqliteWriter->setInput(*chipper);
+
+        PointTable table;
+        sqliteWriter->prepare(table);
+        PointViewSet viewSet = sqliteWriter->execute(table);
+
+        for (auto& view : viewSet)
+            for (PointId idx = 0; idx < view->size(); ++idx)
+            {
+                double x = view->getFieldAs<double>(Dimension::Id::X, idx);
+                double y = view->getFieldAs<double>(Dimension::Id::Y, idx);
+                if (west.contains(x, y))
+                    inWest++;
+            }
+    }
+
+    EXPECT_EQ(readBounds(BOX2D(635000, 848000, 639000, 854000)), 1065U);
+    EXPECT_EQ(readBounds(BOX2D(0, 0, 10, 10)), 0U);
+
+    // Whole blocks are read, so there may be more points than are
+    // inside the bounds, but not all of them.
+    point_count_t count = readBounds(west);
+    EXPECT_GE(count, inWest);
+    EXPECT_LT(count, 1065U);
+
+    FileUtils::deleteFile(tempFilename);
+}
+
+
 TEST(SQLiteTest, Issue895)
 {
     LogPtr log(new pdal::Log("Issue895", "stdout"));
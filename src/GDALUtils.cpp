@@ -36,6 +36,7 @@
 #include <pdal/SpatialReference.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <algorithm>
 #include <functional>
 #include <map>
 
@@ -467,6 +468,62 @@ GDALError::Enum Raster::read(double x, double y, std::vector<double>& data)
 }
 
 
+bool Raster::getPixelPosition(double x, double y, double& column,
+    double& row) const
+{
+    column = m_inverse_transform[0] + (m_inverse_transform[1] * x) +
+        (m_inverse_transform[2] * y);
+    row = m_inverse_transform[3] + (m_inverse_transform[4] * x) +
+        (m_inverse_transform[5] * y);
+
+    return (column >= 0 && column < m_raster_x_size &&
+        row >= 0 && row < m_raster_y_size);
+}
+
+
+void Raster::getBlockSize(int& width, int& height) const
+{
+    width = m_raster_x_size;
+    height = 1;
+    if (m_ds && m_band_count)
+        GDALGetBlockSize(GDALGetRasterBand(m_ds, 1), &width, &height);
+}
+
+
+GDALError::Enum Raster::readWindow(int column, int row, int width,
+    int height, const std::vector<int>& bands, std::vector<double>& data)
+{
+    if (!m_ds)
+        return GDALError::NotOpen;
+
+    size_t bandSize = (size_t)width * height;
+    data.resize(bandSize * bands.size());
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        GDALRasterBandH b = GDALGetRasterBand(m_ds, bands[i]);
+        if (!b)
+        {
+            std::ostringstream oss;
+            oss << "Unable to get band " << bands[i] << " from raster '" <<
+                m_filename << "'.";
+            m_errorMsg = oss.str();
+            return GDALError::InvalidBand;
+        }
+        if (GDALRasterIO(b, GF_Read, column, row, width, height,
+            data.data() + i * bandSize, width, height, GDT_Float64,
+            0, 0) != CE_None)
+        {
+            std::ostringstream oss;
+            oss << "Unable to read block for for raster '" << m_filename <<
+                "'.";
+            m_errorMsg = oss.str();
+            return GDALError::CantReadBlock;
+        }
+    }
+    return GDALError::None;
+}
+
+
 SpatialReference Raster::getSpatialRef() const
 {
     SpatialReference srs;
@@ -493,6 +550,168 @@ void Raster::close()
     m_types.clear();
 }
 
+
+BlockCache::BlockCache(Raster& raster, const std::vector<int>& bands,
+        size_t maxBytes) :
+    m_raster(raster), m_bands(bands)
+{
+    m_raster.getBlockSize(m_blockWidth, m_blockHeight);
+    m_blockWidth = (std::max)(m_blockWidth, 1);
+    m_blockHeight = (std::max)(m_blockHeight, 1);
+
+    // Rasters stored in strips have blocks a single row or a few rows
+    // high.  Cache several strips at a time so that points aren't split
+    // into a block per row.
+    const int minHeight = 64;
+    if (m_blockHeight < minHeight)
+        m_blockHeight *= (minHeight + m_blockHeight - 1) / m_blockHeight;
+
+    size_t blockBytes = (size_t)m_blockWidth * m_blockHeight *
+        (std::max)(m_bands.size(), (size_t)1) * sizeof(double);
+    m_maxBlocks = (std::max)(maxBytes / blockBytes, (size_t)1);
+}
+
+
+uint64_t BlockCache::blockKey(double column, double row) const
+{
+    return ((uint64_t)((int)row / m_blockHeight) << 32) |
+        (uint64_t)((int)column / m_blockWidth);
+}
+
+
+BlockCache::BlockPtr BlockCache::fetch(int blockColumn, int blockRow)
+{
+    uint64_t key = ((uint64_t)blockRow << 32) | (uint64_t)blockColumn;
+
+    // GDAL datasets can't be read from several threads at once, so
+    // the read happens with the lock held.
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_blocks.find(key);
+    if (it != m_blocks.end())
+    {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.second);
+        return it->second.first;
+    }
+
+    std::shared_ptr<Block> block(new Block);
+    block->m_column = blockColumn * m_blockWidth;
+    block->m_row = blockRow * m_blockHeight;
+    block->m_width = (std::min)(m_blockWidth,
+        m_raster.m_raster_x_size - block->m_column);
+    block->m_height = (std::min)(m_blockHeight,
+        m_raster.m_raster_y_size - block->m_row);
+    if (m_raster.readWindow(block->m_column, block->m_row, block->m_width,
+        block->m_height, m_bands, block->m_data) != GDALError::None)
+        throw pdal_error(m_raster.errorMsg());
+
+    while (m_blocks.size() >= m_maxBlocks)
+    {
+        m_blocks.erase(m_lru.back());
+        m_lru.pop_back();
+    }
+    m_lru.push_front(key);
+    m_blocks[key] = CacheEntry(block, m_lru.begin());
+    return block;
+}
+
+
+// Fetch a band's value at a pixel.  'block' is the block used for the
+// previous lookup and is replaced if it doesn't hold the pixel.
+double BlockCache::value(int column, int row, size_t band, BlockPtr& block)
+{
+    if (!block || column < block->m_column ||
+        column >= block->m_column + block->m_width ||
+        row < block->m_row || row >= block->m_row + block->m_height)
+        block = fetch(column / m_blockWidth, row / m_blockHeight);
+
+    size_t bandSize = (size_t)block->m_width * block->m_height;
+    return block->m_data[band * bandSize +
+        (size_t)(row - block->m_row) * block->m_width +
+        (column - block->m_column)];
+}
+
+
+void BlockCache::sample(double column, double row, bool bilinear,
+    BlockPtr& block, double *values)
+{
+    if (!bilinear)
+    {
+        for (size_t b = 0; b < m_bands.size(); ++b)
+            values[b] = value((int)column, (int)row, b, block);
+        return;
+    }
+
+    // Interpolate between the centers of the surrounding pixels.  Pixels
+    // past the edge of the raster are replaced by the edge pixels.
+    double fx = column - .5;
+    double fy = row - .5;
+    int x0 = (int)std::floor(fx);
+    int y0 = (int)std::floor(fy);
+    double tx = fx - x0;
+    double ty = fy - y0;
+    int x1 = (std::min)(x0 + 1, m_raster.m_raster_x_size - 1);
+    int y1 = (std::min)(y0 + 1, m_raster.m_raster_y_size - 1);
+    x0 = (std::max)(x0, 0);
+    y0 = (std::max)(y0, 0);
+
+    for (size_t b = 0; b < m_bands.size(); ++b)
+    {
+        double v00 = value(x0, y0, b, block);
+        double v10 = value(x1, y0, b, block);
+        double v01 = value(x0, y1, b, block);
+        double v11 = value(x1, y1, b, block);
+        values[b] = (1 - ty) * ((1 - tx) * v00 + tx * v10) +
+            ty * ((1 - tx) * v01 + tx * v11);
+    }
+}
+
+
+bool BlockCache::sample(double x, double y, bool bilinear, double *values)
+{
+    double column, row;
+
+    if (!m_raster.getPixelPosition(x, y, column, row))
+        return false;
+
+    BlockPtr block;
+    sample(column, row, bilinear, block, values);
+    return true;
+}
+
+
+void BlockCache::sample(const std::vector<double>& x,
+    const std::vector<double>& y, bool bilinear, std::vector<double>& values,
+    std::vector<char>& valid)
+{
+    size_t count = (std::min)(x.size(), y.size());
+    size_t numBands = m_bands.size();
+    std::vector<double> column(count);
+    std::vector<double> row(count);
+    std::vector<std::pair<uint64_t, size_t>> order;
+
+    values.assign(count * numBands, 0.0);
+    valid.resize(count);
+    order.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        valid[i] = m_raster.getPixelPosition(x[i], y[i], column[i], row[i]);
+        if (valid[i])
+            order.push_back(std::make_pair(blockKey(column[i], row[i]), i));
+    }
+
+    // Visit the locations block by block so that each block is looked up
+    // in the cache once, rather than once per location.
+    std::sort(order.begin(), order.end());
+    BlockPtr block;
+    for (auto& o : order)
+    {
+        size_t i = o.second;
+        sample(column[i], row[i], bilinear, block, values.data() +
+            i * numBands);
+    }
+}
+
 } // namespace gdal
 
 
@@ -33,6 +33,7 @@
 ****************************************************************************/
 
 #include <cctype>
+#include <iomanip>
 #include <iostream>
 
 #include <pdal/pdal_config.hpp>
@@ -408,6 +409,35 @@ void Kernel::visualize(PointViewPtr input_view, PointViewPtr output_view) const
 */
 
 
+// Write a table of the statistics collected while executing each stage.
+void Kernel::outputTiming(const std::vector<Stage *>& stages)
+{
+    std::cout << std::left << std::setw(24) << "stage" << std::right <<
+        std::setw(10) << "wall(s)" << std::setw(10) << "cpu(s)" <<
+        std::setw(12) << "points in" << std::setw(12) << "points out" <<
+        std::setw(12) << "bytes" << std::setw(12) << "memory" << std::endl;
+    for (Stage *s : stages)
+    {
+        const StageStats& stats = s->stats();
+
+        double wall = 0;
+        double cpu = 0;
+        for (int phase = 0; phase < StageStats::NumPhases; ++phase)
+        {
+            wall += stats.wallTime((StageStats::Phase)phase);
+            cpu += stats.cpuTime((StageStats::Phase)phase);
+        }
+        std::cout << std::left << std::setw(24) << s->getName() <<
+            std::right << std::fixed << std::setprecision(3) <<
+            std::setw(10) << wall << std::setw(10) << cpu <<
+            std::setw(12) << stats.pointsIn() <<
+            std::setw(12) << stats.pointsOut() <<
+            std::setw(12) << stats.bytesRead() + stats.bytesWritten() <<
+            std::setw(12) << stats.tableMemory() << std::endl;
+    }
+}
+
+
 void Kernel::setCommonOptions(Options &options)
 {
     options.add("visualize", m_visualize);
@@ -74,6 +74,8 @@ Stage& PipelineManager::addReader(const std::string& type)
         throw pdal_error(ss.str());
     }
     reader->setProgressFd(m_progressFd);
+    reader->setThreads(m_threads);
+    reader->setTiming(m_timing);
     m_stages.push_back(reader);
     return *reader;
 }
@@ -89,6 +91,8 @@ Stage& PipelineManager::addFilter(const std::string& type)
         throw pdal_error(ss.str());
     }
     filter->setProgressFd(m_progressFd);
+    filter->setThreads(m_threads);
+    filter->setTiming(m_timing);
     m_stages.push_back(filter);
     return *filter;
 }
@@ -104,11 +108,29 @@ Stage& PipelineManager::addWriter(const std::string& type)
         throw pdal_error(ss.str());
     }
     writer->setProgressFd(m_progressFd);
+    writer->setThreads(m_threads);
+    writer->setTiming(m_timing);
     m_stages.push_back(writer);
     return *writer;
 }
 
 
+void PipelineManager::setThreads(std::size_t threads)
+{
+    m_threads = threads;
+    for (Stage *s : m_stages)
+        s->setThreads(m_threads);
+}
+
+
+void PipelineManager::setTiming(bool timing)
+{
+    m_timing = timing;
+    for (Stage *s : m_stages)
+        s->setTiming(m_timing);
+}
+
+
 void PipelineManager::prepare() const
 {
     Stage *s = getStage();
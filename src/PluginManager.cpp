@@ -47,7 +47,11 @@
 
 #include "DynamicLibrary.hpp"
 
+#include <algorithm>
+#include <ctime>
+#include <iterator>
 #include <memory>
+#include <random>
 #include <sstream>
 #include <string>
 
@@ -80,6 +84,40 @@ bool pluginTypeValid(std::string pathname, PF_PluginType type)
             type & PF_PluginType_Writer));
 }
 
+const int allPluginTypes = PF_PluginType_Kernel | PF_PluginType_Reader |
+    PF_PluginType_Filter | PF_PluginType_Writer;
+
+const std::string manifestHeader("# PDAL plugin manifest "
+    PDAL_VERSION_STRING);
+
+
+// The manifest is only used when PDAL_PLUGIN_MANIFEST names its file.
+std::string manifestFilename()
+{
+    return Utils::getenv("PDAL_PLUGIN_MANIFEST");
+}
+
+
+std::string modificationTime(const std::string& filename)
+{
+    struct tm t;
+    char buf[32];
+
+    FileUtils::fileTimes(filename, NULL, &t);
+    strftime(buf, sizeof(buf), "%Y%m%d%H%M%S", &t);
+    return buf;
+}
+
+
+// Manifest fields are tab-separated, one record per line.
+std::string manifestField(std::string s)
+{
+    std::replace(s.begin(), s.end(), '\t', ' ');
+    std::replace(s.begin(), s.end(), '\n', ' ');
+    std::replace(s.begin(), s.end(), '\r', ' ');
+    return s;
+}
+
 } // unnamed namespace;
 
 
@@ -127,8 +165,10 @@ void PluginManager::l_loadAll(PF_PluginType type)
 
     std::vector<std::string> pluginPathVec = Utils::split2(pluginDir, ':');
 
+    readManifest();
     for (const auto& pluginPath : pluginPathVec)
         loadAll(pluginPath, type);
+    writeManifest();
 }
 
 StringList PluginManager::names(int typeMask)
@@ -145,6 +185,9 @@ StringList PluginManager::l_names(int typeMask)
     for (auto p : m_plugins)
         if (p.second.pluginType & typeMask)
             l.push_back(p.first);
+    for (auto p : m_deferred)
+        if ((p.second.m_type & typeMask) && !Utils::contains(m_plugins, p.first))
+            l.push_back(p.first);
     return l;
 }
 
@@ -162,6 +205,12 @@ std::string PluginManager::l_link(const std::string& name)
     auto ei = m_plugins.find(name);
     if (ei != m_plugins.end())
         link= ei->second.link;
+    else
+    {
+        auto di = m_deferred.find(name);
+        if (di != m_deferred.end())
+            link = di->second.m_link;
+    }
     return link;
 }
 
@@ -180,6 +229,12 @@ std::string PluginManager::l_description(const std::string& name)
     auto ei = m_plugins.find(name);
     if (ei != m_plugins.end())
         descrip = ei->second.description;
+    else
+    {
+        auto di = m_deferred.find(name);
+        if (di != m_deferred.end())
+            descrip = di->second.m_description;
+    }
     return descrip;
 }
 
@@ -197,9 +252,232 @@ void PluginManager::loadAll(const std::string& pluginDirectory, int type)
         {
             if ((FileUtils::extension(file) == dynamicLibraryExtension) &&
                 !FileUtils::isDirectory(file))
-                loadByPath(file, type);
+                deferOrLoad(file, type);
+        }
+    }
+}
+
+
+// If the manifest has an up-to-date entry for a plugin library, make its
+// stages known without loading it.  Otherwise load the library and record
+// the stages it registers in the manifest.
+void PluginManager::deferOrLoad(const std::string& path, int type)
+{
+    std::string filename = Utils::tolower(FileUtils::getFilename(path));
+    if (!pluginTypeValid(filename, type) || libraryLoaded(path))
+        return;
+
+    if (m_manifestFilename.empty())
+    {
+        loadByPath(path, type);
+        return;
+    }
+
+    std::string completePath(FileUtils::toAbsolutePath(path));
+    ManifestLibrary lib;
+    lib.m_mtime = modificationTime(completePath);
+    lib.m_size = FileUtils::fileSize(completePath);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto mi = m_manifest.find(completePath);
+        if (mi != m_manifest.end() && mi->second.m_mtime == lib.m_mtime &&
+            mi->second.m_size == lib.m_size)
+        {
+            for (auto& stage : mi->second.m_stages)
+                if (!Utils::contains(m_plugins, stage.m_name))
+                    m_deferred[stage.m_name] = stage;
+            return;
+        }
+    }
+
+    StringList before = l_names(allPluginTypes);
+    loadByPath(path, type);
+    StringList after = l_names(allPluginTypes);
+    std::sort(before.begin(), before.end());
+    std::sort(after.begin(), after.end());
+    StringList added;
+    std::set_difference(after.begin(), after.end(),
+        before.begin(), before.end(), std::back_inserter(added));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& name : added)
+    {
+        const PF_RegisterParams& params = m_plugins[name];
+
+        ManifestStage stage;
+        stage.m_name = name;
+        stage.m_type = params.pluginType;
+        stage.m_description = params.description;
+        stage.m_link = params.link;
+        stage.m_library = completePath;
+        lib.m_stages.push_back(stage);
+    }
+    // A library that fails to load may load once its environment is
+    // fixed, so it isn't recorded.
+    if (lib.m_stages.empty())
+    {
+        if (m_manifest.erase(completePath))
+            m_manifestDirty = true;
+        return;
+    }
+    m_manifest[completePath] = lib;
+    m_manifestDirty = true;
+}
+
+
+void PluginManager::readManifest()
+{
+    std::string filename = manifestFilename();
+    if (m_manifestRead && filename == m_manifestFilename)
+        return;
+    m_manifestRead = true;
+    m_manifestFilename = filename;
+    m_manifestDirty = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_manifest.clear();
+    }
+    if (m_manifestFilename.empty() ||
+        !FileUtils::fileExists(m_manifestFilename))
+        return;
+
+    std::istream *in = FileUtils::openFile(m_manifestFilename, false);
+    if (!in)
+        return;
+
+    std::string line;
+    std::getline(*in, line);
+    if (line != manifestHeader)
+    {
+        FileUtils::closeFile(in);
+        m_manifestDirty = true;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string libPath;
+    try
+    {
+        while (std::getline(*in, line))
+        {
+            StringList fields = Utils::split(line, '\t');
+            if (fields.size() == 4 && fields[0] == "library")
+            {
+                libPath = fields[1];
+                ManifestLibrary& lib = m_manifest[libPath];
+                lib.m_mtime = fields[2];
+                lib.m_size = std::stoull(fields[3]);
+            }
+            else if (fields.size() == 5 && fields[0] == "stage" &&
+                libPath.size())
+            {
+                ManifestStage stage;
+                stage.m_name = fields[1];
+                stage.m_type = std::stoi(fields[2]);
+                stage.m_description = fields[3];
+                stage.m_link = fields[4];
+                stage.m_library = libPath;
+                m_manifest[libPath].m_stages.push_back(stage);
+            }
         }
     }
+    catch (std::exception&)
+    {
+        // A damaged manifest is rebuilt.
+        m_manifest.clear();
+        m_manifestDirty = true;
+    }
+    FileUtils::closeFile(in);
+}
+
+
+// Write the manifest to a temporary file and rename it into place so that
+// concurrent processes never see a partial manifest.
+void PluginManager::writeManifest()
+{
+    if (!m_manifestDirty || m_manifestFilename.empty())
+        return;
+    m_manifestDirty = false;
+
+    Log log("PDAL", "stderr");
+    std::string dir = FileUtils::getDirectory(m_manifestFilename);
+    if (dir.size() && !FileUtils::directoryExists(dir) &&
+        !FileUtils::createDirectory(dir))
+    {
+        log.get(LogLevel::Debug) << "Unable to create plugin manifest "
+            "directory '" << dir << "'." << std::endl;
+        return;
+    }
+
+    std::string tempFilename = m_manifestFilename + "." +
+        std::to_string(std::random_device()());
+    std::ostream *out = FileUtils::createFile(tempFilename, false);
+    if (!out)
+    {
+        log.get(LogLevel::Debug) << "Unable to write plugin manifest '" <<
+            tempFilename << "'." << std::endl;
+        return;
+    }
+
+    *out << manifestHeader << "\n";
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& entry : m_manifest)
+        {
+            if (!FileUtils::fileExists(entry.first))
+                continue;
+            const ManifestLibrary& lib = entry.second;
+            *out << "library\t" << manifestField(entry.first) << "\t" <<
+                lib.m_mtime << "\t" << lib.m_size << "\n";
+            for (auto& stage : lib.m_stages)
+                *out << "stage\t" << manifestField(stage.m_name) << "\t" <<
+                    stage.m_type << "\t" <<
+                    manifestField(stage.m_description) << "\t" <<
+                    manifestField(stage.m_link) << "\n";
+        }
+    }
+    bool ok = (bool)*out;
+    FileUtils::closeFile(out);
+    if (ok)
+        FileUtils::renameFile(m_manifestFilename, tempFilename);
+    else
+        FileUtils::deleteFile(tempFilename);
+}
+
+
+// Load the library providing a stage found in the manifest.
+bool PluginManager::loadDeferred(const std::string& name)
+{
+    ManifestStage stage;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto di = m_deferred.find(name);
+        if (di == m_deferred.end())
+            return false;
+        stage = di->second;
+
+        // Everything else from the library is registered when it loads.
+        for (auto it = m_deferred.begin(); it != m_deferred.end();)
+        {
+            if (it->second.m_library == stage.m_library)
+                it = m_deferred.erase(it);
+            else
+                ++it;
+        }
+    }
+    if (loadByPath(stage.m_library, stage.m_type))
+        return true;
+
+    // The library may load once its environment is fixed, so drop it from
+    // the manifest rather than keep advertising its stages.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_manifest.erase(stage.m_library))
+            m_manifestDirty = true;
+    }
+    writeManifest();
+    return false;
 }
 
 
@@ -221,7 +499,8 @@ bool PluginManager::l_initializePlugin(PF_InitFunc initFunc)
 }
 
 
-PluginManager::PluginManager()
+PluginManager::PluginManager() : m_manifestRead(false),
+    m_manifestDirty(false)
 {
     m_version.major = 1;
     m_version.minor = 0;
@@ -271,6 +550,7 @@ bool PluginManager::shutdown()
 
     m_dynamicLibraryMap.clear();
     m_plugins.clear();
+    m_deferred.clear();
     m_exitFuncVec.clear();
 
     return success;
@@ -445,7 +725,8 @@ void *PluginManager::l_createObject(const std::string& objectType)
 
 
     void *obj(0);
-    if (find() || (guessLoadByPath(objectType) && find()))
+    if (find() || (loadDeferred(objectType) && find()) ||
+        (guessLoadByPath(objectType) && find()))
     {
         PF_CreateFunc f;
         {
@@ -32,6 +32,8 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <algorithm>
+
 #include <pdal/PointTable.hpp>
 
 namespace pdal
@@ -92,5 +94,88 @@ char *PointTable::getPoint(PointId idx)
     return buf + pointsToBytes(idx % m_blockPtCnt);
 }
 
+
+void ColumnPointTable::finalize()
+{
+    if (m_layout.finalized())
+        return;
+    BasePointTable::finalize();
+
+    size_t numCols = 0;
+    for (auto id : m_layout.dims())
+        numCols = std::max(numCols, (size_t)id + 1);
+    m_columns.resize(numCols);
+    m_sizes.resize(numCols);
+    for (auto id : m_layout.dims())
+        m_sizes[id] = m_layout.dimSize(id);
+}
+
+
+PointId ColumnPointTable::addPoint()
+{
+    flushRow();
+    if (m_numPts == m_capacity)
+    {
+        m_capacity = std::max(m_capacity * 2, (point_count_t)65536);
+        for (size_t i = 0; i < m_columns.size(); ++i)
+            m_columns[i].resize(m_capacity * m_sizes[i]);
+    }
+    return m_numPts++;
+}
+
+
+// Points aren't stored contiguously, so pack the point into a row and
+// hand that out.  Changes made through the row are copied back to the
+// columns when the table is next accessed.
+char *ColumnPointTable::getPoint(PointId idx)
+{
+    flushRow();
+    m_row.resize(m_layout.pointSize());
+    for (auto id : m_layout.dims())
+    {
+        size_t size = m_sizes[id];
+        const char *src = m_columns[id].data() + idx * size;
+        std::copy(src, src + size, m_row.data() + m_layout.dimOffset(id));
+    }
+    m_rowId = idx;
+    m_rowValid = true;
+    return m_row.data();
+}
+
+
+void ColumnPointTable::flushRow()
+{
+    if (!m_rowValid)
+        return;
+    m_rowValid = false;
+    for (auto id : m_layout.dims())
+    {
+        size_t size = m_sizes[id];
+        const char *src = m_row.data() + m_layout.dimOffset(id);
+        std::copy(src, src + size, m_columns[id].data() + m_rowId * size);
+    }
+}
+
+
+void ColumnPointTable::setFieldInternal(Dimension::Id::Enum id, PointId idx,
+    const void *value)
+{
+    flushRow();
+    size_t size = m_sizes[id];
+    const char *src = (const char *)value;
+    std::copy(src, src + size, m_columns[id].data() + idx * size);
+}
+
+
+void ColumnPointTable::getFieldInternal(Dimension::Id::Enum id, PointId idx,
+    void *value) const
+{
+    if (m_rowValid)
+        const_cast<ColumnPointTable *>(this)->flushRow();
+    size_t size = m_sizes[id];
+    const char *src = m_columns[id].data() + idx * size;
+    std::copy(src, src + size, (char *)value);
+}
+
 } // namespace pdal
 
@@ -40,7 +40,7 @@
 namespace pdal
 {
 
-int PointView::m_lastId = 0;
+std::atomic<int> PointView::m_lastId(0);
 
 PointView::PointView(PointTableRef pointTable) : m_pointTable(pointTable),
 m_size(0), m_id(0)
@@ -91,6 +91,27 @@ void PointView::setFieldInternal(Dimension::Id::Enum dim, PointId idx,
 }
 
 
+void PointView::addPoints(point_count_t count)
+{
+    assert(m_temps.empty());
+    for (point_count_t i = 0; i < count; ++i)
+        m_index.push_back(m_pointTable.addPoint());
+    m_size += count;
+}
+
+
+void PointView::reorder(const std::vector<PointId>& order)
+{
+    assert(order.size() == size());
+    std::deque<PointId> index(order.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        index[i] = m_index[order[i]];
+    // Temporary points beyond the end of the view are discarded.
+    m_index.swap(index);
+    clearTemps();
+}
+
+
 void PointView::calculateBounds(BOX2D& output) const
 {
     for (PointId idx = 0; idx < size(); idx++)
@@ -33,6 +33,9 @@
 ****************************************************************************/
 
 #include <pdal/Polygon.hpp>
+
+#include <algorithm>
+
 #include "cpl_string.h"
 
 #include <ogr_geometry.h>
@@ -42,7 +45,6 @@ namespace pdal
 
 Polygon::Polygon()
     : m_geom(0)
-    , m_prepGeom(0)
     , m_ctx(pdal::GlobalEnvironment::get().geos()->ctx)
 {
     m_geom = GEOSGeom_createEmptyPolygon_r(m_ctx);
@@ -53,7 +55,6 @@ Polygon::Polygon(const std::string& wkt_or_json,
                    SpatialReference ref,
                    ErrorHandlerPtr err)
     : m_geom(0)
-    , m_prepGeom(0)
     , m_srs(ref)
     , m_ctx(err->ctx)
 {
@@ -64,7 +65,6 @@ Polygon::Polygon(const std::string& wkt_or_json,
 Polygon::Polygon(const std::string& wkt_or_json, SpatialReference ref,
     GEOSContextHandle_t ctx)
     : m_geom(0)
-    , m_prepGeom(0)
     , m_srs(ref)
     , m_ctx(ctx)
 {
@@ -76,10 +76,7 @@ Polygon::~Polygon()
 {
     if (m_geom)
         GEOSGeom_destroy_r(m_ctx, m_geom);
-    if (m_prepGeom)
-        GEOSPreparedGeom_destroy_r(m_ctx, m_prepGeom);
     m_geom = 0;
-    m_prepGeom = 0;
 }
 
 
@@ -117,14 +114,62 @@ void Polygon::update(const std::string& wkt_or_json, SpatialReference ref)
 }
 
 
+namespace
+{
+
+void addRing(GEOSContextHandle_t ctx, const GEOSGeometry *ring,
+    PolygonIndex& index)
+{
+    const GEOSCoordSequence *coords = GEOSGeom_getCoordSeq_r(ctx, ring);
+    if (!coords)
+        throw pdal_error("unable to fetch coordinates of polygon ring");
+
+    uint32_t count(0);
+    GEOSCoordSeq_getSize_r(ctx, coords, &count);
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        GEOSCoordSeq_getX_r(ctx, coords, i, &x[i]);
+        GEOSCoordSeq_getY_r(ctx, coords, i, &y[i]);
+    }
+    index.addRing(x, y);
+}
+
+
+void addPolygon(GEOSContextHandle_t ctx, const GEOSGeometry *poly,
+    PolygonIndex& index)
+{
+    addRing(ctx, GEOSGetExteriorRing_r(ctx, poly), index);
+    int numHoles = GEOSGetNumInteriorRings_r(ctx, poly);
+    for (int i = 0; i < numHoles; ++i)
+        addRing(ctx, GEOSGetInteriorRingN_r(ctx, poly, i), index);
+}
+
+} // unnamed namespace
+
+
+// Copy the rings of the geometry into the point-in-polygon index.  GEOS
+// is only used to hold the geometry -- containment tests don't touch it.
 void Polygon::prepare()
 {
-    if (m_geom)
+    m_index.clear();
+    if (!m_geom || GEOSisEmpty_r(m_ctx, m_geom))
+        return;
+
+    if (GEOSGeomTypeId_r(m_ctx, m_geom) == GEOS_POLYGON)
+        addPolygon(m_ctx, m_geom, m_index);
+    else
     {
-        m_prepGeom = GEOSPrepare_r(m_ctx, m_geom);
-        if (!m_prepGeom)
-            throw pdal_error("unable to prepare geometry for index-accelerated access");
+        int numGeoms = GEOSGetNumGeometries_r(m_ctx, m_geom);
+        for (int i = 0; i < numGeoms; ++i)
+        {
+            const GEOSGeometry *g = GEOSGetGeometryN_r(m_ctx, m_geom, i);
+            if (GEOSGeomTypeId_r(m_ctx, g) == GEOS_POLYGON)
+                addPolygon(m_ctx, g, m_index);
+        }
     }
+    m_index.build();
 }
 
 Polygon& Polygon::operator=(const Polygon& input)
@@ -132,6 +177,8 @@ Polygon& Polygon::operator=(const Polygon& input)
 
     if (&input!= this)
     {
+        if (m_geom)
+            GEOSGeom_destroy_r(m_ctx, m_geom);
         m_ctx = input.m_ctx;
         m_srs = input.m_srs;
         m_geom = GEOSGeom_clone_r(m_ctx, input.m_geom);
@@ -149,7 +196,6 @@ Polygon::Polygon(const Polygon& input)
     assert(input.m_geom != 0);
     m_geom = GEOSGeom_clone_r(m_ctx, input.m_geom);
     assert(m_geom != 0);
-    m_prepGeom = 0;
     prepare();
 }
 
@@ -349,31 +395,27 @@ double Polygon::area() const
 
 bool Polygon::covers(PointRef& ref) const
 {
-    GEOSCoordSequence* coords = GEOSCoordSeq_create_r(m_ctx, 1, 3);
-    if (!coords)
-        throw pdal_error("Unable to allocate coordinate sequence");
-
-    const double x = ref.getFieldAs<double>(Dimension::Id::X);
-    const double y = ref.getFieldAs<double>(Dimension::Id::Y);
-    const double z = ref.getFieldAs<double>(Dimension::Id::Z);
+    return covers(ref.getFieldAs<double>(Dimension::Id::X),
+        ref.getFieldAs<double>(Dimension::Id::Y),
+        ref.getFieldAs<double>(Dimension::Id::Z));
+}
 
-    if (!GEOSCoordSeq_setX_r(m_ctx, coords, 0, x))
-        throw pdal_error("unable to set x for coordinate sequence");
-    if (!GEOSCoordSeq_setY_r(m_ctx, coords, 0, y))
-        throw pdal_error("unable to set y for coordinate sequence");
-    if (!GEOSCoordSeq_setZ_r(m_ctx, coords, 0, z))
-        throw pdal_error("unable to set z for coordinate sequence");
-    GEOSGeometry* p = GEOSGeom_createPoint_r(m_ctx, coords);
-    if (!p)
-        throw pdal_error("unable to allocate candidate test point");
 
-    bool covers = (bool)(GEOSPreparedCovers_r(m_ctx, m_prepGeom, p));
-    GEOSGeom_destroy_r(m_ctx, p);
+bool Polygon::covers(double x, double y, double /*z*/) const
+{
+    return m_index.covers(x, y);
+}
 
-    return covers;
 
+void Polygon::covers(const std::vector<double>& x,
+    const std::vector<double>& y, std::vector<char>& inside) const
+{
+    size_t count = (std::min)(x.size(), y.size());
+    inside.resize(count);
+    m_index.covers(x.data(), y.data(), count, inside.data());
 }
 
+
 BOX3D Polygon::bounds() const
 {
 
@@ -0,0 +1,199 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <algorithm>
+#include <limits>
+
+#include <pdal/PolygonIndex.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Upper bound on the number of bands.
+const size_t MaxBands = 65536;
+
+} // unnamed namespace
+
+
+PolygonIndex::Edge::Edge(double x1, double y1, double x2, double y2) :
+    m_x1(x1), m_y1(y1), m_x2(x2), m_y2(y2),
+    m_minx((std::min)(x1, x2)), m_maxx((std::max)(x1, x2)),
+    m_dxdy(y1 == y2 ? 0.0 : (x2 - x1) / (y2 - y1))
+{}
+
+
+PolygonIndex::PolygonIndex()
+{
+    clear();
+}
+
+
+void PolygonIndex::clear()
+{
+    m_edges.clear();
+    m_bandEdges.clear();
+    m_bandStart.clear();
+    m_minx = m_miny = (std::numeric_limits<double>::max)();
+    m_maxx = m_maxy = std::numeric_limits<double>::lowest();
+    m_bandScale = 0.0;
+    m_numBands = 0;
+}
+
+
+void PolygonIndex::addRing(const std::vector<double>& x,
+    const std::vector<double>& y)
+{
+    size_t count = (std::min)(x.size(), y.size());
+    if (count < 2)
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t j = (i + 1) % count;
+        // Skip zero-length edges, including the closing edge of a ring
+        // whose last vertex repeats the first.
+        if (x[i] == x[j] && y[i] == y[j])
+            continue;
+        m_edges.push_back(Edge(x[i], y[i], x[j], y[j]));
+        m_minx = (std::min)(m_minx, x[i]);
+        m_maxx = (std::max)(m_maxx, x[i]);
+        m_miny = (std::min)(m_miny, y[i]);
+        m_maxy = (std::max)(m_maxy, y[i]);
+    }
+}
+
+
+size_t PolygonIndex::band(double y) const
+{
+    double b = (y - m_miny) * m_bandScale;
+    if (b <= 0)
+        return 0;
+    return (std::min)((size_t)b, m_numBands - 1);
+}
+
+
+void PolygonIndex::build()
+{
+    m_bandEdges.clear();
+    m_bandStart.clear();
+    if (m_edges.empty())
+    {
+        m_numBands = 0;
+        return;
+    }
+
+    // Long edges are copied into every band they cross.  Use fewer bands
+    // if that would make the index much larger than the edge list.
+    m_numBands = (std::min)(m_edges.size(), MaxBands);
+    size_t total;
+    while (true)
+    {
+        m_bandScale = (m_maxy > m_miny) ?
+            m_numBands / (m_maxy - m_miny) : 0.0;
+        total = 0;
+        for (const Edge& e : m_edges)
+            total += band((std::max)(e.m_y1, e.m_y2)) -
+                band((std::min)(e.m_y1, e.m_y2)) + 1;
+        if (m_numBands == 1 || total <= 8 * m_edges.size() + 1024)
+            break;
+        m_numBands /= 2;
+    }
+
+    m_bandStart.resize(m_numBands + 1, 0);
+    for (const Edge& e : m_edges)
+    {
+        size_t last = band((std::max)(e.m_y1, e.m_y2));
+        for (size_t b = band((std::min)(e.m_y1, e.m_y2)); b <= last; ++b)
+            m_bandStart[b + 1]++;
+    }
+    for (size_t b = 0; b < m_numBands; ++b)
+        m_bandStart[b + 1] += m_bandStart[b];
+
+    std::vector<size_t> pos(m_bandStart.begin(), m_bandStart.end() - 1);
+    m_bandEdges.resize(total, m_edges.front());
+    for (const Edge& e : m_edges)
+    {
+        size_t last = band((std::max)(e.m_y1, e.m_y2));
+        for (size_t b = band((std::min)(e.m_y1, e.m_y2)); b <= last; ++b)
+            m_bandEdges[pos[b]++] = e;
+    }
+}
+
+
+bool PolygonIndex::covers(double x, double y) const
+{
+    if (m_numBands == 0 || x < m_minx || x > m_maxx ||
+        y < m_miny || y > m_maxy)
+        return false;
+
+    bool inside = false;
+    size_t b = band(y);
+    const Edge *e = m_bandEdges.data() + m_bandStart[b];
+    const Edge *end = m_bandEdges.data() + m_bandStart[b + 1];
+    for (; e != end; ++e)
+    {
+        // An edge entirely to the left of the point can't be crossed by
+        // the ray and can't hold the point.
+        if (e->m_maxx < x)
+            continue;
+
+        bool above1 = e->m_y1 > y;
+        bool above2 = e->m_y2 > y;
+        if (x >= e->m_minx && (above1 != above2 || e->m_y1 == y ||
+            e->m_y2 == y))
+        {
+            double cross = (e->m_x2 - e->m_x1) * (y - e->m_y1) -
+                (e->m_y2 - e->m_y1) * (x - e->m_x1);
+            if (cross == 0)
+                return true;
+        }
+        if (above1 != above2 && x < e->m_x1 + (y - e->m_y1) * e->m_dxdy)
+            inside = !inside;
+    }
+    return inside;
+}
+
+
+void PolygonIndex::covers(const double *x, const double *y, size_t count,
+    char *inside) const
+{
+    for (size_t i = 0; i < count; ++i)
+        inside[i] = covers(x[i], y[i]) ? 1 : 0;
+}
+
+} // namespace pdal
@@ -40,13 +40,67 @@
 
 #include "StageRunner.hpp"
 
+#include <algorithm>
+#include <condition_variable>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
 
 namespace pdal
 {
 
-Stage::Stage() : m_progressFd(-1)
+namespace
+{
+
+// Queue of stream table segment numbers passed between the threads of an
+// overlapped streaming execution.  Closing the queue wakes all waiters so
+// that execution can be abandoned when a stage fails.
+class SegmentQueue
+{
+public:
+    SegmentQueue() : m_closed(false)
+    {}
+
+    void push(int segment)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_segments.push(segment);
+        lock.unlock();
+        m_cv.notify_one();
+    }
+
+    // Returns false if the queue was closed.
+    bool pop(int& segment)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_closed || !m_segments.empty(); });
+        if (m_closed)
+            return false;
+        segment = m_segments.front();
+        m_segments.pop();
+        return true;
+    }
+
+    void close()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_closed = true;
+        lock.unlock();
+        m_cv.notify_all();
+    }
+
+private:
+    std::queue<int> m_segments;
+    bool m_closed;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+} // unnamed namespace
+
+Stage::Stage() : m_progressFd(-1), m_threads(1), m_timing(false)
 {
     Construct();
 }
@@ -96,6 +150,9 @@ void Stage::prepare(PointTableRef table)
         Stage *prev = m_inputs[i];
         prev->prepare(table);
     }
+
+    m_stats.reset();
+    StageStats::Timer timer(m_stats, StageStats::Prepare);
     l_processOptions(m_options);
     processOptions(m_options);
     l_initialize(table);
@@ -140,18 +197,30 @@ PointViewSet Stage::execute(PointTableRef table)
     for (auto const& it : views)
         table.addSpatialReference(it->spatialReference());
 
+    // If the stage can run views concurrently and we've been allowed more
+    // than one thread, run the views on a thread pool.
+    std::unique_ptr<ThreadPool> pool;
+    if (m_threads > 1 && views.size() > 1 && threadSafe())
+        pool.reset(new ThreadPool(std::min(m_threads, views.size())));
+
     // Do the ready operation and then start running all the views
     // through the stage.
-    ready(table);
+    {
+        StageStats::Timer timer(m_stats, StageStats::Ready);
+        ready(table);
+    }
     for (auto const& it : views)
     {
+        m_stats.addPointsIn(it->size());
         StageRunnerPtr runner(new StageRunner(this, it));
         runners.push_back(runner);
-        runner->run();
+        runner->run(pool.get());
     }
+    if (pool)
+        pool->join();
 
-    // As the stages complete (synchronously at this time), propagate the
-    // spatial reference and merge the output views.
+    // As the stages complete, propagate the spatial reference and merge
+    // the output views.
     srs = getSpatialReference();
     for (auto const& it : runners)
     {
@@ -163,13 +232,30 @@ PointViewSet Stage::execute(PointTableRef table)
         if (!srs.empty())
             for (PointViewPtr v : temp)
                 v->setSpatialReference(srs);
+        for (PointViewPtr v : temp)
+            m_stats.addPointsOut(v->size());
         outViews.insert(temp.begin(), temp.end());
     }
-    done(table);
+    {
+        StageStats::Timer timer(m_stats, StageStats::Done);
+        done(table);
+    }
+    recordStats(table);
     return outViews;
 }
 
 
+bool Stage::pipelineStreamable() const
+{
+    if (!streamable())
+        return false;
+    for (Stage *s : m_inputs)
+        if (!s->pipelineStreamable())
+            return false;
+    return true;
+}
+
+
 // Streamed execution.
 void Stage::execute(StreamPointTable& table)
 {
@@ -219,7 +305,14 @@ void Stage::execute(StreamPointTable& table)
 
 void Stage::execute(StreamPointTable& table, std::list<Stage *>& stages)
 {
-    std::vector<bool> skips(table.capacity());
+    if (m_threads > 1 && stages.size() > 1 &&
+        table.capacity() >= m_streamSegments)
+    {
+        executeOverlapped(table, stages);
+        return;
+    }
+
+    std::vector<char> skips(table.capacity());
     std::list<Stage *> filters;
     SpatialReference srs;
 
@@ -234,6 +327,7 @@ void Stage::execute(StreamPointTable& table, std::list<Stage *>& stages)
 
     for (Stage *s : stages)
     {
+        StageStats::Timer timer(s->m_stats, StageStats::Ready);
         s->ready(table);
         srs = s->getSpatialReference();
         if (!srs.empty())
@@ -255,43 +349,247 @@ void Stage::execute(StreamPointTable& table, std::list<Stage *>& stages)
         // When we get false back from a reader, we're done, so set
         // the point limit to the number of points processed in this loop
         // of the table.
-        for (PointId idx = 0; idx < pointLimit; idx++)
         {
-            point.setPointId(idx);
-            finished = !reader->processOne(point);
-            if (finished)
-                pointLimit = idx;
+            StageStats::Timer timer(reader->m_stats, StageStats::Process);
+            for (PointId idx = 0; idx < pointLimit; idx++)
+            {
+                point.setPointId(idx);
+                finished = !reader->processOne(point);
+                if (finished)
+                    pointLimit = idx;
+            }
         }
+        reader->m_stats.addPointsOut(pointLimit);
         srs = reader->getSpatialReference();
         if (!srs.empty())
             table.setSpatialReference(srs);
 
-        // When we get a false back from a filter, we're filtering out a
-        // point, so add it to the list of skips so that it doesn't get
-        // processed by subsequent filters.
+        // When a filter skips a point, it's marked in the list of skips so
+        // that it doesn't get processed by subsequent filters.
+        PointSpan span(table, 0, pointLimit, skips.data());
         for (Stage *s : filters)
         {
-            for (PointId idx = 0; idx < pointLimit; idx++)
-            {
-                if (skips[idx])
-                    continue;
-                point.setPointId(idx);
-                if (!s->processOne(point))
-                    skips[idx] = true;
-            }
+            s->processSpan(span);
             srs = s->getSpatialReference();
             if (!srs.empty())
                 table.setSpatialReference(srs);
         }
 
-        // Yes, vector<bool> is terrible.  Can do something better later.
-        for (size_t i = 0; i < skips.size(); ++i)
-            skips[i] = false;
-        table.reset();
+        std::fill(skips.begin(), skips.end(), 0);
+        table.resetSegment(0, pointLimit);
     }
 
     for (Stage *s : stages)
-        s->done(table);
+    {
+        {
+            StageStats::Timer timer(s->m_stats, StageStats::Done);
+            s->done(table);
+        }
+        s->recordStats(table);
+    }
+}
+
+
+// Streamed execution where stages run on their own threads.  The table
+// is split into segments that are passed from step to step, so that the
+// reader can fill one segment while filters and the writer work on others.
+// The reader and the last stage each get a thread of their own.  Filters
+// between them only get one if they're thread-safe; others run on the
+// thread of the step before them.  Each stage sees segments in order and is
+// only ever called from one thread.  When the last stage is done with a
+// segment, the table's spatial reference is set from that segment and the
+// segment is reset, as the serial path does for the whole table.
+void Stage::executeOverlapped(StreamPointTable& table,
+    std::list<Stage *>& stages)
+{
+    const point_count_t segmentSize = table.capacity() / m_streamSegments;
+    std::vector<char> skips(table.capacity());
+    std::vector<point_count_t> counts(m_streamSegments);
+    std::vector<SpatialReference> segSrs(m_streamSegments);
+    SpatialReference srs;
+
+    std::vector<std::vector<Stage *>> steps;
+    for (Stage *s : stages)
+    {
+        if (steps.empty() || s == stages.back() || s->threadSafe())
+            steps.push_back(std::vector<Stage *>());
+        steps.back().push_back(s);
+    }
+
+    for (Stage *s : stages)
+    {
+        StageStats::Timer timer(s->m_stats, StageStats::Ready);
+        s->ready(table);
+        srs = s->getSpatialReference();
+        if (!srs.empty())
+            table.setSpatialReference(srs);
+    }
+
+    // Queue 0 holds free segments for the reader.  Queue i holds segments
+    // ready for step i.  A segment number of -1 marks the end of data.
+    std::vector<std::unique_ptr<SegmentQueue>> queues;
+    for (size_t i = 0; i < steps.size(); ++i)
+        queues.push_back(std::unique_ptr<SegmentQueue>(new SegmentQueue));
+    for (int seg = 0; seg < (int)m_streamSegments; ++seg)
+        queues[0]->push(seg);
+
+    std::mutex mutex;
+    std::exception_ptr error;
+
+    auto fail = [&queues, &mutex, &error]()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+            error = std::current_exception();
+        for (auto& q : queues)
+            q->close();
+    };
+
+    // A segment is only handled by one step at a time, so its spatial
+    // reference needs no lock.
+    auto setSrs = [&segSrs](Stage *s, int seg)
+    {
+        SpatialReference srs = s->getSpatialReference();
+        if (!srs.empty())
+            segSrs[seg] = srs;
+    };
+
+    auto process = [&](Stage *s, int seg)
+    {
+        PointId begin = seg * segmentSize;
+        PointSpan span(table, begin, begin + counts[seg],
+            skips.data() + begin);
+        s->processSpan(span);
+        setSrs(s, seg);
+    };
+
+    auto read = [&]()
+    {
+        try
+        {
+            Stage *reader = steps[0].front();
+            PointRef point(table, 0);
+            int seg;
+            bool finished = false;
+            while (!finished && queues[0]->pop(seg))
+            {
+                segSrs[seg] = SpatialReference();
+                PointId begin = seg * segmentSize;
+                PointId end = begin + segmentSize;
+                PointId idx;
+                {
+                    StageStats::Timer timer(reader->m_stats,
+                        StageStats::Process);
+                    for (idx = begin; idx < end; ++idx)
+                    {
+                        point.setPointId(idx);
+                        if (!reader->processOne(point))
+                        {
+                            finished = true;
+                            break;
+                        }
+                    }
+                }
+                counts[seg] = idx - begin;
+                reader->m_stats.addPointsOut(counts[seg]);
+                std::fill(skips.begin() + begin, skips.begin() + end, 0);
+                setSrs(reader, seg);
+                for (size_t i = 1; i < steps[0].size(); ++i)
+                    process(steps[0][i], seg);
+                queues[1]->push(seg);
+            }
+            queues[1]->push(-1);
+        }
+        catch (...)
+        {
+            fail();
+        }
+    };
+
+    // Only the last step touches the table's spatial references while
+    // the steps are running.
+    auto filter = [&](size_t stepNum)
+    {
+        try
+        {
+            bool last = (stepNum == steps.size() - 1);
+            int seg;
+            while (queues[stepNum]->pop(seg))
+            {
+                if (seg < 0)
+                {
+                    if (!last)
+                        queues[stepNum + 1]->push(-1);
+                    break;
+                }
+                for (Stage *s : steps[stepNum])
+                    process(s, seg);
+                if (last)
+                {
+                    table.clearSpatialReferences();
+                    if (!segSrs[seg].empty())
+                        table.setSpatialReference(segSrs[seg]);
+                    table.resetSegment(seg * segmentSize, counts[seg]);
+                    queues[0]->push(seg);
+                }
+                else
+                    queues[stepNum + 1]->push(seg);
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.push_back(std::thread(read));
+    for (size_t i = 1; i < steps.size(); ++i)
+        threads.push_back(std::thread(filter, i));
+    for (std::thread& t : threads)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    for (Stage *s : stages)
+    {
+        {
+            StageStats::Timer timer(s->m_stats, StageStats::Done);
+            s->done(table);
+        }
+        s->recordStats(table);
+    }
+}
+
+
+// Pass a span of points to processBatch(), recording the time taken and
+// the points in the span before and after.
+void Stage::processSpan(PointSpan& span)
+{
+    auto active = [&span]()
+    {
+        point_count_t count = 0;
+        for (PointId idx = span.begin(); idx < span.end(); ++idx)
+            if (!span.skipped(idx))
+                count++;
+        return count;
+    };
+
+    m_stats.addPointsIn(active());
+    {
+        StageStats::Timer timer(m_stats, StageStats::Process);
+        processBatch(span);
+    }
+    m_stats.addPointsOut(active());
+}
+
+
+void Stage::recordStats(PointTableRef table)
+{
+    m_stats.noteTableMemory(table.memoryUsage());
+    if (m_timing)
+        m_stats.toMetadata(m_metadata);
 }
 
 
@@ -37,6 +37,7 @@
 #include <memory>
 
 #include <pdal/Stage.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -48,14 +49,27 @@ public:
         m_stage(s), m_view(view)
     {}
 
-    // For now this is all synchronous
-    void run()
-        { m_viewSet = m_stage->run(m_view); }
+    // Run synchronously if no pool is provided, otherwise queue the
+    // run on the pool.  When a pool is used, the caller must wait on the
+    // pool before calling wait().
+    void run(ThreadPool *pool = nullptr)
+    {
+        if (pool)
+            pool->add([this](){ runView(); });
+        else
+            runView();
+    }
 
     PointViewSet wait()
         { return m_viewSet; }
 
 private:
+    void runView()
+    {
+        StageStats::Timer timer(m_stage->m_stats, StageStats::Run);
+        m_viewSet = m_stage->run(m_view);
+    }
+
     Stage *m_stage;
     PointViewPtr m_view;
     PointViewSet m_viewSet;
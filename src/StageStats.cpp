@@ -0,0 +1,242 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/StageStats.hpp>
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace pdal
+{
+
+StageStats::Timer::Timer(StageStats& stats, Phase phase) :
+    m_stats(stats), m_phase(phase), m_start(std::chrono::steady_clock::now()),
+    m_cpuStart(StageStats::threadCpuTime())
+{}
+
+
+StageStats::Timer::~Timer()
+{
+    std::chrono::duration<double> wall =
+        std::chrono::steady_clock::now() - m_start;
+    m_stats.addTime(m_phase, wall.count(),
+        StageStats::threadCpuTime() - m_cpuStart);
+}
+
+
+StageStats::StageStats()
+{
+    reset();
+}
+
+
+void StageStats::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::fill(m_wall, m_wall + NumPhases, 0.0);
+    std::fill(m_cpu, m_cpu + NumPhases, 0.0);
+    m_pointsIn = 0;
+    m_pointsOut = 0;
+    m_bytesRead = 0;
+    m_bytesWritten = 0;
+    m_tableMemory = 0;
+}
+
+
+void StageStats::addTime(Phase phase, double wall, double cpu)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wall[phase] += wall;
+    m_cpu[phase] += cpu;
+}
+
+
+void StageStats::addPointsIn(point_count_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pointsIn += count;
+}
+
+
+void StageStats::addPointsOut(point_count_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pointsOut += count;
+}
+
+
+void StageStats::addBytesRead(uint64_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bytesRead += count;
+}
+
+
+void StageStats::addBytesWritten(uint64_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bytesWritten += count;
+}
+
+
+void StageStats::noteTableMemory(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tableMemory = (std::max)(m_tableMemory, bytes);
+}
+
+
+double StageStats::wallTime(Phase phase) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_wall[phase];
+}
+
+
+double StageStats::cpuTime(Phase phase) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cpu[phase];
+}
+
+
+point_count_t StageStats::pointsIn() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pointsIn;
+}
+
+
+point_count_t StageStats::pointsOut() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pointsOut;
+}
+
+
+uint64_t StageStats::bytesRead() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytesRead;
+}
+
+
+uint64_t StageStats::bytesWritten() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytesWritten;
+}
+
+
+uint64_t StageStats::tableMemory() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tableMemory;
+}
+
+
+std::string StageStats::phaseName(Phase phase)
+{
+    switch (phase)
+    {
+    case Prepare:
+        return "prepare";
+    case Ready:
+        return "ready";
+    case Run:
+        return "run";
+    case Process:
+        return "process";
+    case Done:
+        return "done";
+    default:
+        return "";
+    }
+}
+
+
+void StageStats::toMetadata(MetadataNode parent) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    MetadataNode timing = parent.add("timing");
+    double wall = 0;
+    double cpu = 0;
+    for (int i = 0; i < NumPhases; ++i)
+    {
+        std::string name = phaseName((Phase)i);
+        timing.add(name + "_wall", m_wall[i], "Elapsed time in seconds");
+        timing.add(name + "_cpu", m_cpu[i], "CPU time in seconds");
+        wall += m_wall[i];
+        cpu += m_cpu[i];
+    }
+    timing.add("total_wall", wall, "Elapsed time in seconds");
+    timing.add("total_cpu", cpu, "CPU time in seconds");
+    timing.add("points_in", m_pointsIn);
+    timing.add("points_out", m_pointsOut);
+    timing.add("bytes_read", m_bytesRead);
+    timing.add("bytes_written", m_bytesWritten);
+    timing.add("table_memory", m_tableMemory,
+        "Peak bytes of point data held by the point table");
+}
+
+
+double StageStats::threadCpuTime()
+{
+#ifdef _WIN32
+    FILETIME create, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &create, &exit, &kernel, &user))
+        return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    // FILETIME units are 100 nanoseconds.
+    return (k.QuadPart + u.QuadPart) / 1e7;
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+} // namespace pdal
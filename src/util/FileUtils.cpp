@@ -34,6 +34,19 @@
 
 #include <sys/stat.h>
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -350,6 +363,124 @@ std::string extension(const std::string& filename)
     return filename.substr(idx);
 }
 
+
+MapContext mapFile(const std::string& filename, uintmax_t pos,
+    uintmax_t size, bool sequential)
+{
+    MapContext ctx;
+
+    if (!fileExists(filename))
+    {
+        ctx.m_error = "File '" + filename + "' doesn't exist.";
+        return ctx;
+    }
+    uintmax_t fsize = fileSize(filename);
+    if (pos > fsize)
+    {
+        ctx.m_error = "Map position beyond end of file '" + filename + "'.";
+        return ctx;
+    }
+    if (size == 0)
+        size = fsize - pos;
+    if (pos + size > fsize)
+    {
+        ctx.m_error = "Map size extends beyond end of file '" +
+            filename + "'.";
+        return ctx;
+    }
+    if (size == 0)
+    {
+        ctx.m_error = "Can't map zero bytes of file '" + filename + "'.";
+        return ctx;
+    }
+
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    uintmax_t align = info.dwAllocationGranularity;
+#else
+    uintmax_t align = (uintmax_t)sysconf(_SC_PAGESIZE);
+#endif
+    // The mapping has to start on a page boundary.
+    uintmax_t basePos = pos - (pos % align);
+    size_t baseSize = (size_t)(size + (pos - basePos));
+
+#ifdef _WIN32
+    HANDLE fh = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        NULL, OPEN_EXISTING,
+        sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE)
+    {
+        ctx.m_error = "Can't open '" + filename + "' for mapping.";
+        return ctx;
+    }
+    HANDLE mh = CreateFileMapping(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(fh);
+    if (mh == NULL)
+    {
+        ctx.m_error = "Can't create mapping for '" + filename + "'.";
+        return ctx;
+    }
+    ctx.m_base = MapViewOfFile(mh, FILE_MAP_READ, (DWORD)(basePos >> 32),
+        (DWORD)(basePos & 0xFFFFFFFF), baseSize);
+    if (ctx.m_base == NULL)
+    {
+        CloseHandle(mh);
+        ctx.m_base = nullptr;
+        ctx.m_error = "Can't map view of '" + filename + "'.";
+        return ctx;
+    }
+    ctx.m_handle = mh;
+#else
+    ctx.m_fd = ::open(filename.c_str(), O_RDONLY);
+    if (ctx.m_fd == -1)
+    {
+        ctx.m_error = "Can't open '" + filename + "' for mapping: " +
+            strerror(errno);
+        return ctx;
+    }
+    void *base = ::mmap(0, baseSize, PROT_READ, MAP_SHARED, ctx.m_fd,
+        (off_t)basePos);
+    if (base == MAP_FAILED)
+    {
+        ctx.m_error = "Can't map '" + filename + "': " + strerror(errno);
+        ::close(ctx.m_fd);
+        ctx.m_fd = -1;
+        return ctx;
+    }
+    if (sequential)
+        ::madvise(base, baseSize, MADV_SEQUENTIAL);
+    ctx.m_base = base;
+#endif
+    ctx.m_baseSize = baseSize;
+    ctx.m_addr = (char *)ctx.m_base + (pos - basePos);
+    ctx.m_size = (size_t)size;
+    return ctx;
+}
+
+
+MapContext unmapFile(MapContext ctx)
+{
+    if (!ctx.m_base)
+        return ctx;
+#ifdef _WIN32
+    if (!UnmapViewOfFile(ctx.m_base))
+        ctx.m_error = "Couldn't unmap file.";
+    CloseHandle((HANDLE)ctx.m_handle);
+    ctx.m_handle = nullptr;
+#else
+    if (::munmap(ctx.m_base, ctx.m_baseSize) == -1)
+        ctx.m_error = "Couldn't unmap file: " + std::string(strerror(errno));
+    ::close(ctx.m_fd);
+    ctx.m_fd = -1;
+#endif
+    ctx.m_base = nullptr;
+    ctx.m_baseSize = 0;
+    ctx.m_addr = nullptr;
+    ctx.m_size = 0;
+    return ctx;
+}
+
 } // namespace FileUtils
 
 } // namespace pdal
@@ -0,0 +1,184 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+ThreadPool::ThreadPool(std::size_t numThreads) : m_outstanding(0),
+    m_running(true)
+{
+    if (numThreads == 0)
+        numThreads = 1;
+    for (std::size_t i = 0; i < numThreads; ++i)
+        m_threads.push_back(std::thread([this](){ work(); }));
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    try
+    {
+        join();
+    }
+    catch (...)
+    {
+        // Destructors mustn't throw.  Errors should have been collected
+        // with await() or join().
+    }
+}
+
+
+void ThreadPool::add(const std::function<void()>& task)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tasks.push(task);
+    m_outstanding++;
+    lock.unlock();
+    m_consumeCv.notify_one();
+}
+
+
+void ThreadPool::await()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_produceCv.wait(lock, [this](){ return m_outstanding == 0; });
+    lock.unlock();
+    rethrow();
+}
+
+
+void ThreadPool::join()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_produceCv.wait(lock, [this](){ return m_outstanding == 0; });
+    m_running = false;
+    lock.unlock();
+    m_consumeCv.notify_all();
+
+    for (std::thread& t : m_threads)
+        if (t.joinable())
+            t.join();
+    rethrow();
+}
+
+
+std::size_t ThreadPool::hardwareThreads()
+{
+    std::size_t n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+
+std::size_t ThreadPool::threadsFor(std::size_t n, std::size_t maxThreads,
+    std::size_t minPerThread)
+{
+    std::size_t numThreads = minPerThread ? n / minPerThread : n;
+    if (numThreads > maxThreads)
+        numThreads = maxThreads;
+    return numThreads ? numThreads : 1;
+}
+
+
+void ThreadPool::parallelFor(std::size_t n, std::size_t numThreads,
+    const std::function<void(std::size_t, std::size_t, std::size_t)>& f)
+{
+    if (numThreads <= 1)
+    {
+        f(0, 0, n);
+        return;
+    }
+
+    ThreadPool pool(numThreads);
+    std::size_t chunk = (n + numThreads - 1) / numThreads;
+    std::size_t i = 0;
+    for (std::size_t begin = 0; begin < n; begin += chunk)
+    {
+        std::size_t end = (std::min)(n, begin + chunk);
+        pool.add([&f, i, begin, end](){ f(i, begin, end); });
+        i++;
+    }
+    pool.join();
+}
+
+
+void ThreadPool::rethrow()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    std::exception_ptr err = m_error;
+    m_error = nullptr;
+    lock.unlock();
+
+    if (err)
+        std::rethrow_exception(err);
+}
+
+
+void ThreadPool::work()
+{
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_consumeCv.wait(lock,
+            [this](){ return !m_running || !m_tasks.empty(); });
+        if (m_tasks.empty())
+            break;
+
+        std::function<void()> task = m_tasks.front();
+        m_tasks.pop();
+        lock.unlock();
+
+        std::exception_ptr err;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            err = std::current_exception();
+        }
+
+        lock.lock();
+        if (err && !m_error)
+            m_error = err;
+        if (--m_outstanding == 0)
+            m_produceCv.notify_all();
+    }
+}
+
+} // namespace pdal
+
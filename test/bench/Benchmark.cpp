@@ -0,0 +1,722 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+// Benchmarks for the core readers, writers, filters and spatial indexes.
+// Each benchmark is run a number of times and the fastest run is reported,
+// along with the mean, as a rate of points (or queries) per second.
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_config.hpp>
+#include <pdal/pdal_defines.h>
+#include <pdal/KDIndex.hpp>
+#include <pdal/Options.hpp>
+#include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/QuadIndex.hpp>
+#include <pdal/Stage.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/Utils.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Bounds of generated points.  Geographic so that the same points can be
+// reprojected.
+const double XMIN = -100.0;
+const double XMAX = -99.0;
+const double YMIN = 40.0;
+const double YMAX = 41.0;
+const double ZMIN = 0.0;
+const double ZMAX = 100.0;
+
+// A benchmark runs once and returns the number of points (or queries)
+// processed.  It sets 'seconds' to the time taken by the code of interest.
+typedef std::function<point_count_t(double& seconds)> BenchFunc;
+
+struct Result
+{
+    std::string m_name;
+    point_count_t m_count;
+    double m_best;
+    double m_mean;
+};
+
+
+class Timer
+{
+public:
+    Timer() : m_start(std::chrono::steady_clock::now())
+    {}
+
+    double elapsed() const
+    {
+        std::chrono::duration<double> d =
+            std::chrono::steady_clock::now() - m_start;
+        return d.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+
+// Time spent by a stage in everything but prepare().
+double stageTime(const Stage& s)
+{
+    const StageStats& stats = s.stats();
+
+    double t = 0;
+    for (int phase = StageStats::Ready; phase < StageStats::NumPhases;
+        ++phase)
+        t += stats.wallTime((StageStats::Phase)phase);
+    return t;
+}
+
+
+class Benchmark
+{
+public:
+    Benchmark() : m_count(0), m_repeat(0)
+    {}
+
+    int run(int argc, char *argv[]);
+
+private:
+    void addArgs(ProgramArgs& args);
+    bool selected(const std::string& name) const;
+    void measure(const std::string& name, BenchFunc func);
+    void output(std::ostream& out) const;
+
+    Stage& fauxReader(StageFactory& factory);
+    std::string tempFile(const std::string& name) const;
+    void makeFiles();
+    void makeView();
+
+    void ioBenchmarks();
+    void streamBenchmarks();
+    void filterBenchmarks();
+    void indexBenchmarks();
+
+    point_count_t write(const std::string& driver,
+        const std::string& filename, Options opts, double& seconds);
+    point_count_t read(const std::string& driver, const std::string& filename,
+        double& seconds);
+    point_count_t translate(bool stream, double& seconds);
+    point_count_t filter(const std::string& driver, Options opts,
+        double& seconds);
+
+    point_count_t m_count;
+    point_count_t m_repeat;
+    std::string m_match;
+    std::string m_format;
+    std::string m_outputFile;
+    std::string m_tempDir;
+    StringList m_matches;
+
+    // Files written for the read benchmarks, by name.
+    std::vector<std::pair<std::string, std::string>> m_files;
+    std::vector<Result> m_results;
+
+    std::unique_ptr<PointTable> m_table;
+    PointViewPtr m_view;
+};
+
+
+void Benchmark::addArgs(ProgramArgs& args)
+{
+    args.add("count", "Number of points to generate", m_count,
+        (point_count_t)1000000);
+    args.add("repeat", "Number of times to run each benchmark", m_repeat,
+        (point_count_t)3);
+    args.add("match", "Comma-separated list of strings.  Only benchmarks "
+        "whose names contain one of the strings are run", m_match);
+    args.add("format", "Output format ('text', 'csv' or 'json')", m_format,
+        "text");
+    args.add("output,o", "Output filename (default: standard output)",
+        m_outputFile);
+    args.add("tempdir", "Directory for generated files", m_tempDir, ".");
+}
+
+
+int Benchmark::run(int argc, char *argv[])
+{
+    ProgramArgs args;
+    addArgs(args);
+    try
+    {
+        args.parse(argc - 1, argv + 1);
+    }
+    catch (arg_error& e)
+    {
+        std::cerr << "pdal_bench: " << e.m_error << std::endl;
+        std::cerr << "usage: pdal_bench [options]" << std::endl;
+        args.dump(std::cerr, 2, 80);
+        return 1;
+    }
+    if (m_format != "text" && m_format != "csv" && m_format != "json")
+    {
+        std::cerr << "pdal_bench: invalid output format '" << m_format <<
+            "'." << std::endl;
+        return 1;
+    }
+    if (m_count == 0 || m_repeat == 0)
+    {
+        std::cerr << "pdal_bench: count and repeat must be positive." <<
+            std::endl;
+        return 1;
+    }
+    m_matches = Utils::split2(m_match, ',');
+
+    try
+    {
+        makeFiles();
+        makeView();
+        ioBenchmarks();
+        streamBenchmarks();
+        filterBenchmarks();
+        indexBenchmarks();
+    }
+    catch (pdal_error& e)
+    {
+        std::cerr << "pdal_bench: " << e.what() << std::endl;
+        for (auto& f : m_files)
+            FileUtils::deleteFile(f.second);
+        return 1;
+    }
+    for (auto& f : m_files)
+        FileUtils::deleteFile(f.second);
+
+    if (m_outputFile.empty())
+        output(std::cout);
+    else
+    {
+        std::ostream *out = FileUtils::createFile(m_outputFile);
+        if (!out)
+        {
+            std::cerr << "pdal_bench: can't create output file '" <<
+                m_outputFile << "'." << std::endl;
+            return 1;
+        }
+        output(*out);
+        FileUtils::closeFile(out);
+    }
+    return 0;
+}
+
+
+bool Benchmark::selected(const std::string& name) const
+{
+    if (m_matches.empty())
+        return true;
+    for (const std::string& m : m_matches)
+        if (name.find(m) != std::string::npos)
+            return true;
+    return false;
+}
+
+
+void Benchmark::measure(const std::string& name, BenchFunc func)
+{
+    if (!selected(name))
+        return;
+
+    Result r;
+    r.m_name = name;
+    r.m_count = 0;
+    r.m_best = (std::numeric_limits<double>::max)();
+    r.m_mean = 0;
+    for (point_count_t i = 0; i < m_repeat; ++i)
+    {
+        double seconds = 0;
+        r.m_count = func(seconds);
+        r.m_best = (std::min)(r.m_best, seconds);
+        r.m_mean += seconds;
+    }
+    r.m_mean /= m_repeat;
+    m_results.push_back(r);
+    std::cerr << "." << std::flush;
+}
+
+
+void Benchmark::output(std::ostream& out) const
+{
+    std::cerr << std::endl;
+
+    auto rate = [](const Result& r)
+        { return r.m_best > 0 ? r.m_count / r.m_best : 0.0; };
+
+    if (m_format == "json")
+    {
+        out << "{\n";
+        out << "  \"pdal_version\": \"" << GetFullVersionString() <<
+            "\",\n";
+        out << "  \"count\": " << m_count << ",\n";
+        out << "  \"repeat\": " << m_repeat << ",\n";
+        out << "  \"results\": [";
+        for (size_t i = 0; i < m_results.size(); ++i)
+        {
+            const Result& r = m_results[i];
+            out << (i ? "," : "") << "\n    { \"name\": \"" << r.m_name <<
+                "\", \"count\": " << r.m_count <<
+                ", \"best_seconds\": " << r.m_best <<
+                ", \"mean_seconds\": " << r.m_mean <<
+                ", \"rate\": " << std::fixed << std::setprecision(0) <<
+                rate(r) << " }";
+            out.unsetf(std::ios_base::floatfield);
+            out << std::setprecision(6);
+        }
+        out << "\n  ]\n}\n";
+    }
+    else if (m_format == "csv")
+    {
+        out << "name,count,best_seconds,mean_seconds,rate\n";
+        for (const Result& r : m_results)
+        {
+            out << r.m_name << "," << r.m_count << "," << r.m_best << "," <<
+                r.m_mean << "," << std::fixed << std::setprecision(0) <<
+                rate(r) << "\n";
+            out.unsetf(std::ios_base::floatfield);
+            out << std::setprecision(6);
+        }
+    }
+    else
+    {
+        out << "PDAL " << GetFullVersionString() << ", " <<
+            m_count << " points, best of " << m_repeat << "\n\n";
+        out << std::left << std::setw(28) << "benchmark" << std::right <<
+            std::setw(12) << "count" << std::setw(12) << "best(s)" <<
+            std::setw(12) << "mean(s)" << std::setw(14) << "rate(/s)" << "\n";
+        for (const Result& r : m_results)
+            out << std::left << std::setw(28) << r.m_name << std::right <<
+                std::setw(12) << r.m_count << std::fixed <<
+                std::setprecision(4) << std::setw(12) << r.m_best <<
+                std::setw(12) << r.m_mean << std::setprecision(0) <<
+                std::setw(14) << rate(r) << "\n";
+    }
+}
+
+
+Stage& Benchmark::fauxReader(StageFactory& factory)
+{
+    std::ostringstream bounds;
+    bounds << "([" << XMIN << "," << XMAX << "],[" << YMIN << "," << YMAX <<
+        "],[" << ZMIN << "," << ZMAX << "])";
+
+    Options opts;
+    opts.add("bounds", bounds.str());
+    opts.add("num_points", m_count);
+    opts.add("mode", "random");
+
+    Stage& reader = *factory.createStage("readers.faux");
+    reader.setOptions(opts);
+    return reader;
+}
+
+
+std::string Benchmark::tempFile(const std::string& name) const
+{
+    return FileUtils::toAbsolutePath("pdal_bench_" + name, m_tempDir);
+}
+
+
+// Write the files that are read by the read benchmarks.
+void Benchmark::makeFiles()
+{
+    double seconds;
+
+    std::string las = tempFile("read.las");
+    m_files.push_back(std::make_pair("las", las));
+    write("writers.las", las, Options(), seconds);
+
+#if defined(PDAL_HAVE_LASZIP) || defined(PDAL_HAVE_LAZPERF)
+    std::string laz = tempFile("read.laz");
+    m_files.push_back(std::make_pair("laz", laz));
+    Options lazOpts;
+#ifdef PDAL_HAVE_LASZIP
+    lazOpts.add("compression", "laszip");
+#else
+    lazOpts.add("compression", "lazperf");
+#endif
+    write("writers.las", laz, lazOpts, seconds);
+#endif
+
+    for (std::string format : { "point", "dimension", "byte" })
+    {
+        std::string bpf = tempFile("read_" + format + ".bpf");
+        m_files.push_back(std::make_pair("bpf_" + format, bpf));
+        Options bpfOpts;
+        bpfOpts.add("format", format);
+        write("writers.bpf", bpf, bpfOpts, seconds);
+    }
+}
+
+
+// Generate the points used by the index benchmarks.
+void Benchmark::makeView()
+{
+    StageFactory factory;
+
+    m_table.reset(new PointTable);
+    Stage& reader = fauxReader(factory);
+    reader.prepare(*m_table);
+    PointViewSet s = reader.execute(*m_table);
+    m_view = *s.begin();
+}
+
+
+point_count_t Benchmark::write(const std::string& driver,
+    const std::string& filename, Options opts, double& seconds)
+{
+    StageFactory factory;
+    PointTable table;
+
+    Stage& reader = fauxReader(factory);
+    opts.add("filename", filename);
+    Stage& writer = *factory.createStage(driver);
+    writer.setOptions(opts);
+    writer.setInput(reader);
+    writer.prepare(table);
+    writer.execute(table);
+    seconds = stageTime(writer);
+    return m_count;
+}
+
+
+point_count_t Benchmark::read(const std::string& driver,
+    const std::string& filename, double& seconds)
+{
+    StageFactory factory;
+    PointTable table;
+
+    Options opts;
+    opts.add("filename", filename);
+    Stage& reader = *factory.createStage(driver);
+    reader.setOptions(opts);
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    seconds = stageTime(reader);
+    return (*s.begin())->size();
+}
+
+
+void Benchmark::ioBenchmarks()
+{
+    using namespace std::placeholders;
+
+    std::string out = tempFile("write");
+    for (auto& f : m_files)
+    {
+        const std::string& name = f.first;
+        bool bpf = Utils::startsWith(name, "bpf_");
+        std::string driver = bpf ? "bpf" : "las";
+
+        Options opts;
+        if (bpf)
+            opts.add("format", name.substr(4));
+        else if (name == "laz")
+        {
+#ifdef PDAL_HAVE_LASZIP
+            opts.add("compression", "laszip");
+#else
+            opts.add("compression", "lazperf");
+#endif
+        }
+        measure(name + "_write", std::bind(&Benchmark::write, this,
+            "writers." + driver, out, opts, _1));
+        measure(name + "_read", std::bind(&Benchmark::read, this,
+            "readers." + driver, f.second, _1));
+    }
+    FileUtils::deleteFile(out);
+}
+
+
+// Read a LAS file, remove some points and write the result, either through
+// a point table or streaming.
+point_count_t Benchmark::translate(bool stream, double& seconds)
+{
+    StageFactory factory;
+
+    Options readOpts;
+    readOpts.add("filename", m_files.front().second);
+    Stage& reader = *factory.createStage("readers.las");
+    reader.setOptions(readOpts);
+
+    std::ostringstream limits;
+    limits << "Z[" << ZMIN << ":" << (ZMIN + ZMAX) / 2 << "]";
+    Options rangeOpts;
+    rangeOpts.add("limits", limits.str());
+    Stage& range = *factory.createStage("filters.range");
+    range.setOptions(rangeOpts);
+    range.setInput(reader);
+
+    std::string out = tempFile("translate.las");
+    Options writeOpts;
+    writeOpts.add("filename", out);
+    Stage& writer = *factory.createStage("writers.las");
+    writer.setOptions(writeOpts);
+    writer.setInput(range);
+
+    if (stream)
+    {
+        FixedPointTable table(10000);
+        writer.prepare(table);
+        Timer t;
+        writer.execute(table);
+        seconds = t.elapsed();
+    }
+    else
+    {
+        PointTable table;
+        writer.prepare(table);
+        Timer t;
+        writer.execute(table);
+        seconds = t.elapsed();
+    }
+    FileUtils::deleteFile(out);
+    return m_count;
+}
+
+
+void Benchmark::streamBenchmarks()
+{
+    using namespace std::placeholders;
+
+    measure("translate_table",
+        std::bind(&Benchmark::translate, this, false, _1));
+    measure("translate_stream",
+        std::bind(&Benchmark::translate, this, true, _1));
+}
+
+
+point_count_t Benchmark::filter(const std::string& driver, Options opts,
+    double& seconds)
+{
+    StageFactory factory;
+    PointTable table;
+
+    Stage& reader = fauxReader(factory);
+    Stage& f = *factory.createStage(driver);
+    f.setOptions(opts);
+    f.setInput(reader);
+    f.prepare(table);
+    f.execute(table);
+    seconds = stageTime(f);
+    return m_count;
+}
+
+
+void Benchmark::filterBenchmarks()
+{
+    using namespace std::placeholders;
+
+    auto add = [this](const std::string& driver, Options opts)
+    {
+        measure(driver, std::bind(&Benchmark::filter, this, driver, opts,
+            _1));
+    };
+
+    double xmid = (XMIN + XMAX) / 2;
+    double ymid = (YMIN + YMAX) / 2;
+
+    Options crop;
+    crop.add("bounds", BOX2D(XMIN, YMIN, xmid, ymid));
+    add("filters.crop", crop);
+
+    Options range;
+    std::ostringstream limits;
+    limits << "Z[" << ZMIN << ":" << (ZMIN + ZMAX) / 2 << "]";
+    range.add("limits", limits.str());
+    add("filters.range", range);
+
+    Options splitter;
+    splitter.add("length", (XMAX - XMIN) / 16);
+    add("filters.splitter", splitter);
+
+    Options chipper;
+    chipper.add("capacity", 5000);
+    add("filters.chipper", chipper);
+
+    add("filters.mortonorder", Options());
+
+    Options sort;
+    sort.add("dimension", "X");
+    add("filters.sort", sort);
+
+    Options reprojection;
+    reprojection.add("in_srs", "EPSG:4326");
+    reprojection.add("out_srs", "EPSG:3857");
+    add("filters.reprojection", reprojection);
+
+    add("filters.stats", Options());
+}
+
+
+void Benchmark::indexBenchmarks()
+{
+    const PointView& view = *m_view;
+
+    // Query around every n'th point so that the number of queries is
+    // independent of the number of points.  Loops stop at numQueries * step
+    // so that exactly numQueries queries are made.
+    point_count_t numQueries = (std::min)(m_count, (point_count_t)100000);
+    point_count_t step = m_count / numQueries;
+
+    // Radius that includes about sixteen points.
+    double area = (XMAX - XMIN) * (YMAX - YMIN);
+    double radius = std::sqrt(16 * area / (3.14159265358979 * m_count));
+    double radius3 = std::cbrt(16 * area * (ZMAX - ZMIN) /
+        (4.0 / 3.0 * 3.14159265358979 * m_count));
+
+    measure("index.kd2_build", [&view](double& seconds)
+    {
+        Timer t;
+        KD2Index index(view);
+        index.build();
+        seconds = t.elapsed();
+        return view.size();
+    });
+
+    measure("index.kd3_build", [&view](double& seconds)
+    {
+        Timer t;
+        KD3Index index(view);
+        index.build();
+        seconds = t.elapsed();
+        return view.size();
+    });
+
+    measure("index.quad_build", [&view](double& seconds)
+    {
+        Timer t;
+        QuadIndex index(view);
+        seconds = t.elapsed();
+        return view.size();
+    });
+
+    if (selected("index.kd2_knn") || selected("index.kd2_radius"))
+    {
+        KD2Index index(view);
+        index.build();
+
+        measure("index.kd2_knn", [&](double& seconds)
+        {
+            Timer t;
+            for (PointId idx = 0; idx < numQueries * step; idx += step)
+                index.neighbors(view.getFieldAs<double>(Dimension::Id::X, idx),
+                    view.getFieldAs<double>(Dimension::Id::Y, idx), 8);
+            seconds = t.elapsed();
+            return numQueries;
+        });
+
+        measure("index.kd2_radius", [&](double& seconds)
+        {
+            Timer t;
+            for (PointId idx = 0; idx < numQueries * step; idx += step)
+                index.radius(view.getFieldAs<double>(Dimension::Id::X, idx),
+                    view.getFieldAs<double>(Dimension::Id::Y, idx), radius);
+            seconds = t.elapsed();
+            return numQueries;
+        });
+    }
+
+    if (selected("index.kd3_knn") || selected("index.kd3_radius"))
+    {
+        KD3Index index(view);
+        index.build();
+
+        measure("index.kd3_knn", [&](double& seconds)
+        {
+            Timer t;
+            for (PointId idx = 0; idx < numQueries * step; idx += step)
+                index.neighbors(view.getFieldAs<double>(Dimension::Id::X, idx),
+                    view.getFieldAs<double>(Dimension::Id::Y, idx),
+                    view.getFieldAs<double>(Dimension::Id::Z, idx), 8);
+            seconds = t.elapsed();
+            return numQueries;
+        });
+
+        measure("index.kd3_radius", [&](double& seconds)
+        {
+            Timer t;
+            for (PointId idx = 0; idx < numQueries * step; idx += step)
+                index.radius(view.getFieldAs<double>(Dimension::Id::X, idx),
+                    view.getFieldAs<double>(Dimension::Id::Y, idx),
+                    view.getFieldAs<double>(Dimension::Id::Z, idx), radius3);
+            seconds = t.elapsed();
+            return numQueries;
+        });
+    }
+
+    if (selected("index.quad_bounds"))
+    {
+        QuadIndex index(view);
+
+        measure("index.quad_bounds", [&](double& seconds)
+        {
+            Timer t;
+            for (PointId idx = 0; idx < numQueries * step; idx += step)
+            {
+                double x = view.getFieldAs<double>(Dimension::Id::X, idx);
+                double y = view.getFieldAs<double>(Dimension::Id::Y, idx);
+                index.getPoints(x - radius, y - radius, x + radius,
+                    y + radius);
+            }
+            seconds = t.elapsed();
+            return numQueries;
+        });
+    }
+}
+
+} // unnamed namespace
+
+
+int main(int argc, char *argv[])
+{
+    Benchmark bench;
+    return bench.run(argc, argv);
+}
@@ -202,3 +202,30 @@ TEST(FileUtilsTest, stem)
     EXPECT_EQ(FileUtils::stem("."), ".");
     EXPECT_EQ(FileUtils::stem(".."), "..");
 }
+
+TEST(FileUtilsTest, map)
+{
+    std::string filename(Support::datapath("las/simple.las"));
+    std::string contents = FileUtils::readFileIntoString(filename);
+
+    FileUtils::MapContext ctx = FileUtils::mapFile(filename);
+    ASSERT_TRUE(ctx.addr()) << ctx.what();
+    EXPECT_EQ(ctx.size(), contents.size());
+    EXPECT_EQ(memcmp(ctx.addr(), contents.data(), contents.size()), 0);
+    ctx = FileUtils::unmapFile(ctx);
+    EXPECT_FALSE(ctx.addr());
+
+    // Positions that aren't page-aligned are handled.
+    ctx = FileUtils::mapFile(filename, 227, 100, true);
+    ASSERT_TRUE(ctx.addr()) << ctx.what();
+    EXPECT_EQ(ctx.size(), 100u);
+    EXPECT_EQ(memcmp(ctx.addr(), contents.data() + 227, 100), 0);
+    ctx = FileUtils::unmapFile(ctx);
+
+    ctx = FileUtils::mapFile(filename, contents.size() - 10, 100);
+    EXPECT_FALSE(ctx.addr());
+    EXPECT_TRUE(ctx.what().size());
+
+    ctx = FileUtils::mapFile(Support::temppath("nonexistent.file"));
+    EXPECT_FALSE(ctx.addr());
+}
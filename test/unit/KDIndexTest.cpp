@@ -288,3 +288,74 @@ TEST(KDIndex, radius3D)
     EXPECT_EQ(ids[4], 4u);
 }
 
+
+TEST(KDIndex, batch)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    // Enough points that the tree is built on more than one thread.
+    PointId id = 0;
+    for (int i = 0; i < 300; ++i)
+        for (int j = 0; j < 300; ++j)
+        {
+            view.setField(Dimension::Id::X, id, i + (j % 7) * .01);
+            view.setField(Dimension::Id::Y, id, j + (i % 5) * .01);
+            view.setField(Dimension::Id::Z, id, (i * j) % 11);
+            id++;
+        }
+
+    KD3Index serial(view);
+    serial.build();
+    KD3Index threaded(view);
+    threaded.build(4);
+
+    std::vector<double> positions;
+    for (PointId idx = 0; idx < view.size(); idx += 97)
+    {
+        positions.push_back(view.getFieldAs<double>(Dimension::Id::X, idx));
+        positions.push_back(view.getFieldAs<double>(Dimension::Id::Y, idx));
+        positions.push_back(view.getFieldAs<double>(Dimension::Id::Z, idx));
+    }
+    size_t count = positions.size() / 3;
+
+    std::vector<PointId> ids;
+    std::vector<double> dists;
+    EXPECT_EQ(threaded.knnSearch(positions, 8, ids, dists, 4), 8u);
+    ASSERT_EQ(ids.size(), count * 8);
+    ASSERT_EQ(dists.size(), count * 8);
+
+    std::vector<size_t> offsets;
+    std::vector<PointId> radiusIds;
+    threaded.radiusSearch(positions, 2.5, offsets, radiusIds, 4);
+    ASSERT_EQ(offsets.size(), count + 1);
+    EXPECT_EQ(offsets[count], radiusIds.size());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const double *pos = positions.data() + i * 3;
+
+        std::vector<PointId> expected =
+            serial.neighbors(pos[0], pos[1], pos[2], 8);
+        for (size_t j = 0; j < 8; ++j)
+            EXPECT_EQ(ids[i * 8 + j], expected[j]);
+        EXPECT_DOUBLE_EQ(dists[i * 8], 0.0);
+
+        expected = serial.radius(pos[0], pos[1], pos[2], 2.5);
+        ASSERT_EQ(offsets[i + 1] - offsets[i], expected.size());
+        for (size_t j = 0; j < expected.size(); ++j)
+            EXPECT_EQ(radiusIds[offsets[i] + j], expected[j]);
+    }
+
+    // A view with no points.
+    PointView empty(table);
+    KD2Index emptyIndex(empty);
+    emptyIndex.build(4);
+    EXPECT_EQ(emptyIndex.neighbors(0, 0, 5).size(), 0u);
+    EXPECT_EQ(emptyIndex.radius(0, 0, 5).size(), 0u);
+}
@@ -71,6 +71,87 @@ TEST(PipelineManagerTest, basic)
 }
 
 
+TEST(PipelineManagerTest, threads)
+{
+    auto run = [](std::size_t threads, point_count_t& numViews)
+    {
+        PipelineManager mgr;
+        mgr.setThreads(threads);
+
+        Options optsR;
+        optsR.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage& reader = mgr.addReader("readers.las");
+        reader.setOptions(optsR);
+
+        Options optsS;
+        optsS.add("length", 500);
+        Stage& splitter = mgr.addFilter("filters.splitter");
+        splitter.setInput(reader);
+        splitter.setOptions(optsS);
+
+        Options optsF;
+        optsF.add("limits", "Intensity[0:100]");
+        Stage& range = mgr.addFilter("filters.range");
+        range.setInput(splitter);
+        range.setOptions(optsF);
+        EXPECT_EQ(range.threads(), threads);
+
+        point_count_t np = mgr.execute();
+        numViews = mgr.views().size();
+        return np;
+    };
+
+    point_count_t serialViews;
+    point_count_t threadedViews;
+    point_count_t serial = run(1, serialViews);
+    point_count_t threaded = run(4, threadedViews);
+    EXPECT_GT(serialViews, 1u);
+    EXPECT_EQ(serialViews, threadedViews);
+    EXPECT_GT(serial, 0u);
+    EXPECT_EQ(serial, threaded);
+}
+
+
+TEST(PipelineManagerTest, timing)
+{
+    auto run = [](bool timing)
+    {
+        PipelineManager mgr;
+        mgr.setTiming(timing);
+
+        Options optsR;
+        optsR.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage& reader = mgr.addReader("readers.las");
+        reader.setOptions(optsR);
+
+        Options optsF;
+        optsF.add("limits", "Intensity[0:100]");
+        Stage& range = mgr.addFilter("filters.range");
+        range.setInput(reader);
+        range.setOptions(optsF);
+
+        point_count_t np = mgr.execute();
+
+        EXPECT_EQ(reader.stats().pointsOut(), 1065u);
+        EXPECT_GT(reader.stats().bytesRead(), 0u);
+        EXPECT_EQ(range.stats().pointsIn(), 1065u);
+        EXPECT_EQ(range.stats().pointsOut(), np);
+        EXPECT_GT(range.stats().tableMemory(), 0u);
+
+        MetadataNode m = range.getMetadata().findChild("timing");
+        EXPECT_EQ(m.valid(), timing);
+        if (timing)
+        {
+            EXPECT_EQ(m.findChild("points_out").value<point_count_t>(), np);
+            EXPECT_GE(m.findChild("total_wall").value<double>(), 0.0);
+        }
+    };
+
+    run(false);
+    run(true);
+}
+
+
 //ABELL - Mosaic
 /**
 TEST(PipelineManagerTest, PipelineManagerTest_test2)
@@ -36,6 +36,12 @@
 
 #include <pdal/PluginManager.hpp>
 #include <pdal/Filter.hpp>
+#include <pdal/pdal_defines.h>
+#include <pdal/util/FileUtils.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
 
 #include "Support.hpp"
 
@@ -109,5 +115,114 @@ TEST(PluginManagerTest, CreateObject)
     EXPECT_NE(p.get(), nullptr);
 }
 
+namespace
+{
+
+// Set an environment variable for the life of the object, restoring its
+// previous value (or absence) afterwards.
+class ScopedEnv
+{
+public:
+    ScopedEnv(const std::string& name, const std::string& value) :
+        m_name(name)
+    {
+        const char *old = getenv(name.c_str());
+        m_set = (old != nullptr);
+        if (m_set)
+            m_old = old;
+        set(value);
+    }
+
+    ~ScopedEnv()
+    {
+        if (m_set)
+            set(m_old);
+        else
+        {
+#ifdef _WIN32
+            _putenv_s(m_name.c_str(), "");
+#else
+            unsetenv(m_name.c_str());
+#endif
+        }
+    }
+
+private:
+    std::string m_name;
+    std::string m_old;
+    bool m_set;
+
+    void set(const std::string& value)
+    {
+#ifdef _WIN32
+        _putenv_s(m_name.c_str(), value.c_str());
+#else
+        setenv(m_name.c_str(), value.c_str(), 1);
+#endif
+    }
+};
+
+} // unnamed namespace
+
+// Stages listed in an up-to-date manifest are known without loading the
+// library that provides them.
+TEST(PluginManagerTest, Manifest)
+{
+    std::string dir = Support::temppath("plugin_manifest_test");
+    FileUtils::deleteDirectory(dir);
+    FileUtils::createDirectory(dir);
+
+    // Not a real library.  Loading it would fail and register nothing.
+    std::string lib = dir + "/libpdal_plugin_filter_manifesttest" +
+#if defined(__APPLE__) && defined(__MACH__)
+        ".dylib";
+#elif defined _WIN32
+        ".dll";
+#else
+        ".so";
+#endif
+    std::ostream *out = FileUtils::createFile(lib);
+    *out << "not a library";
+    FileUtils::closeFile(out);
+    lib = FileUtils::toAbsolutePath(lib);
+
+    struct tm t;
+    char mtime[32];
+    FileUtils::fileTimes(lib, NULL, &t);
+    strftime(mtime, sizeof(mtime), "%Y%m%d%H%M%S", &t);
+
+    std::string manifest = dir + "/manifest.txt";
+    out = FileUtils::createFile(manifest, false);
+    *out << "# PDAL plugin manifest " << PDAL_VERSION_STRING << "\n";
+    *out << "library\t" << lib << "\t" << mtime << "\t" <<
+        FileUtils::fileSize(lib) << "\n";
+    *out << "stage\tfilters.manifesttest\t" << PF_PluginType_Filter <<
+        "\tA stage from the manifest\thttp://pdal.io\n";
+    FileUtils::closeFile(out);
+
+    {
+        ScopedEnv driverPath("PDAL_DRIVER_PATH", dir);
+        ScopedEnv manifestFile("PDAL_PLUGIN_MANIFEST", manifest);
+        PluginManager::loadAll(PF_PluginType_Filter);
+    }
+
+    StringList names = PluginManager::names(PF_PluginType_Filter);
+    EXPECT_TRUE(std::find(names.begin(), names.end(),
+        "filters.manifesttest") != names.end());
+    names = PluginManager::names(PF_PluginType_Reader);
+    EXPECT_TRUE(std::find(names.begin(), names.end(),
+        "filters.manifesttest") == names.end());
+    EXPECT_EQ(PluginManager::description("filters.manifesttest"),
+        "A stage from the manifest");
+
+    // Creating the stage loads the library, which fails here.  The failure
+    // isn't cached, so the library is dropped from the manifest.
+    EXPECT_EQ(PluginManager::createObject("filters.manifesttest"), nullptr);
+    std::string contents = FileUtils::readFileIntoString(manifest);
+    EXPECT_EQ(contents.find("manifesttest"), std::string::npos);
+
+    FileUtils::deleteDirectory(dir);
+}
+
 } // namespace pdal
 
@@ -34,7 +34,9 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/DimAccessor.hpp>
 #include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
 #include <las/LasReader.hpp>
 #include "Support.hpp"
 
@@ -178,3 +180,92 @@ TEST(PointTable, userView)
     EXPECT_TRUE(called);
 }
 
+
+TEST(PointTable, columnar)
+{
+    LasReader reader;
+
+    Options opts;
+    opts.add("filename", Support::datapath("las/simple.las"));
+    reader.setOptions(opts);
+
+    PointTable rowTable;
+    reader.prepare(rowTable);
+    PointViewSet rowSet = reader.execute(rowTable);
+    PointViewPtr rowView = *rowSet.begin();
+
+    ColumnPointTable colTable;
+    reader.prepare(colTable);
+    PointViewSet colSet = reader.execute(colTable);
+    PointViewPtr colView = *colSet.begin();
+
+    ASSERT_EQ(rowView->size(), colView->size());
+    double *x = colTable.column<double>(Dimension::Id::X);
+    for (PointId i = 0; i < rowView->size(); ++i)
+    {
+        for (auto id : rowView->dims())
+            EXPECT_DOUBLE_EQ(rowView->getFieldAs<double>(id, i),
+                colView->getFieldAs<double>(id, i));
+        EXPECT_DOUBLE_EQ(x[colView->rawId(i)],
+            rowView->getFieldAs<double>(Dimension::Id::X, i));
+    }
+    EXPECT_THROW(colTable.column<float>(Dimension::Id::X), pdal_error);
+
+    // Raw point access packs a row and writes changes back.
+    size_t xOffset = colTable.layout()->dimOffset(Dimension::Id::X);
+    char *row = colView->getPoint(1);
+    double rowX;
+    memcpy(&rowX, row + xOffset, sizeof(rowX));
+    EXPECT_DOUBLE_EQ(rowX, rowView->getFieldAs<double>(Dimension::Id::X, 1));
+    rowX += 10;
+    memcpy(row + xOffset, &rowX, sizeof(rowX));
+    EXPECT_DOUBLE_EQ(colView->getFieldAs<double>(Dimension::Id::X, 1),
+        rowView->getFieldAs<double>(Dimension::Id::X, 1) + 10);
+}
+
+
+TEST(PointTable, accessor)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+    layout->registerDim(Id::X, Type::Double);
+    layout->registerDim(Id::Intensity, Type::Unsigned16);
+    PointView view(table);
+
+    DimAccessor<double> x(*layout, Id::X);
+    DimAccessor<int8_t> xSmall(*layout, Id::X);
+    DimAccessor<int> intensity(*layout, Id::Intensity);
+    DimAccessor<double> red(*layout, Id::Red);
+    EXPECT_TRUE(x.valid());
+    EXPECT_FALSE(red.valid());
+
+    PointRef point(view, 0);
+    EXPECT_TRUE(x.set(point, 1000.5));
+    intensity.setUnchecked(point, 35);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, 0), 1000.5);
+    EXPECT_EQ(view.getFieldAs<int>(Id::Intensity, 0), 35);
+    EXPECT_DOUBLE_EQ(x.get(point), 1000.5);
+    EXPECT_EQ(intensity.get(point), 35);
+    EXPECT_EQ(intensity.getUnchecked(point), 35);
+    EXPECT_THROW(xSmall.get(point), pdal_error);
+    try
+    {
+        xSmall.get(point);
+    }
+    catch (const pdal_error& err)
+    {
+        // The message should report the stored value.
+        EXPECT_NE(std::string(err.what()).find("(1000.5)"),
+            std::string::npos);
+    }
+
+    // Out of range for the stored type - value isn't changed.
+    EXPECT_FALSE(intensity.set(point, -1));
+    EXPECT_EQ(intensity.get(point), 35);
+
+    // Missing dimensions read as zero and are never set.
+    EXPECT_DOUBLE_EQ(red.get(point), 0);
+    EXPECT_FALSE(red.set(point, 5));
+}
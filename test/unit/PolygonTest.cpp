@@ -40,6 +40,7 @@
 #include <pdal/PointView.hpp>
 #include <pdal/Options.hpp>
 
+#include <pdal/GlobalEnvironment.hpp>
 #include <pdal/Polygon.hpp>
 #include "Support.hpp"
 
@@ -142,6 +143,180 @@ TEST(PolygonTest, covers)
     EXPECT_EQ(covered, true);
 }
 
+TEST(PolygonTest, covers_rings)
+{
+    // Square with a square hole, plus a second, disjoint square.
+    pdal::Polygon p("MULTIPOLYGON (((0 0, 10 0, 10 10, 0 10, 0 0), "
+        "(4 4, 6 4, 6 6, 4 6, 4 4)), ((20 0, 30 0, 30 10, 20 10, 20 0)))");
+
+    EXPECT_TRUE(p.covers(1, 1));
+    EXPECT_TRUE(p.covers(25, 5));
+    EXPECT_FALSE(p.covers(5, 5));
+    EXPECT_FALSE(p.covers(15, 5));
+    EXPECT_FALSE(p.covers(-1, 5));
+    EXPECT_FALSE(p.covers(5, 11));
+
+    // Points on an edge or a vertex, including those of the hole,
+    // are covered.
+    EXPECT_TRUE(p.covers(0, 5));
+    EXPECT_TRUE(p.covers(5, 10));
+    EXPECT_TRUE(p.covers(10, 10));
+    EXPECT_TRUE(p.covers(4, 5));
+    EXPECT_TRUE(p.covers(6, 6));
+    EXPECT_TRUE(p.covers(30, 0));
+
+    std::vector<double> x { 1, 5, 15, 25, 0, 4 };
+    std::vector<double> y { 1, 5, 5, 5, 5, 5 };
+    std::vector<char> inside;
+    p.covers(x, y, inside);
+    ASSERT_EQ(inside.size(), x.size());
+    EXPECT_EQ(inside[0], 1);
+    EXPECT_EQ(inside[1], 0);
+    EXPECT_EQ(inside[2], 0);
+    EXPECT_EQ(inside[3], 1);
+    EXPECT_EQ(inside[4], 1);
+    EXPECT_EQ(inside[5], 1);
+}
+
+namespace
+{
+
+// Tests points against a polygon with GEOS directly, so that the results
+// of Polygon::covers(), which uses a PolygonIndex, can be checked.
+class GeosCovers
+{
+public:
+    GeosCovers(const std::string& wkt) :
+        m_ctx(pdal::GlobalEnvironment::get().geos()->ctx)
+    {
+        m_geom = GEOSGeomFromWKT_r(m_ctx, wkt.c_str());
+        m_prepGeom = GEOSPrepare_r(m_ctx, m_geom);
+    }
+
+    ~GeosCovers()
+    {
+        GEOSPreparedGeom_destroy_r(m_ctx, m_prepGeom);
+        GEOSGeom_destroy_r(m_ctx, m_geom);
+    }
+
+    bool covers(double x, double y) const
+    {
+        GEOSCoordSequence *coords = GEOSCoordSeq_create_r(m_ctx, 1, 2);
+        GEOSCoordSeq_setX_r(m_ctx, coords, 0, x);
+        GEOSCoordSeq_setY_r(m_ctx, coords, 0, y);
+        GEOSGeometry *p = GEOSGeom_createPoint_r(m_ctx, coords);
+        bool covers = (GEOSPreparedCovers_r(m_ctx, m_prepGeom, p) == 1);
+        GEOSGeom_destroy_r(m_ctx, p);
+        return covers;
+    }
+
+    // Append the vertices of every ring of the polygons.
+    void vertices(std::vector<double>& x, std::vector<double>& y) const
+    {
+        if (GEOSGeomTypeId_r(m_ctx, m_geom) == GEOS_POLYGON)
+            polygonVertices(m_geom, x, y);
+        else
+        {
+            int numGeoms = GEOSGetNumGeometries_r(m_ctx, m_geom);
+            for (int i = 0; i < numGeoms; ++i)
+                polygonVertices(GEOSGetGeometryN_r(m_ctx, m_geom, i), x, y);
+        }
+    }
+
+private:
+    GEOSContextHandle_t m_ctx;
+    GEOSGeometry *m_geom;
+    const GEOSPreparedGeometry *m_prepGeom;
+
+    void polygonVertices(const GEOSGeometry *poly, std::vector<double>& x,
+        std::vector<double>& y) const
+    {
+        ringVertices(GEOSGetExteriorRing_r(m_ctx, poly), x, y);
+        int numRings = GEOSGetNumInteriorRings_r(m_ctx, poly);
+        for (int i = 0; i < numRings; ++i)
+            ringVertices(GEOSGetInteriorRingN_r(m_ctx, poly, i), x, y);
+    }
+
+    void ringVertices(const GEOSGeometry *ring, std::vector<double>& x,
+        std::vector<double>& y) const
+    {
+        const GEOSCoordSequence *coords = GEOSGeom_getCoordSeq_r(m_ctx, ring);
+        unsigned int count;
+        GEOSCoordSeq_getSize_r(m_ctx, coords, &count);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            double vx, vy;
+            GEOSCoordSeq_getOrdinate_r(m_ctx, coords, i, 0, &vx);
+            GEOSCoordSeq_getOrdinate_r(m_ctx, coords, i, 1, &vy);
+            x.push_back(vx);
+            y.push_back(vy);
+        }
+    }
+};
+
+// Make sure the batch test agrees with GEOS and hits both cases.
+void checkBatch(const std::string& wkt, const std::vector<double>& x,
+    const std::vector<double>& y)
+{
+    pdal::Polygon p(wkt);
+    GeosCovers geos(wkt);
+
+    std::vector<char> inside;
+    p.covers(x, y, inside);
+    ASSERT_EQ(inside.size(), x.size());
+    size_t count = 0;
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        bool expected = geos.covers(x[i], y[i]);
+        EXPECT_EQ((bool)inside[i], expected) << "Point (" << x[i] << ", " <<
+            y[i] << ")";
+        if (expected)
+            count++;
+    }
+    EXPECT_GT(count, 0u);
+    EXPECT_LT(count, x.size());
+}
+
+} // unnamed namespace
+
+TEST(PolygonTest, covers_batch)
+{
+    // Square with a square hole, plus a disjoint triangle with a sloped
+    // edge.  Coordinates are small integers, so a grid with a spacing of
+    // .5 has points exactly inside, outside, in the hole, on vertices and
+    // on every edge, including the sloped one.
+    const std::string wkt("MULTIPOLYGON (((0 0, 10 0, 10 10, 0 10, 0 0), "
+        "(4 4, 6 4, 6 6, 4 6, 4 4)), ((20 0, 30 0, 20 10, 20 0)))");
+
+    std::vector<double> x, y;
+    for (int i = -4; i <= 64; ++i)
+        for (int j = -4; j <= 24; ++j)
+        {
+            x.push_back(i / 2.0);
+            y.push_back(j / 2.0);
+        }
+    checkBatch(wkt, x, y);
+}
+
+TEST(PolygonTest, covers_batch_file)
+{
+    const std::string wkt(getWKT());
+    pdal::Polygon p(wkt);
+    BOX3D b = p.bounds();
+
+    // Sample a grid over the polygon's bounds along with the polygon's
+    // vertices.
+    std::vector<double> x, y;
+    for (int i = 0; i <= 100; ++i)
+        for (int j = 0; j <= 100; ++j)
+        {
+            x.push_back(b.minx + (b.maxx - b.minx) * i / 100);
+            y.push_back(b.miny + (b.maxy - b.miny) * j / 100);
+        }
+    GeosCovers(wkt).vertices(x, y);
+    checkBatch(wkt, x, y);
+}
+
 TEST(PolygonTest, valid)
 {
     pdal::Polygon p(getWKT());
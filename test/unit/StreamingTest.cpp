@@ -34,6 +34,8 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <atomic>
+
 #include <pdal/Filter.hpp>
 #include <pdal/PointTable.hpp>
 #include <FauxReader.hpp>
@@ -106,3 +108,113 @@ TEST(Streaming, filter)
     f.execute(t);
     EXPECT_EQ(cnt, 400);
 }
+
+TEST(Streaming, overlapped)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    // Drop every other point in the first filter and make sure that the
+    // second filter sees the remaining points in order.
+    StreamCallbackFilter f1;
+    auto cb1 = [](PointRef& point)
+    {
+        return point.getFieldAs<int>(Dimension::Id::X) % 2 == 0;
+    };
+    f1.setCallback(cb1);
+    f1.setInput(r);
+
+    StreamCallbackFilter f2;
+    int cnt = 0;
+    int x = 0;
+    auto cb2 = [&cnt, &x](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X), x);
+        x += 2;
+        cnt++;
+        return true;
+    };
+    f2.setCallback(cb2);
+    f2.setInput(f1);
+    f2.setThreads(3);
+
+    FixedPointTable t(30);
+    f2.prepare(t);
+    f2.execute(t);
+    EXPECT_EQ(cnt, 500);
+}
+
+namespace
+{
+
+// Table that records the segments it's reset with and checks that their
+// points have all been seen by the last stage, in order.
+class CheckedResetTable : public FixedPointTable
+{
+public:
+    CheckedResetTable(point_count_t capacity, std::atomic<int>& written) :
+        FixedPointTable(capacity), m_written(written), m_consumed(0)
+    {}
+
+    virtual void resetSegment(PointId begin, point_count_t count)
+    {
+        m_consumed += (int)count;
+        EXPECT_EQ(m_written.load(), m_consumed);
+        for (PointId idx = begin; idx < begin + count; ++idx)
+        {
+            PointRef point(*this, idx);
+            EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X),
+                m_consumed - (int)(begin + count - idx));
+        }
+        m_segments.push_back(std::make_pair(begin, count));
+    }
+
+    std::vector<std::pair<PointId, point_count_t>> segments() const
+        { return m_segments; }
+
+private:
+    std::atomic<int>& m_written;
+    int m_consumed;
+    std::vector<std::pair<PointId, point_count_t>> m_segments;
+};
+
+} // unnamed namespace
+
+TEST(Streaming, overlappedReset)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    std::atomic<int> written(0);
+
+    StreamCallbackFilter f1;
+    f1.setCallback([](PointRef&){ return true; });
+    f1.setInput(r);
+
+    StreamCallbackFilter f2;
+    f2.setCallback([&written](PointRef&){ written++; return true; });
+    f2.setInput(f1);
+    f2.setThreads(3);
+
+    // The table is split into three segments of ten points, which are
+    // used in turn.  The reader finds the end of the data in the segment
+    // after the last full one, which is released empty.
+    CheckedResetTable t(30, written);
+    f2.prepare(t);
+    f2.execute(t);
+    EXPECT_EQ(written.load(), 1000);
+
+    std::vector<std::pair<PointId, point_count_t>> expected;
+    for (PointId i = 0; i < 100; ++i)
+        expected.push_back(std::make_pair((i % 3) * 10, 10));
+    expected.push_back(std::make_pair(10, 0));
+    EXPECT_EQ(t.segments(), expected);
+}
@@ -0,0 +1,154 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <string>
+
+#include <pdal/pdal_test_main.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+std::string appName()
+{
+    return Support::binpath("pdal delta");
+}
+
+std::string testFile()
+{
+    return Support::datapath("las/1.2-with-color.las");
+}
+
+// Get a statistic for a dimension from the summary output.
+double stat(const std::string& json, const std::string& dim,
+    const std::string& name)
+{
+    std::string::size_type pos = json.find("\"" + dim + "\":");
+    pos = json.find("\"" + name + "\": ", pos);
+    EXPECT_NE(pos, std::string::npos);
+    return std::stod(json.substr(pos + name.size() + 4));
+}
+
+std::string summary(int threads)
+{
+    std::string outfile(Support::temppath("delta.json"));
+    FileUtils::deleteFile(outfile);
+
+    const std::string cmd = appName() + " " + testFile() + " " +
+        Support::datapath("las/1.2-with-color-clipped.las") + " " +
+        outfile + " --threads=" + std::to_string(threads);
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    std::string json = FileUtils::readFileIntoString(outfile);
+    FileUtils::deleteFile(outfile);
+    return json;
+}
+
+} // unnamed namespace
+
+// Source points outside the clipped candidate are away from their nearest
+// neighbors.  The points are split among several tasks, whose statistics
+// are merged the same way however many threads run them.
+TEST(Delta, summary)
+{
+    std::string json = summary(1);
+    EXPECT_EQ(json, summary(4));
+    for (const std::string dim : { "X", "Y", "Z" })
+    {
+        double min = stat(json, dim, "min");
+        double max = stat(json, dim, "max");
+        double mean = stat(json, dim, "mean");
+        EXPECT_LT(min, max);
+        EXPECT_LE(min, mean);
+        EXPECT_GE(max, mean);
+    }
+    EXPECT_NE(stat(json, "X", "mean"), 0);
+}
+
+TEST(Delta, detail)
+{
+    std::string outfile(Support::temppath("delta.csv"));
+    FileUtils::deleteFile(outfile);
+
+    const std::string cmd = appName() + " " + testFile() + " " + testFile() +
+        " " + outfile + " --detail --chunk_size=100 --threads=2";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    // Every point is its own nearest neighbor, so all deltas are zero.
+    std::istream *in = FileUtils::openFile(outfile);
+    std::string line;
+    std::getline(*in, line);
+    EXPECT_EQ(line, "\"ID\",\"DeltaX\",\"DeltaY\",\"DeltaZ\"");
+    point_count_t count = 0;
+    while (std::getline(*in, line))
+    {
+        EXPECT_EQ(line, std::to_string(count) + ",0,0,0");
+        count++;
+    }
+    EXPECT_EQ(count, 1065U);
+    FileUtils::closeFile(in);
+    FileUtils::deleteFile(outfile);
+}
+
+TEST(Delta, binary)
+{
+    std::string outfile(Support::temppath("delta.bin"));
+    FileUtils::deleteFile(outfile);
+
+    const std::string cmd = appName() + " " + testFile() + " " + testFile() +
+        " " + outfile + " --detail --format=binary --chunk_size=100";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    // An ID and X, Y and Z deltas for each point.
+    EXPECT_EQ(FileUtils::fileSize(outfile),
+        1065U * (sizeof(uint64_t) + 3 * sizeof(double)));
+    FileUtils::deleteFile(outfile);
+}
+
+TEST(Delta, badOutput)
+{
+    const std::string cmd = appName() + " " + testFile() + " " + testFile() +
+        " " + Support::temppath("nosuchdir/delta.json");
+    std::string output;
+    EXPECT_NE(Utils::run_shell_command(cmd + " 2>&1", output), 0);
+    EXPECT_NE(output.find("Unable to open output file"), std::string::npos);
+}
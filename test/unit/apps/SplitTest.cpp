@@ -0,0 +1,139 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <string>
+
+#include <pdal/pdal_test_main.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+std::string appName()
+{
+    return Support::binpath("pdal split");
+}
+
+std::string outFilename(int i)
+{
+    return Support::temppath("split_" + std::to_string(i) + ".las");
+}
+
+// Count the points in each of the numbered output files and delete them.
+std::vector<point_count_t> collectCounts()
+{
+    std::vector<point_count_t> counts;
+    StageFactory f;
+
+    for (int i = 1; FileUtils::fileExists(outFilename(i)); ++i)
+    {
+        Stage *reader(f.createStage("readers.las"));
+        Options ops;
+        ops.add("filename", outFilename(i));
+        reader->setOptions(ops);
+        counts.push_back(reader->preview().m_pointCount);
+        FileUtils::deleteFile(outFilename(i));
+    }
+    return counts;
+}
+
+} // unnamed namespace
+
+// Splitting through spill files should produce the same tiles as
+// splitting in memory.
+TEST(Split, length)
+{
+    std::string in(Support::datapath("las/autzen_trim.las"));
+    std::string out(Support::temppath("split.las"));
+    std::string output;
+
+    std::string cmd = appName() + " --length 300 " + in + " " + out;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    std::vector<point_count_t> memCounts = collectCounts();
+
+    cmd = appName() + " --length 300 --memory 1 " + in + " " + out;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    std::vector<point_count_t> spillCounts = collectCounts();
+
+    EXPECT_GT(memCounts.size(), 1u);
+    EXPECT_EQ(memCounts, spillCounts);
+}
+
+// The memory held by tile buffers, including spare capacity, shouldn't
+// exceed the limit.
+TEST(Split, memory)
+{
+    std::string in(Support::datapath("las/autzen_trim.las"));
+    std::string out(Support::temppath("split.las"));
+    std::string output;
+
+    std::string cmd = appName() + " --length 100 --memory 1 --verbose 3 " +
+        in + " " + out + " 2>&1";
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    std::vector<point_count_t> counts = collectCounts();
+    EXPECT_GT(counts.size(), 1u);
+
+    const std::string tag("Peak tile buffer memory: ");
+    std::string::size_type pos = output.find(tag);
+    ASSERT_NE(pos, std::string::npos);
+    size_t peak = std::stoul(output.substr(pos + tag.size()));
+    EXPECT_GT(peak, 0u);
+    EXPECT_LE(peak, 1024u * 1024u);
+}
+
+TEST(Split, capacity)
+{
+    std::string in(Support::datapath("las/autzen_trim.las"));
+    std::string out(Support::temppath("split.las"));
+    std::string output;
+
+    std::string cmd = appName() + " --capacity 5000 --memory 1 " + in +
+        " " + out;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    std::vector<point_count_t> counts = collectCounts();
+
+    point_count_t total = 0;
+    for (auto c : counts)
+    {
+        EXPECT_LE(c, 5000u);
+        total += c;
+    }
+    EXPECT_EQ(total, 110000u);
+}
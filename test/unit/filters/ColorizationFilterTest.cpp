@@ -124,6 +124,25 @@ void testFileStreamed(const Options& filterOps, StringList dimNames,
     f2.execute(table);
 }
 
+PointViewPtr colorize(const Options& filterOps, PointTable& table)
+{
+    Options readerOps;
+    readerOps.add("filename",
+        Support::datapath("autzen/autzen-point-format-3.las"));
+
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    ColorizationFilter filter;
+    filter.setOptions(filterOps);
+    filter.setInput(reader);
+
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    return *viewSet.begin();
+}
+
 } // unnamed namespace
 
 // Test using the standard dimensions.
@@ -191,4 +210,68 @@ TEST(ColorizationFilterTest, test4)
     EXPECT_THROW(testFile(options, dims, 210, 205, 47175), pdal_error);
 }
 
+// A cache too small to hold more than one block must give the same
+// result as a large one.
+TEST(ColorizationFilterTest, cache)
+{
+    Options ops1;
+    ops1.add("raster", Support::datapath("autzen/autzen.jpg"));
+    Options ops2(ops1);
+    ops2.add("cache_size", 1);
+
+    PointTable table1;
+    PointTable table2;
+    PointViewPtr v1 = colorize(ops1, table1);
+    PointViewPtr v2 = colorize(ops2, table2);
+
+    ASSERT_EQ(v1->size(), v2->size());
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        EXPECT_EQ(v1->getFieldAs<uint16_t>(Dimension::Id::Red, i),
+            v2->getFieldAs<uint16_t>(Dimension::Id::Red, i));
+        EXPECT_EQ(v1->getFieldAs<uint16_t>(Dimension::Id::Blue, i),
+            v2->getFieldAs<uint16_t>(Dimension::Id::Blue, i));
+    }
+}
+
+TEST(ColorizationFilterTest, bilinear)
+{
+    Options ops1;
+    ops1.add("raster", Support::datapath("autzen/autzen.jpg"));
+    Options ops2(ops1);
+    ops2.add("interpolation", "bilinear");
+
+    PointTable table1;
+    PointTable table2;
+    PointViewPtr v1 = colorize(ops1, table1);
+    PointViewPtr v2 = colorize(ops2, table2);
+
+    // Interpolated values stay within the range of an 8-bit raster and
+    // differ from the nearest pixel somewhere.
+    ASSERT_EQ(v1->size(), v2->size());
+    bool differ = false;
+    for (PointId i = 0; i < v2->size(); ++i)
+    {
+        uint16_t r1 = v1->getFieldAs<uint16_t>(Dimension::Id::Red, i);
+        uint16_t r2 = v2->getFieldAs<uint16_t>(Dimension::Id::Red, i);
+        EXPECT_LE(r2, 255);
+        if (r1 != r2)
+            differ = true;
+    }
+    EXPECT_TRUE(differ);
+
+    Options ops3(ops1);
+    ops3.add("interpolation", "cubic");
+    PointTable table3;
+    EXPECT_THROW(colorize(ops3, table3), pdal_error);
+}
 
+TEST(ColorizationFilterTest, badBand)
+{
+    Options ops;
+    ops.add("raster", Support::datapath("autzen/autzen.jpg"));
+    ops.add("dimensions", "Red:4");
+
+    PointTable table;
+    EXPECT_THROW(colorize(ops, table), pdal_error);
+}
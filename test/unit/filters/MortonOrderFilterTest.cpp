@@ -0,0 +1,218 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (hobu@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <random>
+
+#include <MortonOrderFilter.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/StageWrapper.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Order the four corners of a square, given in an arbitrary order, and
+// return the order of the corners as "x,y" strings.
+std::vector<std::string> orderCorners(const std::string& order)
+{
+    Options opts;
+    opts.add("order", order);
+
+    MortonOrderFilter filter;
+    filter.setOptions(opts);
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    filter.prepare(table);
+
+    PointViewPtr view(new PointView(table));
+    double corners[][2] = { {1, 1}, {0, 1}, {1, 0}, {0, 0} };
+    for (PointId i = 0; i < 4; ++i)
+    {
+        view->setField(Dimension::Id::X, i, corners[i][0]);
+        view->setField(Dimension::Id::Y, i, corners[i][1]);
+    }
+
+    FilterWrapper::ready(filter, table);
+    FilterWrapper::filter(filter, *view);
+    FilterWrapper::done(filter, table);
+
+    std::vector<std::string> out;
+    for (PointId i = 0; i < view->size(); ++i)
+        out.push_back(
+            std::to_string(view->getFieldAs<int>(Dimension::Id::X, i)) +
+            "," +
+            std::to_string(view->getFieldAs<int>(Dimension::Id::Y, i)));
+    return out;
+}
+
+void checkFile(const std::string& order, size_t threads)
+{
+    StageFactory f;
+
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+    Stage *reader(f.createStage("readers.las"));
+    reader->setOptions(readerOps);
+
+    Options ops;
+    ops.add("order", order);
+    ops.add("code_dimension", "Code");
+    Stage *filter(f.createStage("filters.mortonorder"));
+    filter->setOptions(ops);
+    filter->setInput(*reader);
+    filter->setThreads(threads);
+
+    PointTable table;
+    filter->prepare(table);
+    PointViewSet s = filter->execute(table);
+    ASSERT_EQ(s.size(), 1u);
+    PointViewPtr view = *s.begin();
+    ASSERT_EQ(view->size(), 110000u);
+
+    Dimension::Id::Enum code = table.layout()->findDim("Code");
+    ASSERT_NE(code, Dimension::Id::Unknown);
+    for (PointId i = 1; i < view->size(); ++i)
+        EXPECT_LE(view->getFieldAs<uint64_t>(code, i - 1),
+            view->getFieldAs<uint64_t>(code, i));
+
+    // Points are reordered, not duplicated or dropped.
+    double sum = 0;
+    for (PointId i = 0; i < view->size(); ++i)
+        sum += view->getFieldAs<double>(Dimension::Id::X, i);
+    EXPECT_NEAR(sum / view->size(), 636546.405, .001);
+}
+
+// Order a set of scattered points using the given number of threads and
+// return the resulting view.
+PointViewPtr orderScattered(PointTableRef table, const std::string& order,
+    point_count_t count, size_t threads)
+{
+    Options opts;
+    opts.add("order", order);
+
+    MortonOrderFilter filter;
+    filter.setOptions(opts);
+    filter.setThreads(threads);
+    filter.prepare(table);
+
+    // Same seed on every call, so each call orders the same points.
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> coord(0, 1000);
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < count; ++i)
+    {
+        view->setField(Dimension::Id::X, i, coord(generator));
+        view->setField(Dimension::Id::Y, i, coord(generator));
+    }
+
+    FilterWrapper::ready(filter, table);
+    FilterWrapper::filter(filter, *view);
+    FilterWrapper::done(filter, table);
+    return view;
+}
+
+} // unnamed namespace
+
+TEST(MortonOrderFilterTest, corners)
+{
+    std::vector<std::string> morton = orderCorners("morton");
+    ASSERT_EQ(morton.size(), 4u);
+    EXPECT_EQ(morton[0], "0,0");
+    EXPECT_EQ(morton[1], "0,1");
+    EXPECT_EQ(morton[2], "1,0");
+    EXPECT_EQ(morton[3], "1,1");
+
+    std::vector<std::string> hilbert = orderCorners("hilbert");
+    ASSERT_EQ(hilbert.size(), 4u);
+    EXPECT_EQ(hilbert[0], "0,0");
+    EXPECT_EQ(hilbert[1], "0,1");
+    EXPECT_EQ(hilbert[2], "1,1");
+    EXPECT_EQ(hilbert[3], "1,0");
+}
+
+TEST(MortonOrderFilterTest, file)
+{
+    checkFile("morton", 1);
+    checkFile("morton", 4);
+    checkFile("hilbert", 1);
+}
+
+// 300000 points is enough that both computing the codes (100000 points
+// per thread) and sorting them (65536 points per thread) are split across
+// threads.  The order must match the single-threaded order exactly.
+TEST(MortonOrderFilterTest, threads)
+{
+    const point_count_t count = 300000;
+    for (const std::string order : { "morton", "hilbert" })
+    {
+        PointTable table1;
+        table1.layout()->registerDim(Dimension::Id::X);
+        table1.layout()->registerDim(Dimension::Id::Y);
+        PointViewPtr view1 = orderScattered(table1, order, count, 1);
+
+        PointTable table4;
+        table4.layout()->registerDim(Dimension::Id::X);
+        table4.layout()->registerDim(Dimension::Id::Y);
+        PointViewPtr view4 = orderScattered(table4, order, count, 4);
+
+        ASSERT_EQ(view1->size(), count);
+        ASSERT_EQ(view4->size(), count);
+        for (PointId i = 0; i < count; ++i)
+        {
+            ASSERT_EQ(view1->getFieldAs<double>(Dimension::Id::X, i),
+                view4->getFieldAs<double>(Dimension::Id::X, i)) << order <<
+                " point " << i;
+            ASSERT_EQ(view1->getFieldAs<double>(Dimension::Id::Y, i),
+                view4->getFieldAs<double>(Dimension::Id::Y, i)) << order <<
+                " point " << i;
+        }
+    }
+}
+
+TEST(MortonOrderFilterTest, badOrder)
+{
+    Options opts;
+    opts.add("order", "peano");
+
+    MortonOrderFilter filter;
+    filter.setOptions(opts);
+    PointTable table;
+    EXPECT_THROW(filter.prepare(table), pdal_error);
+}
@@ -36,6 +36,7 @@
 
 #include <pdal/SpatialReference.hpp>
 #include <pdal/PointView.hpp>
+#include <BufferReader.hpp>
 #include <LasReader.hpp>
 #include <ReprojectionFilter.hpp>
 #include <StreamCallbackFilter.hpp>
@@ -152,3 +153,127 @@ TEST(ReprojectionFilterTest, stream_test_1)
 }
 #endif
 
+#if defined(PDAL_HAVE_LIBGEOTIFF)
+// Make sure that transforming blocks of points on several threads gives
+// the same result as a single thread.
+TEST(ReprojectionFilterTest, threads)
+{
+    const char* epsg4326_wkt = "GEOGCS[\"WGS 84\",DATUM[\"WGS_1984\",SPHEROID[\"WGS 84\",6378137,298.257223563,AUTHORITY[\"EPSG\",\"7030\"]],AUTHORITY[\"EPSG\",\"6326\"]],PRIMEM[\"Greenwich\",0],UNIT[\"degree\",0.0174532925199433],AUTHORITY[\"EPSG\",\"4326\"]]";
+
+    PointTable table;
+
+    Options ops1;
+    ops1.add("filename", Support::datapath("las/utm15.las"));
+    LasReader reader;
+    reader.setOptions(ops1);
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr src = *viewSet.begin();
+
+    // Enough points for several blocks.  Each view gets its own copy of
+    // the points, since appendPoint() would share them between the views
+    // and between repeats of the same source point.
+    const point_count_t count = 300000;
+    PointViewPtr views[2];
+    for (PointViewPtr& v : views)
+    {
+        v = src->makeNew();
+        for (PointId i = 0; i < count; ++i)
+        {
+            PointId srcId = i % src->size();
+            v->setField(Dimension::Id::X, i,
+                src->getFieldAs<double>(Dimension::Id::X, srcId) + (i % 1000));
+            v->setField(Dimension::Id::Y, i,
+                src->getFieldAs<double>(Dimension::Id::Y, srcId));
+            v->setField(Dimension::Id::Z, i,
+                src->getFieldAs<double>(Dimension::Id::Z, srcId));
+        }
+        v->setSpatialReference(src->spatialReference());
+    }
+
+    PointViewPtr out[2];
+    for (size_t i = 0; i < 2; ++i)
+    {
+        BufferReader bufReader;
+        bufReader.addView(views[i]);
+
+        Options options;
+        options.add("out_srs", epsg4326_wkt);
+
+        ReprojectionFilter filter;
+        filter.setOptions(options);
+        filter.setInput(bufReader);
+        filter.setThreads(i == 0 ? 1 : 4);
+        filter.prepare(table);
+        PointViewSet s = filter.execute(table);
+        EXPECT_EQ(s.size(), 1u);
+        out[i] = *s.begin();
+    }
+
+    // No points fail, so the views are transformed in place.
+    EXPECT_EQ(out[0], views[0]);
+    EXPECT_EQ(out[1], views[1]);
+    ASSERT_EQ(out[0]->size(), count);
+    ASSERT_EQ(out[1]->size(), count);
+    for (PointId i = 0; i < count; ++i)
+    {
+        EXPECT_DOUBLE_EQ(out[0]->getFieldAs<double>(Dimension::Id::X, i),
+            out[1]->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_DOUBLE_EQ(out[0]->getFieldAs<double>(Dimension::Id::Y, i),
+            out[1]->getFieldAs<double>(Dimension::Id::Y, i));
+    }
+    double x, y, z;
+    getPoint(*out[1], x, y, z);
+    EXPECT_FLOAT_EQ(x, -93.351563);
+    EXPECT_FLOAT_EQ(y, 41.577148);
+}
+// Views run through the filter concurrently each get their own
+// transformation and must give the same result.
+TEST(ReprojectionFilterTest, views)
+{
+    const char* epsg4326_wkt = "GEOGCS[\"WGS 84\",DATUM[\"WGS_1984\",SPHEROID[\"WGS 84\",6378137,298.257223563,AUTHORITY[\"EPSG\",\"7030\"]],AUTHORITY[\"EPSG\",\"6326\"]],PRIMEM[\"Greenwich\",0],UNIT[\"degree\",0.0174532925199433],AUTHORITY[\"EPSG\",\"4326\"]]";
+
+    PointTable table;
+
+    Options ops1;
+    ops1.add("filename", Support::datapath("las/utm15.las"));
+    LasReader reader;
+    reader.setOptions(ops1);
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr src = *viewSet.begin();
+
+    // Each view gets its own copy of the points, since appendPoint() would
+    // share them.
+    BufferReader bufReader;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        PointViewPtr v = src->makeNew();
+        for (PointId idx = 0; idx < src->size(); ++idx)
+            for (Dimension::Id::Enum dim :
+                    { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z })
+                v->setField(dim, idx, src->getFieldAs<double>(dim, idx));
+        v->setSpatialReference(src->spatialReference());
+        bufReader.addView(v);
+    }
+
+    Options options;
+    options.add("out_srs", epsg4326_wkt);
+
+    ReprojectionFilter filter;
+    filter.setOptions(options);
+    filter.setInput(bufReader);
+    filter.setThreads(4);
+    filter.prepare(table);
+    PointViewSet s = filter.execute(table);
+    EXPECT_EQ(s.size(), 8u);
+    for (const PointViewPtr& v : s)
+    {
+        ASSERT_EQ(v->size(), src->size());
+        double x, y, z;
+        getPoint(*v, x, y, z);
+        EXPECT_FLOAT_EQ(x, -93.351563);
+        EXPECT_FLOAT_EQ(y, 41.577148);
+    }
+}
+#endif
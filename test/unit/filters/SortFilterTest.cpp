@@ -128,3 +128,57 @@ TEST(SortFilterTest, pipelineJSON)
         EXPECT_TRUE(d1 <= d2);
     }
 }
+
+// Sort on an integer and a floating-point dimension with negative values.
+// Points with equal keys keep their input order.
+TEST(SortFilterTest, multiKey)
+{
+    Options opts;
+    opts.add("dimension", "ReturnNumber,Z");
+
+    SortFilter filter;
+    filter.setOptions(opts);
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::ReturnNumber);
+    table.layout()->registerDim(Dimension::Id::Z);
+    table.layout()->registerDim(Dimension::Id::GpsTime);
+    filter.prepare(table);
+
+    PointViewPtr view(new PointView(table));
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> returns(1, 4);
+    std::uniform_int_distribution<int> z(-50, 50);
+    const point_count_t count = 200000;
+    for (PointId i = 0; i < count; ++i)
+    {
+        view->setField(Dimension::Id::ReturnNumber, i, returns(generator));
+        view->setField(Dimension::Id::Z, i, z(generator) / 4.0);
+        view->setField(Dimension::Id::GpsTime, i, i);
+    }
+
+    filter.setThreads(4);
+    FilterWrapper::ready(filter, table);
+    FilterWrapper::filter(filter, *view.get());
+    FilterWrapper::done(filter, table);
+
+    EXPECT_EQ(count, view->size());
+    for (PointId i = 1; i < count; ++i)
+    {
+        int r1 = view->getFieldAs<int>(Dimension::Id::ReturnNumber, i - 1);
+        int r2 = view->getFieldAs<int>(Dimension::Id::ReturnNumber, i);
+        double z1 = view->getFieldAs<double>(Dimension::Id::Z, i - 1);
+        double z2 = view->getFieldAs<double>(Dimension::Id::Z, i);
+        EXPECT_LE(r1, r2);
+        if (r1 == r2)
+        {
+            EXPECT_LE(z1, z2);
+            if (z1 == z2)
+            {
+                EXPECT_LT(
+                    view->getFieldAs<double>(Dimension::Id::GpsTime, i - 1),
+                    view->getFieldAs<double>(Dimension::Id::GpsTime, i));
+            }
+        }
+    }
+}
@@ -76,7 +76,7 @@ template<typename LeftIter, typename RightIter>
 
 
 
-void test_file_type_view(const std::string& filename)
+void test_file_type_view(const std::string& filename, bool mmap)
 {
     PointTable table;
 
@@ -91,6 +91,7 @@ void test_file_type_view(const std::string& filename)
 
     ops.add("filename", filename);
     ops.add("count", 506);
+    ops.add("mmap", mmap);
     std::shared_ptr<BpfReader> reader(new BpfReader);
     reader->setOptions(ops);
 
@@ -132,7 +133,7 @@ void test_file_type_view(const std::string& filename)
     }
 }
 
-void test_file_type_stream(const std::string& filename)
+void test_file_type_stream(const std::string& filename, bool mmap)
 {
     class Checker : public Filter
     {
@@ -196,6 +197,7 @@ void test_file_type_stream(const std::string& filename)
 
     ops.add("filename", filename);
     ops.add("count", 506);
+    ops.add("mmap", mmap);
     BpfReader reader;
     reader.setOptions(ops);
 
@@ -209,8 +211,10 @@ void test_file_type_stream(const std::string& filename)
 
 void test_file_type(const std::string& filename)
 {
-    test_file_type_view(filename);
-    test_file_type_stream(filename);
+    test_file_type_view(filename, false);
+    test_file_type_stream(filename, false);
+    test_file_type_view(filename, true);
+    test_file_type_stream(filename, true);
 }
 
 
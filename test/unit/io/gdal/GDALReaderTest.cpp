@@ -36,6 +36,7 @@
 #include <fstream>
 
 #include "GDALReader.hpp"
+#include <StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
 #include <iostream>
@@ -82,6 +83,79 @@ TEST(GDALReaderTest, simple)
     verify(715154, 734.5, 972.5, 0, 0, 0);
 }
 
+TEST(GDALReaderTest, bounds)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("png/autzen-height.png"));
+    ro.add("bounds", BOX2D(100, 50, 200, 60));
+
+    GDALReader gr;
+    gr.setOptions(ro);
+
+    PointTable t;
+    gr.prepare(t);
+    PointViewSet s = gr.execute(t);
+    PointViewPtr v = *s.begin();
+
+    // Pixel centers in columns 100 - 199 and rows 50 - 59.
+    EXPECT_EQ(v->size(), 1000u);
+    EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::X, 0), 100.5);
+    EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::Y, 0), 50.5);
+    EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::X, 999), 199.5);
+    EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::Y, 999), 59.5);
+}
+
+TEST(GDALReaderTest, stream)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("png/autzen-height.png"));
+
+    GDALReader gr;
+    gr.setOptions(ro);
+
+    StreamCallbackFilter f;
+    f.setInput(gr);
+
+    FixedPointTable t(1000);
+    f.prepare(t);
+
+    PointLayoutPtr l = t.layout();
+    Dimension::Id::Enum id1 = l->findDim("band-1");
+    Dimension::Id::Enum id2 = l->findDim("band-2");
+    Dimension::Id::Enum id3 = l->findDim("band-3");
+
+    point_count_t count = 0;
+    auto cb = [&count, id1, id2, id3](PointRef& point)
+    {
+        // Same points as checked in the 'simple' test.
+        if (count == 120000)
+        {
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Dimension::Id::X),
+                195.5);
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Dimension::Id::Y),
+                163.5);
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(id1), 255);
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(id2), 213);
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(id3), 0);
+        }
+        else if (count == 290000)
+        {
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Dimension::Id::X),
+                410.5);
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Dimension::Id::Y),
+                394.5);
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(id1), 0);
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(id2), 255);
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(id3), 206);
+        }
+        count++;
+        return true;
+    };
+    f.setCallback(cb);
+    f.execute(t);
+    EXPECT_EQ(count, (point_count_t)(735 * 973));
+}
+
 struct Point
 {
     double m_x;
@@ -34,9 +34,13 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <fstream>
+
 #include <pdal/Filter.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/OStream.hpp>
 #include <LasReader.hpp>
 #include "Support.hpp"
 
@@ -508,6 +512,299 @@ TEST(LasReaderTest, stream)
 }
 
 
+#if defined(PDAL_HAVE_LASZIP) || defined(PDAL_HAVE_LAZPERF)
+void threadTest(const std::string& compression)
+{
+    Options ops1;
+    ops1.add("filename", Support::datapath("laz/autzen_trim.laz"));
+    ops1.add("compression", compression);
+
+    LasReader lazReader;
+    lazReader.setOptions(ops1);
+    lazReader.setThreads(3);
+
+    PointTable t1;
+    lazReader.prepare(t1);
+    PointViewSet s = lazReader.execute(t1);
+    PointViewPtr view1 = *s.begin();
+
+    Options ops2;
+    ops2.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader lasReader;
+    lasReader.setOptions(ops2);
+
+    PointTable t2;
+    lasReader.prepare(t2);
+    s = lasReader.execute(t2);
+    PointViewPtr view2 = *s.begin();
+
+    ASSERT_EQ(view1->size(), (point_count_t)110000);
+    ASSERT_EQ(view1->size(), view2->size());
+
+    DimTypeList dims = view1->dimTypes();
+    std::vector<char> buf1(view1->pointSize());
+    std::vector<char> buf2(view2->pointSize());
+    for (PointId i = 0; i < view1->size(); ++i)
+    {
+       view1->getPackedPoint(dims, i, buf1.data());
+       view2->getPackedPoint(dims, i, buf2.data());
+       EXPECT_EQ(memcmp(buf1.data(), buf2.data(), buf1.size()), 0);
+    }
+}
+
+// Chunks are decompressed on separate threads and must land in the
+// same order as a sequential read.
+TEST(LasReaderTest, threads)
+{
+#ifdef PDAL_HAVE_LASZIP
+    threadTest("laszip");
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+    threadTest("lazperf");
+#endif
+}
+#endif
+
+namespace
+{
+
+PointViewPtr readWithOption(const std::string& filename, const Option& op,
+    PointTable& table)
+{
+    Options ops;
+    ops.add("filename", filename);
+    ops.add(op);
+
+    LasReader reader;
+    reader.setOptions(ops);
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    return *s.begin();
+}
+
+// Reading with a predicate should produce the same points as reading
+// everything and running the equivalent filter.
+void predicateTest(const std::string& filename, const Option& readOp,
+    const std::string& filterName, const Option& filterOp)
+{
+    PointTable t1;
+    PointViewPtr v1 = readWithOption(filename, readOp, t1);
+
+    Options ops;
+    ops.add("filename", filename);
+    LasReader reader;
+    reader.setOptions(ops);
+
+    StageFactory f;
+    Stage *filter(f.createStage(filterName));
+    Options filterOps;
+    filterOps.add(filterOp);
+    filter->setOptions(filterOps);
+    filter->setInput(reader);
+
+    PointTable t2;
+    filter->prepare(t2);
+    PointViewSet s = filter->execute(t2);
+    ASSERT_EQ(s.size(), 1u);
+    PointViewPtr v2 = *s.begin();
+
+    EXPECT_GT(v1->size(), 0u);
+    EXPECT_LT(v1->size(), reader.getNumPoints());
+    ASSERT_EQ(v1->size(), v2->size());
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::X, i),
+            v2->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::Y, i),
+            v2->getFieldAs<double>(Dimension::Id::Y, i));
+        EXPECT_EQ(v1->getFieldAs<int>(Dimension::Id::Intensity, i),
+            v2->getFieldAs<int>(Dimension::Id::Intensity, i));
+    }
+}
+
+void copyFile(const std::string& from, const std::string& to)
+{
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary);
+    out << in.rdbuf();
+}
+
+} // unnamed namespace
+
+TEST(LasReaderTest, predicates)
+{
+    std::vector<std::string> files;
+    files.push_back(Support::datapath("las/autzen_trim.las"));
+#ifdef PDAL_HAVE_LASZIP
+    files.push_back(Support::datapath("laz/autzen_trim.laz"));
+#endif
+
+    const std::string bounds("([636200, 636600], [849000, 849300])");
+    const std::string poly("POLYGON ((636200 849000, 636600 849000, "
+        "636600 849300, 636200 849000))");
+    const std::string limits("Classification[2:2],Intensity[50:100]");
+    for (auto& file : files)
+    {
+        predicateTest(file, Option("bounds", bounds), "filters.crop",
+            Option("bounds", bounds));
+        predicateTest(file, Option("polygon", poly), "filters.crop",
+            Option("polygon", poly));
+        predicateTest(file, Option("limits", limits), "filters.range",
+            Option("limits", limits));
+    }
+}
+
+TEST(LasReaderTest, badLimits)
+{
+    Options ops;
+    ops.add("filename", Support::datapath("las/autzen_trim.las"));
+    ops.add("limits", "Red[0:100]");
+
+    // autzen_trim.las is point format 1, which has no color.
+    LasReader reader;
+    reader.setOptions(ops);
+    PointTable table;
+    EXPECT_THROW(reader.prepare(table); reader.execute(table), pdal_error);
+}
+
+// Only the ranges of points listed for the cells of a LAX index that
+// overlap the query box should be read.
+TEST(LasReaderTest, laxIndex)
+{
+    std::vector<std::string> exts;
+    exts.push_back("las");
+#ifdef PDAL_HAVE_LASZIP
+    exts.push_back("laz");
+#endif
+
+    for (auto& ext : exts)
+    {
+        std::string filename(Support::temppath("lax_test." + ext));
+        std::string laxFilename(Support::temppath("lax_test.lax"));
+        copyFile(Support::datapath(ext + "/autzen_trim." + ext), filename);
+
+        // Two-level quadtree over the file's bounds.  The lower-left cell
+        // (1) lists two ranges of points, the upper-right cell (4) one.
+        {
+            OLeStream out(laxFilename);
+            out.put("LASX");
+            out << (uint32_t)0;
+            out.put("LASS");
+            out << (uint32_t)0;
+            out.put("LASQ");
+            out << (uint32_t)0 << (uint32_t)1 << (uint32_t)0 << (uint32_t)0;
+            out << (float)636001.76 << (float)637179.22 <<
+                (float)848935.2 << (float)849497.9;
+            out.put("LASV");
+            out << (uint32_t)0 << (int32_t)2;
+            out << (int32_t)1 << (uint32_t)2 << (uint32_t)2000;
+            out << (uint32_t)0 << (uint32_t)999;
+            out << (uint32_t)50000 << (uint32_t)50999;
+            out << (int32_t)4 << (uint32_t)1 << (uint32_t)1000;
+            out << (uint32_t)70000 << (uint32_t)70999;
+        }
+
+        BOX2D box(636100, 849000, 636500, 849200);
+        std::ostringstream bounds;
+        bounds << box;
+
+        PointTable t1;
+        PointViewPtr v1 = readWithOption(filename, Option("bounds",
+            bounds.str()), t1);
+
+        PointTable t2;
+        PointViewPtr v2 = readWithOption(filename, Option("compression",
+            "laszip"), t2);
+        std::vector<PointId> expected;
+        for (PointId i = 0; i < v2->size(); ++i)
+        {
+            if ((i < 1000 || (i >= 50000 && i < 51000)) &&
+                box.contains(v2->getFieldAs<double>(Dimension::Id::X, i),
+                    v2->getFieldAs<double>(Dimension::Id::Y, i)))
+                expected.push_back(i);
+        }
+
+        EXPECT_GT(expected.size(), 0u);
+        ASSERT_EQ(v1->size(), expected.size());
+        for (PointId i = 0; i < v1->size(); ++i)
+            EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::GpsTime, i),
+                v2->getFieldAs<double>(Dimension::Id::GpsTime,
+                    expected[i]));
+
+        // An index with too many levels to number its cells in 32 bits is
+        // ignored, so all points in the box are read.
+        {
+            OLeStream out(laxFilename);
+            out.put("LASX");
+            out << (uint32_t)0;
+            out.put("LASS");
+            out << (uint32_t)0;
+            out.put("LASQ");
+            out << (uint32_t)0 << (uint32_t)16 << (uint32_t)0 << (uint32_t)0;
+            out << (float)636001.76 << (float)637179.22 <<
+                (float)848935.2 << (float)849497.9;
+            out.put("LASV");
+            out << (uint32_t)0 << (int32_t)1;
+            out << (int32_t)1 << (uint32_t)1 << (uint32_t)1000;
+            out << (uint32_t)0 << (uint32_t)999;
+        }
+
+        PointTable t3;
+        PointViewPtr v3 = readWithOption(filename, Option("bounds",
+            bounds.str()), t3);
+        point_count_t inBox = 0;
+        for (PointId i = 0; i < v2->size(); ++i)
+            if (box.contains(v2->getFieldAs<double>(Dimension::Id::X, i),
+                    v2->getFieldAs<double>(Dimension::Id::Y, i)))
+                inBox++;
+        EXPECT_GT(inBox, expected.size());
+        EXPECT_EQ(v3->size(), inBox);
+
+        FileUtils::deleteFile(laxFilename);
+        FileUtils::deleteFile(filename);
+    }
+}
+
+TEST(LasReaderTest, mmap)
+{
+    const std::string filename(Support::datapath("las/autzen_trim.las"));
+
+    PointTable t1;
+    PointViewPtr v1 = readWithOption(filename, Option("mmap", true), t1);
+    PointTable t2;
+    PointViewPtr v2 = readWithOption(filename, Option("mmap", false), t2);
+
+    ASSERT_EQ(v1->size(), (point_count_t)110000);
+    ASSERT_EQ(v1->size(), v2->size());
+    DimTypeList dims = v1->dimTypes();
+    std::vector<char> buf1(v1->pointSize());
+    std::vector<char> buf2(v2->pointSize());
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+       v1->getPackedPoint(dims, i, buf1.data());
+       v2->getPackedPoint(dims, i, buf2.data());
+       EXPECT_EQ(memcmp(buf1.data(), buf2.data(), buf1.size()), 0);
+    }
+
+    // Predicates read single points from the mapping.
+    Options ops;
+    ops.add("filename", filename);
+    ops.add("mmap", true);
+    ops.add("limits", "Classification[2:2]");
+    LasReader reader;
+    reader.setOptions(ops);
+    PointTable t3;
+    reader.prepare(t3);
+    PointViewSet s = reader.execute(t3);
+    PointViewPtr v3 = *s.begin();
+    point_count_t ground = 0;
+    for (PointId i = 0; i < v2->size(); ++i)
+        if (v2->getFieldAs<int>(Dimension::Id::Classification, i) == 2)
+            ground++;
+    EXPECT_EQ(v3->size(), ground);
+}
+
 // The header of 1.2-with-color-clipped says that it has 1065 points,
 // but it really only has 1064.
 TEST(LasReaderTest, LasHeaderIncorrentPointcount)
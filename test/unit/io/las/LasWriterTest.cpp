@@ -584,6 +584,65 @@ TEST(LasWriterTest, lazperf)
        EXPECT_EQ(memcmp(buf1.get(), buf2.get(), pointSize), 0);
     }
 }
+
+// Chunks compressed on separate threads must make a standard chunked
+// LAZ file.
+TEST(LasWriterTest, lazperfThreads)
+{
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader lasReader;
+    lasReader.setOptions(readerOps);
+
+    std::string testfile(Support::temppath("temp.laz"));
+    FileUtils::deleteFile(testfile);
+
+    Options writerOps;
+    writerOps.add("filename", testfile);
+    writerOps.add("compression", "lazperf");
+
+    LasWriter lazWriter;
+    lazWriter.setOptions(writerOps);
+    lazWriter.setInput(lasReader);
+    lazWriter.setThreads(4);
+
+    PointTable t;
+    lazWriter.prepare(t);
+    lazWriter.execute(t);
+
+    PointTable t2;
+    lasReader.prepare(t2);
+    PointViewSet set2 = lasReader.execute(t2);
+    PointViewPtr view2 = *set2.begin();
+
+    DimTypeList dims = view2->dimTypes();
+    std::vector<char> buf1(view2->pointSize());
+    std::vector<char> buf2(view2->pointSize());
+    for (std::string compression : { "laszip", "lazperf" })
+    {
+        Options ops1;
+        ops1.add("filename", testfile);
+        ops1.add("compression", compression);
+
+        LasReader r1;
+        r1.setOptions(ops1);
+
+        PointTable t1;
+        r1.prepare(t1);
+        PointViewSet set1 = r1.execute(t1);
+        PointViewPtr view1 = *set1.begin();
+
+        ASSERT_EQ(view1->size(), (point_count_t)110000);
+        ASSERT_EQ(view1->pointSize(), view2->pointSize());
+        for (PointId i = 0; i < view1->size(); ++i)
+        {
+           view1->getPackedPoint(dims, i, buf1.data());
+           view2->getPackedPoint(dims, i, buf2.data());
+           EXPECT_EQ(memcmp(buf1.data(), buf2.data(), buf1.size()), 0);
+        }
+    }
+}
 #endif
 
 void compareFiles(const std::string& name1, const std::string& name2,